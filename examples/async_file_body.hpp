@@ -0,0 +1,211 @@
+//
+// Copyright (c) 2013-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BEAST_EXAMPLE_ASYNC_FILE_BODY_H_INCLUDED
+#define BEAST_EXAMPLE_ASYNC_FILE_BODY_H_INCLUDED
+
+#include "file_io_pool.hpp"
+
+#include <beast/http/body_type.hpp>
+#include <beast/http/resume_context.hpp>
+#include <boost/asio/buffer.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/logic/tribool.hpp>
+#include <cassert>
+#include <cerrno>
+#include <cstdio>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace beast {
+namespace http {
+
+/** A Body which reads a file on a @ref file_io_pool.
+
+    Unlike `file_body`, the writer never calls into the file system
+    from the thread sending the message. Blocks are read ahead on the
+    pool into one of two buffers while the other buffer is being sent.
+    When the next block is not ready yet, the writer suspends the
+    write operation and resumes it once the read completes.
+*/
+struct async_file_body
+{
+    struct value_type
+    {
+        /// The path of the file to send.
+        std::string path;
+
+        /// The pool on which the file is read.
+        file_io_pool* pool = nullptr;
+    };
+
+    class writer
+    {
+        static std::size_t constexpr block_size = 16384;
+
+        struct state
+        {
+            std::string path;
+            FILE* file = nullptr;
+            std::mutex m;
+            char buf[2][block_size];
+            std::size_t len[2];
+            bool ready = false;     // the pending read completed
+            error_code ec;          // result of the pending read
+            resume_context resume;  // set while suspended
+
+            explicit
+            state(std::string const& path_)
+                : path(path_)
+            {
+            }
+
+            ~state()
+            {
+                if(file)
+                    fclose(file);
+            }
+        };
+
+        value_type const& body_;
+        std::shared_ptr<state> s_;
+        error_code ec_;             // from finding the file size
+        std::uint64_t size_ = 0;
+        std::uint64_t read_ = 0;    // bytes requested from the pool
+        std::uint64_t offset_ = 0;  // bytes handed to the caller
+        int cur_ = 0;               // buffer holding the next block
+
+    public:
+        writer(writer const&) = delete;
+        writer& operator=(writer const&) = delete;
+
+        template<bool isRequest, class Headers>
+        writer(message<isRequest, async_file_body, Headers> const& m) noexcept
+            : body_(m.body)
+        {
+            // A missing file or a directory fails here,
+            // and the error is reported by init.
+            auto const size =
+                boost::filesystem::file_size(body_.path, ec_);
+            if(! ec_)
+                size_ = size;
+        }
+
+        void
+        init(error_code& ec) noexcept
+        {
+            assert(body_.pool);
+            if(ec_)
+            {
+                ec = ec_;
+                return;
+            }
+            s_ = std::make_shared<state>(body_.path);
+            if(size_ == 0)
+            {
+                s_->len[0] = 0;
+                s_->ready = true;
+                return;
+            }
+            read_next();
+        }
+
+        std::uint64_t
+        content_length() const
+        {
+            return size_;
+        }
+
+        template<class Write>
+        boost::tribool
+        operator()(resume_context&& resume,
+            error_code& ec, Write&& write)
+        {
+            {
+                std::lock_guard<std::mutex> lock(s_->m);
+                if(! s_->ready)
+                {
+                    // suspend until the block arrives
+                    s_->resume = std::move(resume);
+                    return boost::indeterminate;
+                }
+                ec = s_->ec;
+            }
+            if(ec)
+                return true;
+            auto const i = cur_;
+            auto const n = s_->len[i];
+            offset_ += n;
+            cur_ = 1 - cur_;
+            // The other buffer is free, because
+            // the previous write has completed.
+            if(read_ < size_)
+                read_next();
+            write(boost::asio::buffer(s_->buf[i], n));
+            return offset_ >= size_;
+        }
+
+    private:
+        void
+        read_next()
+        {
+            auto const remain = size_ - read_;
+            auto const n = remain < block_size ?
+                static_cast<std::size_t>(remain) : block_size;
+            read_ += n;
+            s_->ready = false;
+            auto sp = s_;
+            auto const i = cur_;
+            body_.pool->post(
+                [sp, i, n]
+                {
+                    read_block(*sp, i, n);
+                });
+        }
+
+        // Called on the pool
+        static
+        void
+        read_block(state& s, int i, std::size_t n)
+        {
+            error_code ec;
+            std::size_t nread = 0;
+            if(! s.file)
+                s.file = fopen(s.path.c_str(), "rb");
+            if(! s.file)
+            {
+                ec = boost::system::errc::make_error_code(
+                    static_cast<boost::system::errc::errc_t>(errno));
+            }
+            else
+            {
+                nread = fread(s.buf[i], 1, n, s.file);
+                if(nread != n)
+                    ec = boost::system::errc::make_error_code(
+                        boost::system::errc::io_error);
+            }
+            resume_context resume;
+            {
+                std::lock_guard<std::mutex> lock(s.m);
+                s.len[i] = nread;
+                s.ec = ec;
+                s.ready = true;
+                resume = std::move(s.resume);
+                s.resume = {};
+            }
+            if(resume)
+                resume();
+        }
+    };
+};
+
+} // http
+} // beast
+
+#endif
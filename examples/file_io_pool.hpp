@@ -0,0 +1,79 @@
+//
+// Copyright (c) 2013-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BEAST_EXAMPLE_FILE_IO_POOL_H_INCLUDED
+#define BEAST_EXAMPLE_FILE_IO_POOL_H_INCLUDED
+
+#include <boost/asio/io_service.hpp>
+#include <boost/optional.hpp>
+#include <cstddef>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace beast {
+namespace http {
+
+/** A pool of threads for performing blocking file I/O.
+
+    Functions posted to the pool are executed on one of its own
+    threads, never on the threads running the network io_service.
+    This keeps a slow disk from stalling every connection which
+    shares a network thread.
+
+    The pool must outlive all bodies which use it.
+*/
+class file_io_pool
+{
+    boost::asio::io_service ios_;
+    boost::optional<boost::asio::io_service::work> work_;
+    std::vector<std::thread> thread_;
+
+public:
+    file_io_pool(file_io_pool const&) = delete;
+    file_io_pool& operator=(file_io_pool const&) = delete;
+
+    /** Construct the pool.
+
+        @param threads The number of threads to launch.
+    */
+    explicit
+    file_io_pool(std::size_t threads = 1)
+        : work_(ios_)
+    {
+        if(threads < 1)
+            threads = 1;
+        thread_.reserve(threads);
+        for(std::size_t i = 0; i < threads; ++i)
+            thread_.emplace_back(
+                [&] { ios_.run(); });
+    }
+
+    /** Destroy the pool.
+
+        Outstanding work is completed before the threads are joined.
+    */
+    ~file_io_pool()
+    {
+        work_ = boost::none;
+        for(auto& t : thread_)
+            t.join();
+    }
+
+    /// Run a function on one of the pool's threads.
+    template<class Function>
+    void
+    post(Function&& f)
+    {
+        ios_.post(std::forward<Function>(f));
+    }
+};
+
+} // http
+} // beast
+
+#endif
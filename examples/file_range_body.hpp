@@ -0,0 +1,343 @@
+//
+// Copyright (c) 2013-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BEAST_EXAMPLE_FILE_RANGE_BODY_H_INCLUDED
+#define BEAST_EXAMPLE_FILE_RANGE_BODY_H_INCLUDED
+
+#include <beast/http/body_type.hpp>
+#include <beast/http/message_v1.hpp>
+#include <beast/http/resume_context.hpp>
+#include <beast/http/rfc7233.hpp>
+#include <boost/asio/buffer.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/logic/tribool.hpp>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+#ifndef _MSC_VER
+#include <sys/types.h>
+#endif
+
+namespace beast {
+namespace http {
+
+namespace detail {
+
+// Position a file at an absolute offset. The offset may be larger
+// than a long, which is only 32 bits on some platforms. Offsets which
+// do not fit the platform's file offset type fail with EOVERFLOW.
+inline
+int
+file_seek(FILE* f, std::uint64_t offset)
+{
+#ifdef _MSC_VER
+    using offset_type = __int64;
+#else
+    using offset_type = off_t;
+#endif
+    if(offset > static_cast<std::uint64_t>(
+        (std::numeric_limits<offset_type>::max)()))
+    {
+        errno = EOVERFLOW;
+        return -1;
+    }
+#ifdef _MSC_VER
+    return _fseeki64(f, static_cast<offset_type>(offset), SEEK_SET);
+#else
+    return fseeko(f, static_cast<offset_type>(offset), SEEK_SET);
+#endif
+}
+
+} // detail
+
+/** A Body which sends a file, or the requested ranges of a file.
+
+    When no ranges are set the whole file is sent. One range is sent
+    as the bare span of the file, and several ranges are sent as a
+    multipart/byteranges payload, where each part carries its own
+    Content-Type and Content-Range. The writer seeks to each span and
+    reads only the octets which are sent.
+
+    The ranges are normally set by calling @ref prepare_ranges with
+    the request before calling `prepare` on the response.
+*/
+struct file_range_body
+{
+    struct value_type
+    {
+        /// The path of the file to send.
+        std::string path;
+
+        /// The size of the file, set by @ref prepare_ranges.
+        std::uint64_t size = 0;
+
+        /// The ranges to send. When empty, the whole file is sent.
+        std::vector<byte_range> ranges;
+
+        /// The multipart boundary, used when there are several ranges.
+        std::string boundary;
+
+        /// The Content-Type of each part, used when there are several ranges.
+        std::string content_type;
+    };
+
+    class writer
+    {
+        value_type const& body_;
+        FILE* file_ = nullptr;
+        std::size_t part_ = 0;      // the range being sent
+        std::uint64_t remain_ = 0;  // octets left in the range
+        std::string text_;          // framing not sent yet
+        bool closed_ = false;       // the close delimiter was queued
+        bool done_ = false;
+        char buf_[4096];
+
+    public:
+        writer(writer const&) = delete;
+        writer& operator=(writer const&) = delete;
+
+        template<bool isRequest, class Headers>
+        writer(message<isRequest, file_range_body, Headers> const& m) noexcept
+            : body_(m.body)
+        {
+        }
+
+        ~writer()
+        {
+            if(file_)
+                fclose(file_);
+        }
+
+        void
+        init(error_code& ec) noexcept
+        {
+            file_ = fopen(body_.path.c_str(), "rb");
+            if(! file_)
+            {
+                ec = boost::system::errc::make_error_code(
+                    static_cast<boost::system::errc::errc_t>(errno));
+                return;
+            }
+            if(body_.ranges.empty())
+            {
+                remain_ = body_.size;
+                done_ = remain_ == 0;
+                return;
+            }
+            start(ec);
+        }
+
+        std::uint64_t
+        content_length() const
+        {
+            if(body_.ranges.empty())
+                return body_.size;
+            if(body_.ranges.size() == 1)
+                return body_.ranges.front().size();
+            std::uint64_t n = 0;
+            for(std::size_t i = 0; i < body_.ranges.size(); ++i)
+                n += delimiter(i).size() + body_.ranges[i].size();
+            return n + close_delimiter().size();
+        }
+
+        template<class Write>
+        boost::tribool
+        operator()(resume_context&&, error_code& ec, Write&& write)
+        {
+            std::size_t n = 0;
+            for(;;)
+            {
+                if(! text_.empty())
+                {
+                    auto const len = std::min(
+                        text_.size(), sizeof(buf_) - n);
+                    std::memcpy(buf_ + n, text_.data(), len);
+                    text_.erase(0, len);
+                    n += len;
+                    if(! text_.empty())
+                        break;
+                }
+                if(remain_ > 0)
+                {
+                    auto const avail = sizeof(buf_) - n;
+                    if(avail == 0)
+                        break;
+                    auto const len = remain_ < avail ?
+                        static_cast<std::size_t>(remain_) : avail;
+                    if(fread(buf_ + n, 1, len, file_) != len)
+                    {
+                        ec = boost::system::errc::make_error_code(
+                            boost::system::errc::io_error);
+                        return true;
+                    }
+                    n += len;
+                    remain_ -= len;
+                    if(remain_ > 0)
+                        break;
+                }
+                if(done_ || ! next(ec))
+                    break;
+                if(ec)
+                    return true;
+            }
+            write(boost::asio::buffer(buf_, n));
+            return done_ && text_.empty() && remain_ == 0;
+        }
+
+    private:
+        bool
+        multipart() const
+        {
+            return body_.ranges.size() > 1;
+        }
+
+        std::string
+        delimiter(std::size_t i) const
+        {
+            auto const& r = body_.ranges[i];
+            std::string s;
+            if(i > 0)
+                s = "\r\n";
+            s += "--" + body_.boundary + "\r\n";
+            if(! body_.content_type.empty())
+                s += "Content-Type: " + body_.content_type + "\r\n";
+            s += "Content-Range: bytes " +
+                std::to_string(r.first) + "-" +
+                std::to_string(r.last) + "/" +
+                std::to_string(body_.size) + "\r\n\r\n";
+            return s;
+        }
+
+        std::string
+        close_delimiter() const
+        {
+            return "\r\n--" + body_.boundary + "--\r\n";
+        }
+
+        // Position the file at the current range
+        void
+        start(error_code& ec)
+        {
+            auto const& r = body_.ranges[part_];
+            if(multipart())
+                text_ = delimiter(part_);
+            if(detail::file_seek(file_, r.first) != 0)
+            {
+                ec = boost::system::errc::make_error_code(
+                    static_cast<boost::system::errc::errc_t>(errno));
+                return;
+            }
+            remain_ = r.size();
+        }
+
+        // Advance past the finished range,
+        // returns false when nothing is left.
+        bool
+        next(error_code& ec)
+        {
+            if(part_ + 1 < body_.ranges.size())
+            {
+                ++part_;
+                start(ec);
+                return true;
+            }
+            if(multipart() && ! closed_)
+            {
+                closed_ = true;
+                text_ = close_delimiter();
+                return true;
+            }
+            done_ = true;
+            return false;
+        }
+    };
+};
+
+/** Select the ranges of a file response from its request.
+
+    The size of the file named in the response body is determined,
+    and the Range field of the request, if any, is applied to it.
+    A satisfiable Range turns the response into 206 (Partial Content)
+    with the Content-Range or multipart/byteranges Content-Type set
+    as appropriate, otherwise the whole file is sent. The Content-Type
+    of the response should be set before calling this function.
+
+    If-Range is not supported, so requests carrying it are always
+    sent the whole file.
+
+    @param req The request to which the response is sent.
+
+    @param resp The response whose ranges are selected.
+
+    @param ec Set to the error, if any occurred.
+
+    @return `false` if none of the requested ranges is satisfiable,
+    in which case the caller should send a 416 (Range Not Satisfiable)
+    response instead, whose Content-Range holds the size of the file.
+*/
+template<class ReqBody, class ReqHeaders, class Headers>
+bool
+prepare_ranges(message_v1<true, ReqBody, ReqHeaders> const& req,
+    message_v1<false, file_range_body, Headers>& resp,
+        error_code& ec)
+{
+    // Upper limit on the number of parts, to avoid
+    // spending the connection on many tiny ranges.
+    std::size_t constexpr max_ranges = 16;
+
+    auto& body = resp.body;
+    body.ranges.clear();
+    body.size = boost::filesystem::file_size(body.path, ec);
+    if(ec)
+        return true;
+    resp.headers.replace("Accept-Ranges", "bytes");
+    if(req.method != "GET" || ! req.headers.exists("Range") ||
+            req.headers.exists("If-Range"))
+        return true;
+    if(! parse_ranges(req.headers["Range"], body.size, body.ranges))
+        return true;
+    if(body.ranges.empty())
+        return false;
+    if(body.ranges.size() > max_ranges)
+    {
+        body.ranges.clear();
+        return true;
+    }
+    resp.status = 206;
+    resp.reason = "Partial Content";
+    if(body.ranges.size() == 1)
+    {
+        auto const& r = body.ranges.front();
+        resp.headers.replace("Content-Range", "bytes " +
+            std::to_string(r.first) + "-" +
+            std::to_string(r.last) + "/" +
+            std::to_string(body.size));
+        return true;
+    }
+    static char constexpr alphabet[] =
+        "0123456789abcdefghijklmnopqrstuvwxyz";
+    std::random_device rd;
+    std::uniform_int_distribution<int> dist(0, sizeof(alphabet) - 2);
+    body.boundary.clear();
+    for(int i = 0; i < 32; ++i)
+        body.boundary.push_back(alphabet[dist(rd)]);
+    body.content_type = resp.headers["Content-Type"].to_string();
+    resp.headers.replace("Content-Type",
+        "multipart/byteranges; boundary=" + body.boundary);
+    return true;
+}
+
+} // http
+} // beast
+
+#endif
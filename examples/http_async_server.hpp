@@ -8,21 +8,42 @@
 #ifndef BEAST_EXAMPLE_HTTP_ASYNC_SERVER_H_INCLUDED
 #define BEAST_EXAMPLE_HTTP_ASYNC_SERVER_H_INCLUDED
 
-#include "file_body.hpp"
+#include "async_file_body.hpp"
+#include "file_io_pool.hpp"
 #include "http_stream.hpp"
 
 #include <beast/core/placeholders.hpp>
 #include <boost/asio.hpp>
+#include <boost/core/ignore_unused.hpp>
+#include <boost/optional.hpp>
+#include <atomic>
 #include <cstdio>
 #include <iostream>
 #include <memory>
 #include <mutex>
 #include <thread>
 #include <utility>
+#include <vector>
+#ifdef __linux__
+#include <pthread.h>
+#endif
 
 namespace beast {
 namespace http {
 
+/** An asynchronous HTTP server.
+
+    In the default shared mode, one io_service runs on all the threads
+    and a single acceptor hands out connections, so every completion
+    contends on the same reactor and each connection needs a strand.
+
+    In per-core mode, each thread gets its own io_service and its own
+    acceptor, all bound to the same endpoint with `SO_REUSEPORT`. The
+    kernel spreads incoming connections over the listeners, and each
+    connection stays on the thread which accepted it, so no strand is
+    needed. The threads may optionally be pinned to CPUs. Per-core mode
+    falls back to shared mode where `SO_REUSEPORT` is unavailable.
+*/
 class http_async_server
 {
     using endpoint_type = boost::asio::ip::tcp::endpoint;
@@ -30,41 +51,127 @@ class http_async_server
     using socket_type = boost::asio::ip::tcp::socket;
 
     using req_type = request_v1<string_body>;
-    using resp_type = response_v1<file_body>;
+    using resp_type = response_v1<async_file_body>;
 
-    boost::asio::io_service ios_;
-    socket_type sock_;
-    boost::asio::ip::tcp::acceptor acceptor_;
+public:
+    /// The way connections are assigned to threads.
+    enum class mode
+    {
+        /// One io_service and acceptor shared by all threads.
+        shared,
+
+        /// One io_service, acceptor, and thread per core.
+        per_core
+    };
+
+private:
+    // An io_service with its own acceptor
+    struct worker
+    {
+        boost::asio::io_service ios;
+        socket_type sock;
+        boost::asio::ip::tcp::acceptor acceptor;
+        std::vector<std::thread> thread;
+
+        worker()
+            : sock(ios)
+            , acceptor(ios)
+        {
+        }
+    };
+
+    file_io_pool pool_;
     std::string root_;
-    std::vector<std::thread> thread_;
+    bool strand_;
+    endpoint_type ep_;
+    std::vector<std::unique_ptr<worker>> workers_;
 
 public:
     http_async_server(endpoint_type const& ep,
             int threads, std::string const& root)
-        : sock_(ios_)
-        , acceptor_(ios_)
+        : http_async_server(ep, threads, root, mode::shared)
+    {
+    }
+
+    /** Construct the server.
+
+        @param ep The endpoint to listen on. If the port is zero,
+        an unused port is chosen.
+
+        @param threads The number of threads, and in per-core
+        mode the number of io_service and acceptor pairs.
+
+        @param root The directory to serve files from.
+
+        @param m The way connections are assigned to threads.
+
+        @param pin `true` to pin each thread to one CPU, in per-core
+        mode on Linux. Threads are assigned CPUs in order, wrapping
+        around when there are more threads than CPUs.
+    */
+    http_async_server(endpoint_type const& ep, int threads,
+            std::string const& root, mode m, bool pin = false)
+        : pool_(threads)
         , root_(root)
+        , ep_(ep)
     {
-        acceptor_.open(ep.protocol());
-        acceptor_.bind(ep);
-        acceptor_.listen(
-            boost::asio::socket_base::max_connections);
-        acceptor_.async_accept(sock_,
-            std::bind(&http_async_server::on_accept, this,
-                beast::asio::placeholders::error));
-        thread_.reserve(threads);
-        for(int i = 0; i < threads; ++i)
-            thread_.emplace_back(
-                [&] { ios_.run(); });
+        if(threads < 1)
+            threads = 1;
+#ifndef SO_REUSEPORT
+        m = mode::shared;
+#endif
+        auto const n = m == mode::per_core ? threads : 1;
+        strand_ = m == mode::shared && threads > 1;
+        workers_.reserve(n);
+        for(int i = 0; i < n; ++i)
+        {
+            workers_.emplace_back(new worker);
+            auto& w = *workers_.back();
+            listen(w, n > 1);
+            // Later listeners must use the
+            // port picked for the first one.
+            ep_ = w.acceptor.local_endpoint();
+            w.acceptor.async_accept(w.sock,
+                std::bind(&http_async_server::on_accept, this,
+                    std::ref(w), beast::asio::placeholders::error));
+        }
+        auto const per_worker = m == mode::per_core ? 1 : threads;
+        for(int i = 0; i < n; ++i)
+        {
+            auto& w = *workers_[i];
+            w.thread.reserve(per_worker);
+            for(int j = 0; j < per_worker; ++j)
+            {
+                w.thread.emplace_back(
+                    [&w] { w.ios.run(); });
+                if(pin && m == mode::per_core)
+                    pin_thread(w.thread.back(), i);
+            }
+        }
     }
 
     ~http_async_server()
     {
-        error_code ec;
-        ios_.dispatch(
-            [&]{ acceptor_.close(ec); });
-        for(auto& t : thread_)
-            t.join();
+        for(auto& w : workers_)
+        {
+            auto& a = w->acceptor;
+            w->ios.dispatch(
+                [&a]
+                {
+                    error_code ec;
+                    a.close(ec);
+                });
+        }
+        for(auto& w : workers_)
+            for(auto& t : w->thread)
+                t.join();
+    }
+
+    /// Return the endpoint the server is listening on.
+    endpoint_type
+    local_endpoint() const
+    {
+        return ep_;
     }
 
 private:
@@ -72,8 +179,9 @@ private:
     {
         int id_;
         stream<socket_type> stream_;
-        boost::asio::io_service::strand strand_;
+        boost::optional<boost::asio::io_service::strand> strand_;
         std::string root_;
+        file_io_pool& pool_;
         req_type req_;
 
     public:
@@ -83,13 +191,17 @@ private:
         peer& operator=(peer const&) = delete;
 
         explicit
-        peer(socket_type&& sock, std::string const& root)
+        peer(socket_type&& sock, std::string const& root,
+                file_io_pool& pool, bool strand)
             : stream_(std::move(sock))
-            , strand_(stream_.get_io_service())
             , root_(root)
+            , pool_(pool)
         {
-            static int n = 0;
+            // Connections are accepted on several threads in per-core mode
+            static std::atomic<int> n{0};
             id_ = ++n;
+            if(strand)
+                strand_.emplace(stream_.get_io_service());
         }
 
         void run()
@@ -99,9 +211,14 @@ private:
 
         void do_read()
         {
-            stream_.async_read(req_, strand_.wrap(
-                std::bind(&peer::on_read, shared_from_this(),
-                    asio::placeholders::error)));
+            if(strand_)
+                stream_.async_read(req_, strand_->wrap(
+                    std::bind(&peer::on_read, shared_from_this(),
+                        asio::placeholders::error)));
+            else
+                stream_.async_read(req_,
+                    std::bind(&peer::on_read, shared_from_this(),
+                        asio::placeholders::error));
         }
 
         void on_read(error_code ec)
@@ -121,7 +238,7 @@ private:
                 resp.version = req_.version;
                 resp.headers.replace("Server", "http_async_server");
                 resp.body = "The file '" + path + "' was not found";
-                prepare(resp);
+                prepare(resp, date::now);
                 stream_.async_write(std::move(resp),
                     std::bind(&peer::on_write, shared_from_this(),
                         asio::placeholders::error));
@@ -133,8 +250,9 @@ private:
             resp.version = req_.version;
             resp.headers.replace("Server", "http_async_server");
             resp.headers.replace("Content-Type", "text/html");
-            resp.body = path;
-            prepare(resp);
+            resp.body.path = path;
+            resp.body.pool = &pool_;
+            prepare(resp, date::now);
             stream_.async_write(std::move(resp),
                 std::bind(&peer::on_write, shared_from_this(),
                     asio::placeholders::error));
@@ -150,7 +268,9 @@ private:
         void
         fail(error_code ec, std::string what)
         {
-            if(ec != boost::asio::error::operation_aborted)
+            // End of file is a client closing a keep-alive connection
+            if(ec != boost::asio::error::operation_aborted &&
+                ec != boost::asio::error::eof)
             {
                 std::cerr <<
                     "#" << std::to_string(id_) << " " <<
@@ -177,16 +297,50 @@ private:
     }
 
     void
-    on_accept(error_code ec)
+    listen(worker& w, bool reuse_port)
+    {
+        w.acceptor.open(ep_.protocol());
+#ifdef SO_REUSEPORT
+        if(reuse_port)
+            w.acceptor.set_option(boost::asio::detail::socket_option::
+                boolean<SOL_SOCKET, SO_REUSEPORT>{true});
+#else
+        boost::ignore_unused(reuse_port);
+#endif
+        w.acceptor.bind(ep_);
+        w.acceptor.listen(
+            boost::asio::socket_base::max_connections);
+    }
+
+    static
+    void
+    pin_thread(std::thread& t, int i)
+    {
+#ifdef __linux__
+        auto const cpus = std::thread::hardware_concurrency();
+        if(cpus == 0)
+            return;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(static_cast<unsigned>(i) % cpus, &set);
+        pthread_setaffinity_np(t.native_handle(), sizeof(set), &set);
+#else
+        boost::ignore_unused(t, i);
+#endif
+    }
+
+    void
+    on_accept(worker& w, error_code ec)
     {
-        if(! acceptor_.is_open())
+        if(! w.acceptor.is_open())
             return;
         maybe_throw(ec, "accept");
-        socket_type sock(std::move(sock_));
-        acceptor_.async_accept(sock_,
+        socket_type sock(std::move(w.sock));
+        w.acceptor.async_accept(w.sock,
             std::bind(&http_async_server::on_accept, this,
-                asio::placeholders::error));
-        std::make_shared<peer>(std::move(sock), root_)->run();
+                std::ref(w), asio::placeholders::error));
+        std::make_shared<peer>(
+            std::move(sock), root_, pool_, strand_)->run();
     }
 };
 
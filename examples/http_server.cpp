@@ -29,6 +29,8 @@ int main(int ac, char const* av[])
         ("threads,n",   po::value<std::size_t>()->implicit_value(4),
                         "Set the number of threads to use")
         ("sync,s",      "Launch a synchronous server")
+        ("per-core",    "Use an io_service and SO_REUSEPORT listener per thread")
+        ("pin",         "Pin each per-core thread to a CPU")
         ;
     po::variables_map vm;
     po::store(po::parse_command_line(ac, av, desc), vm);
@@ -51,6 +53,12 @@ int main(int ac, char const* av[])
 
     bool sync = vm.count("sync") > 0;
 
+    auto const mode = vm.count("per-core") > 0 ?
+        http_async_server::mode::per_core :
+            http_async_server::mode::shared;
+
+    bool pin = vm.count("pin") > 0;
+
     using endpoint_type = boost::asio::ip::tcp::endpoint;
     using address_type = boost::asio::ip::address;
 
@@ -59,6 +67,7 @@ int main(int ac, char const* av[])
     if(sync)
         http_sync_server server(ep, root);
     else
-        http_async_server server(ep, threads, root);
+        http_async_server server(ep,
+            static_cast<int>(threads), root, mode, pin);
     beast::test::sig_wait();
 }
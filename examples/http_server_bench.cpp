@@ -0,0 +1,188 @@
+//
+// Copyright (c) 2013-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Measures how http_async_server scales from one core to many, in
+// shared mode and in per-core mode. Keep-alive clients on loopback
+// request a missing file, so the numbers reflect connection handling
+// rather than disk reads. The clients run on the same machine, so
+// they take some of the cores.
+//
+// usage: http-server-bench [max cores] [connections] [seconds]
+
+#include "http_async_server.hpp"
+
+#include <beast/http.hpp>
+#include <beast/core/streambuf.hpp>
+#include <boost/asio.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace beast {
+namespace http {
+
+// A keep-alive connection which sends the next
+// request when the previous response arrives.
+class bench_client
+    : public std::enable_shared_from_this<bench_client>
+{
+    using socket_type = boost::asio::ip::tcp::socket;
+    using response_type = response_v1<string_body>;
+
+    socket_type sock_;
+    streambuf sb_;
+    response_type res_;
+    std::string const& req_;
+    std::atomic<std::size_t>& count_;
+    std::atomic<bool>& stop_;
+
+public:
+    bench_client(socket_type&& sock, std::string const& req,
+            std::atomic<std::size_t>& count, std::atomic<bool>& stop)
+        : sock_(std::move(sock))
+        , req_(req)
+        , count_(count)
+        , stop_(stop)
+    {
+    }
+
+    void
+    run()
+    {
+        do_write();
+    }
+
+private:
+    void
+    do_write()
+    {
+        auto self = shared_from_this();
+        boost::asio::async_write(sock_, boost::asio::buffer(req_),
+            [self](error_code ec, std::size_t)
+            {
+                self->on_write(ec);
+            });
+    }
+
+    void
+    on_write(error_code ec)
+    {
+        if(ec || stop_)
+            return close();
+        res_ = response_type{};
+        auto self = shared_from_this();
+        async_read(sock_, sb_, res_,
+            [self](error_code ec)
+            {
+                self->on_read(ec);
+            });
+    }
+
+    void
+    on_read(error_code ec)
+    {
+        if(ec || stop_)
+            return close();
+        ++count_;
+        do_write();
+    }
+
+    void
+    close()
+    {
+        error_code ec;
+        sock_.shutdown(socket_type::shutdown_both, ec);
+        sock_.close(ec);
+    }
+};
+
+struct options
+{
+    int cores = static_cast<int>(
+        std::thread::hardware_concurrency());
+    std::size_t connections = 256;
+    std::size_t seconds = 5;
+};
+
+// Returns the number of requests per second
+double
+bench(http_async_server::mode m, int cores, options const& opt)
+{
+    using namespace boost::asio;
+    std::string const req =
+        "GET /http-server-bench-missing HTTP/1.1\r\n"
+        "Host: localhost\r\n"
+        "\r\n";
+    http_async_server server(ip::tcp::endpoint{
+        ip::address_v4::loopback(), 0}, cores, ".", m, true);
+    io_service ios;
+    std::atomic<std::size_t> count{0};
+    std::atomic<bool> stop{false};
+    for(std::size_t i = 0; i < opt.connections; ++i)
+    {
+        ip::tcp::socket sock(ios);
+        sock.connect(server.local_endpoint());
+        sock.set_option(ip::tcp::no_delay{true});
+        std::make_shared<bench_client>(
+            std::move(sock), req, count, stop)->run();
+    }
+    std::vector<std::thread> v;
+    v.reserve(opt.cores);
+    for(int i = 0; i < opt.cores; ++i)
+        v.emplace_back([&]{ ios.run(); });
+    // Let the connections reach a steady state
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+    auto const n0 = count.load();
+    auto const t0 = std::chrono::steady_clock::now();
+    std::this_thread::sleep_for(std::chrono::seconds(opt.seconds));
+    auto const n1 = count.load();
+    auto const t1 = std::chrono::steady_clock::now();
+    stop = true;
+    for(auto& t : v)
+        t.join();
+    return (n1 - n0) / std::chrono::duration<
+        double>(t1 - t0).count();
+}
+
+} // http
+} // beast
+
+int
+main(int argc, char** argv)
+{
+    using beast::http::http_async_server;
+    beast::http::options opt;
+    if(argc > 1)
+        opt.cores = std::atoi(argv[1]);
+    if(argc > 2)
+        opt.connections = std::strtoul(argv[2], nullptr, 10);
+    if(argc > 3)
+        opt.seconds = std::strtoul(argv[3], nullptr, 10);
+    if(opt.cores < 1)
+        opt.cores = 1;
+    std::cout <<
+        "cores=" << opt.cores <<
+        " connections=" << opt.connections <<
+        " seconds=" << opt.seconds << std::endl;
+    for(int i = 1; i <= opt.cores; ++i)
+    {
+        auto const shared = beast::http::bench(
+            http_async_server::mode::shared, i, opt);
+        auto const per_core = beast::http::bench(
+            http_async_server::mode::per_core, i, opt);
+        std::cout <<
+            "cores=" << i <<
+            " shared=" << static_cast<std::size_t>(shared) <<
+            " per_core=" << static_cast<std::size_t>(per_core) <<
+            " requests/s, ratio: " << per_core / shared << std::endl;
+    }
+}
@@ -9,7 +9,7 @@
 #define BEAST_HTTP_STREAM_IPP_INCLUDED
 
 #include <beast/core/bind_handler.hpp>
-#include <beast/core/handler_alloc.hpp>
+#include <beast/core/handler_ptr.hpp>
 #include <beast/http/message_v1.hpp>
 #include <beast/http/read.hpp>
 #include <beast/http/write.hpp>
@@ -23,30 +23,24 @@ template<bool isRequest, class Body, class Headers,
     class Handler>
 class stream<NextLayer, Allocator>::read_op
 {
-    using alloc_type =
-        handler_alloc<char, Handler>;
-
     struct data
     {
         stream<NextLayer>& s;
         message_v1<isRequest, Body, Headers>& m;
-        Handler h;
         bool cont;
         int state = 0;
 
-        template<class DeducedHandler>
-        data(DeducedHandler&& h_, stream<NextLayer>& s_,
+        data(Handler& handler, stream<NextLayer>& s_,
                 message_v1<isRequest, Body, Headers>& m_)
             : s(s_)
             , m(m_)
-            , h(std::forward<DeducedHandler>(h_))
             , cont(boost_asio_handler_cont_helpers::
-                is_continuation(h))
+                is_continuation(handler))
         {
         }
     };
 
-    std::shared_ptr<data> d_;
+    handler_ptr<data, Handler> d_;
 
 public:
     read_op(read_op&&) = default;
@@ -55,9 +49,8 @@ public:
     template<class DeducedHandler, class... Args>
     read_op(DeducedHandler&& h,
             stream<NextLayer>& s, Args&&... args)
-        : d_(std::allocate_shared<data>(alloc_type{h},
-            std::forward<DeducedHandler>(h), s,
-                std::forward<Args>(args)...))
+        : d_(std::forward<DeducedHandler>(h), s,
+                std::forward<Args>(args)...)
     {
         (*this)(error_code{}, false);
     }
@@ -69,7 +62,7 @@ public:
         std::size_t size, read_op* op)
     {
         return boost_asio_handler_alloc_helpers::
-            allocate(size, op->d_->h);
+            allocate(size, op->d_.handler());
     }
 
     friend
@@ -77,7 +70,7 @@ public:
         void* p, std::size_t size, read_op* op)
     {
         return boost_asio_handler_alloc_helpers::
-            deallocate(p, size, op->d_->h);
+            deallocate(p, size, op->d_.handler());
     }
 
     friend
@@ -91,7 +84,7 @@ public:
     void asio_handler_invoke(Function&& f, read_op* op)
     {
         return boost_asio_handler_invoke_helpers::
-            invoke(f, op->d_->h);
+            invoke(f, op->d_.handler());
     }
 };
 
@@ -115,7 +108,7 @@ operator()(error_code const& ec, bool again)
             return;
         }
     }
-    d.h(ec);
+    d_.invoke(ec);
 }
 
 //------------------------------------------------------------------------------
@@ -125,41 +118,33 @@ template<bool isRequest, class Body, class Headers,
     class Handler>
 class stream<NextLayer, Allocator>::write_op : public op
 {
-    using alloc_type =
-        handler_alloc<char, Handler>;
-
     struct data
     {
         stream<NextLayer>& s;
         message_v1<isRequest, Body, Headers> m;
-        Handler h;
         bool cont;
         int state = 0;
 
-        template<class DeducedHandler>
-        data(DeducedHandler&& h_, stream<NextLayer>& s_,
+        data(Handler&, stream<NextLayer>& s_,
             message_v1<isRequest, Body, Headers> const& m_,
                 bool cont_)
             : s(s_)
             , m(m_)
-            , h(std::forward<DeducedHandler>(h_))
             , cont(cont_)
         {
         }
 
-        template<class DeducedHandler>
-        data(DeducedHandler&& h_, stream<NextLayer>& s_,
+        data(Handler&, stream<NextLayer>& s_,
             message_v1<isRequest, Body, Headers>&& m_,
                 bool cont_)
             : s(s_)
             , m(std::move(m_))
-            , h(std::forward<DeducedHandler>(h_))
             , cont(cont_)
         {
         }
     };
 
-    std::shared_ptr<data> d_;
+    handler_ptr<data, Handler> d_;
 
 public:
     write_op(write_op&&) = default;
@@ -168,9 +153,8 @@ public:
     template<class DeducedHandler, class... Args>
     write_op(DeducedHandler&& h,
         stream<NextLayer>& s, Args&&... args)
-        : d_(std::allocate_shared<data>(alloc_type{h},
-            std::forward<DeducedHandler>(h), s,
-                std::forward<Args>(args)...))
+        : d_(std::forward<DeducedHandler>(h), s,
+                std::forward<Args>(args)...)
     {
     }
 
@@ -189,7 +173,7 @@ public:
         std::size_t size, write_op* op)
     {
         return boost_asio_handler_alloc_helpers::
-            allocate(size, op->d_->h);
+            allocate(size, op->d_.handler());
     }
 
     friend
@@ -197,7 +181,7 @@ public:
         void* p, std::size_t size, write_op* op)
     {
         return boost_asio_handler_alloc_helpers::
-            deallocate(p, size, op->d_->h);
+            deallocate(p, size, op->d_.handler());
     }
 
     friend
@@ -211,7 +195,7 @@ public:
     void asio_handler_invoke(Function&& f, write_op* op)
     {
         return boost_asio_handler_invoke_helpers::
-            invoke(f, op->d_->h);
+            invoke(f, op->d_.handler());
     }
 };
 
@@ -248,18 +232,19 @@ operator()(error_code const& ec, bool again)
             return;
         }
     }
-    d.h(ec);
-    if(! d.s.wr_q_.empty())
+    auto& s = d.s;
+    d_.invoke(ec);
+    if(! s.wr_q_.empty())
     {
-        auto& op = d.s.wr_q_.front();
+        auto& op = s.wr_q_.front();
         op();
         // VFALCO Use allocator
         delete &op;
-        d.s.wr_q_.pop_front();
+        s.wr_q_.pop_front();
     }
     else
     {
-        d.s.wr_active_ = false;
+        s.wr_active_ = false;
     }
 }
 
@@ -8,7 +8,7 @@
 #ifndef BEAST_EXAMPLE_HTTP_SYNC_SERVER_H_INCLUDED
 #define BEAST_EXAMPLE_HTTP_SYNC_SERVER_H_INCLUDED
 
-#include "file_body.hpp"
+#include "file_range_body.hpp"
 #include "http_stream.hpp"
 
 #include <boost/asio.hpp>
@@ -32,7 +32,7 @@ class http_sync_server
     using socket_type = boost::asio::ip::tcp::socket;
 
     using req_type = request_v1<string_body>;
-    using resp_type = response_v1<file_body>;
+    using resp_type = response_v1<file_range_body>;
 
     boost::asio::io_service ios_;
     socket_type sock_;
@@ -149,7 +149,7 @@ public:
                 resp.version = req.version;
                 resp.headers.replace("Server", "http_sync_server");
                 resp.body = "The file '" + path + "' was not found";
-                prepare(resp);
+                prepare(resp, date::now);
                 hs.write(resp, ec);
                 if(ec)
                     break;
@@ -160,8 +160,25 @@ public:
             resp.version = req.version;
             resp.headers.replace("Server", "http_sync_server");
             resp.headers.replace("Content-Type", "text/html");
-            resp.body = path;
-            prepare(resp);
+            resp.body.path = path;
+            if(! prepare_ranges(req, resp, ec))
+            {
+                response_v1<empty_body> res;
+                res.status = 416;
+                res.reason = "Range Not Satisfiable";
+                res.version = req.version;
+                res.headers.replace("Server", "http_sync_server");
+                res.headers.replace("Content-Range",
+                    "bytes */" + std::to_string(resp.body.size));
+                prepare(res, date::now);
+                hs.write(res, ec);
+                if(ec)
+                    break;
+                continue;
+            }
+            if(ec)
+                break;
+            prepare(resp, date::now);
             hs.write(resp, ec);
             if(ec)
                 break;
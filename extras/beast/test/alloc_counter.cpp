@@ -0,0 +1,48 @@
+//
+// Copyright (c) 2013-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Replacement global allocation functions which report to
+// beast::test::alloc_counter. Link this file into an executable
+// exactly once.
+
+#include <beast/test/alloc_counter.hpp>
+#include <cstdlib>
+#include <new>
+
+void*
+operator new(std::size_t n)
+{
+    beast::test::alloc_counter::on_alloc(n);
+    if(auto const p = std::malloc(n ? n : 1))
+        return p;
+    throw std::bad_alloc{};
+}
+
+void*
+operator new(std::size_t n, std::nothrow_t const&) noexcept
+{
+    beast::test::alloc_counter::on_alloc(n);
+    return std::malloc(n ? n : 1);
+}
+
+void
+operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void
+operator delete(void* p, std::nothrow_t const&) noexcept
+{
+    std::free(p);
+}
+
+void
+operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
@@ -0,0 +1,125 @@
+//
+// Copyright (c) 2013-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BEAST_TEST_ALLOC_COUNTER_HPP
+#define BEAST_TEST_ALLOC_COUNTER_HPP
+
+#include <cstddef>
+#include <new>
+
+namespace beast {
+namespace test {
+
+/** Counts heap allocations made on the current thread.
+
+    While an object of this type exists, every call to the global
+    `operator new` on the constructing thread is counted, along with
+    the bytes requested. Counters may be nested; the innermost one
+    counts, and adds its totals to the enclosing counter when it is
+    destroyed.
+
+    Counting requires the replacement allocation functions defined
+    in `beast/test/alloc_counter.cpp`, which must be linked into the
+    executable exactly once. Without them nothing is counted, and
+    @ref installed returns `false`.
+
+    Example:
+    @code
+    test::alloc_counter c;
+    parse(...);
+    expect(c.allocations() <= 2);
+    @endcode
+*/
+class alloc_counter
+{
+    alloc_counter* prev_;
+    std::size_t allocations_ = 0;
+    std::size_t bytes_ = 0;
+
+    static
+    alloc_counter*&
+    current()
+    {
+        static thread_local alloc_counter* p = nullptr;
+        return p;
+    }
+
+public:
+    alloc_counter(alloc_counter const&) = delete;
+    alloc_counter& operator=(alloc_counter const&) = delete;
+
+    /// Start counting on this thread.
+    alloc_counter()
+        : prev_(current())
+    {
+        current() = this;
+    }
+
+    /// Stop counting, adding the totals to any enclosing counter.
+    ~alloc_counter()
+    {
+        current() = prev_;
+        if(prev_)
+        {
+            prev_->allocations_ += allocations_;
+            prev_->bytes_ += bytes_;
+        }
+    }
+
+    /// Returns the number of allocations counted.
+    std::size_t
+    allocations() const
+    {
+        return allocations_;
+    }
+
+    /// Returns the number of bytes requested by the allocations counted.
+    std::size_t
+    bytes() const
+    {
+        return bytes_;
+    }
+
+    /// Set the counts to zero, for example after warming up.
+    void
+    reset()
+    {
+        allocations_ = 0;
+        bytes_ = 0;
+    }
+
+    /** Returns `true` if allocations are being counted.
+
+        This checks that the replacement allocation functions are
+        linked in, so that a budget test does not pass by default.
+    */
+    static
+    bool
+    installed()
+    {
+        alloc_counter c;
+        ::operator delete(::operator new(1));
+        return c.allocations() == 1;
+    }
+
+    /// Record an allocation. Called by the replacement `operator new`.
+    static
+    void
+    on_alloc(std::size_t n)
+    {
+        if(auto const p = current())
+        {
+            ++p->allocations_;
+            p->bytes_ += n;
+        }
+    }
+};
+
+} // test
+} // beast
+
+#endif
@@ -0,0 +1,148 @@
+//
+// Copyright (c) 2013-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BEAST_TEST_LATENCY_HISTOGRAM_HPP
+#define BEAST_TEST_LATENCY_HISTOGRAM_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace beast {
+namespace test {
+
+/** A histogram of latencies with bounded relative error.
+
+    Values are recorded into log-linear buckets in the manner of an
+    HDR histogram: values below 128 are exact, and above that each
+    power of two is divided into 64 equal buckets, so a reported
+    percentile is within about 1.6% of the true value. Recording is
+    a few instructions and never allocates.
+
+    The units are up to the caller, typically nanoseconds.
+
+    Histograms filled on separate threads may be combined with
+    @ref merge to compute percentiles over all of them.
+*/
+class latency_histogram
+{
+    static int constexpr sub_bits = 7;
+    static std::size_t constexpr half = std::size_t{1} << (sub_bits - 1);
+
+    std::vector<std::uint64_t> counts_;
+    std::uint64_t total_ = 0;
+    std::uint64_t max_ = 0;
+
+public:
+    latency_histogram()
+        : counts_((64 - sub_bits + 2) * half, 0)
+    {
+    }
+
+    /// Record one value.
+    void
+    record(std::uint64_t v)
+    {
+        ++counts_[index(v)];
+        ++total_;
+        if(v > max_)
+            max_ = v;
+    }
+
+    /// Add the values recorded in another histogram.
+    void
+    merge(latency_histogram const& other)
+    {
+        for(std::size_t i = 0; i < counts_.size(); ++i)
+            counts_[i] += other.counts_[i];
+        total_ += other.total_;
+        if(other.max_ > max_)
+            max_ = other.max_;
+    }
+
+    /// Return the number of values recorded.
+    std::uint64_t
+    count() const
+    {
+        return total_;
+    }
+
+    /// Return the largest value recorded.
+    std::uint64_t
+    max() const
+    {
+        return max_;
+    }
+
+    /** Return the value at a percentile.
+
+        @param p The percentile, from 0 to 100.
+
+        @return The highest value equivalent to the bucket holding
+        the percentile, or zero if nothing was recorded.
+    */
+    std::uint64_t
+    percentile(double p) const
+    {
+        if(total_ == 0)
+            return 0;
+        auto rank = static_cast<std::uint64_t>(
+            p / 100 * static_cast<double>(total_) + 0.5);
+        if(rank < 1)
+            rank = 1;
+        std::uint64_t seen = 0;
+        for(std::size_t i = 0; i < counts_.size(); ++i)
+        {
+            seen += counts_[i];
+            if(seen >= rank)
+            {
+                auto const v = highest(i);
+                return v < max_ ? v : max_;
+            }
+        }
+        return max_;
+    }
+
+private:
+    static
+    int
+    msb(std::uint64_t v)
+    {
+        int n = 0;
+        while(v >>= 1)
+            ++n;
+        return n;
+    }
+
+    static
+    std::size_t
+    index(std::uint64_t v)
+    {
+        if(v < 2 * half)
+            return static_cast<std::size_t>(v);
+        auto const shift = msb(v) - sub_bits + 1;
+        return (shift + 1) * half +
+            static_cast<std::size_t>(v >> shift) - half;
+    }
+
+    // The largest value which maps to bucket i
+    static
+    std::uint64_t
+    highest(std::size_t i)
+    {
+        if(i < 2 * half)
+            return i;
+        auto const shift = static_cast<int>(i / half) - 1;
+        auto const sub = i % half + half;
+        return ((std::uint64_t{sub} + 1) << shift) - 1;
+    }
+};
+
+} // test
+} // beast
+
+#endif
@@ -0,0 +1,458 @@
+//
+// Copyright (c) 2013-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BEAST_TEST_PIPE_HPP
+#define BEAST_TEST_PIPE_HPP
+
+#include <beast/core/async_completion.hpp>
+#include <beast/core/bind_handler.hpp>
+#include <beast/core/error.hpp>
+#include <beast/core/prepare_buffers.hpp>
+#include <beast/core/streambuf.hpp>
+#include <boost/asio/basic_waitable_timer.hpp>
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/error.hpp>
+#include <boost/asio/io_service.hpp>
+#include <boost/assert.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace beast {
+namespace test {
+
+/** A pair of connected in-memory streams.
+
+    Data written to @ref client may be read from @ref server, and data
+    written to @ref server may be read from @ref client. Each end meets
+    the requirements of @b `SyncStream` and @b `AsyncStream`, so that
+    complete HTTP and WebSocket exchanges can run in-process without
+    the cost of the kernel's network stack.
+
+    Writes complete immediately and are never partial. To model a
+    network, each end may limit the bytes returned by one read, and
+    may delay the arrival of written data by a fixed latency.
+
+    Closing an end causes its pending read to complete with
+    `boost::asio::error::operation_aborted`, and reads on the other
+    end to complete with `boost::asio::error::eof` once the data
+    written before the close has been read.
+
+    Each direction is protected by a mutex, so the two ends may be
+    used from different threads. As with a socket, one end must not
+    have more than one read or more than one write pending at once.
+
+    The pipe must outlive its streams and their pending operations.
+
+    Example:
+    @code
+    boost::asio::io_service ios;
+    test::pipe p(ios);
+    p.server.read_size(1);  // deliver one byte per read
+    websocket::stream<test::pipe::stream&> ws(p.client);
+    @endcode
+*/
+class pipe
+{
+public:
+    using clock_type = std::chrono::steady_clock;
+
+    class stream;
+
+private:
+    struct state;
+
+    struct read_op
+    {
+        virtual ~read_op() = default;
+
+        // Called with the state locked
+        virtual void operator()(state& s) = 0;
+    };
+
+    // One direction of the pipe
+    struct state
+    {
+        std::mutex m;
+        std::condition_variable cv;
+        boost::asio::basic_waitable_timer<clock_type> timer;
+        beast::streambuf b;
+        std::size_t ready = 0;
+        std::deque<std::pair<
+            clock_type::time_point, std::size_t>> arriving;
+        std::unique_ptr<read_op> op;
+        std::size_t read_size =
+            (std::numeric_limits<std::size_t>::max)();
+        clock_type::duration latency{};
+        bool waiting = false;
+        bool aborted = false;   // the pending read was cancelled
+        bool eof = false;       // the writing end closed
+        bool closed = false;    // the reading end closed
+
+        explicit
+        state(boost::asio::io_service& ios)
+            : timer(ios)
+        {
+        }
+
+        // Make delayed data readable once it arrives
+        void
+        arrive()
+        {
+            auto const now = clock_type::now();
+            while(! arriving.empty() &&
+                arriving.front().first <= now)
+            {
+                ready += arriving.front().second;
+                arriving.pop_front();
+            }
+        }
+
+        bool
+        can_complete() const
+        {
+            return ready > 0 || closed || aborted ||
+                (eof && arriving.empty());
+        }
+
+        // Called with the state locked
+        void
+        maybe_complete()
+        {
+            arrive();
+            if(! op)
+                return;
+            if(can_complete())
+            {
+                auto const p = std::move(op);
+                (*p)(*this);
+                return;
+            }
+            if(arriving.empty() || waiting)
+                return;
+            waiting = true;
+            timer.expires_at(arriving.front().first);
+            timer.async_wait(
+                [this](error_code const& ec)
+                {
+                    if(ec == boost::asio::error::operation_aborted)
+                        return;
+                    std::lock_guard<std::mutex> lock(m);
+                    waiting = false;
+                    maybe_complete();
+                });
+        }
+
+        // Called with the state locked, after can_complete
+        template<class MutableBufferSequence>
+        std::size_t
+        read(MutableBufferSequence const& buffers, error_code& ec)
+        {
+            if(closed || aborted)
+            {
+                aborted = false;
+                ec = boost::asio::error::operation_aborted;
+                return 0;
+            }
+            if(ready == 0)
+            {
+                ec = boost::asio::error::eof;
+                return 0;
+            }
+            auto const n = boost::asio::buffer_copy(buffers,
+                prepare_buffers((std::min)(ready, read_size), b.data()));
+            b.consume(n);
+            ready -= n;
+            return n;
+        }
+    };
+
+    template<class MutableBufferSequence, class Handler>
+    class read_op_impl : public read_op
+    {
+        boost::asio::io_service& ios_;
+        MutableBufferSequence b_;
+        Handler h_;
+
+    public:
+        template<class DeducedHandler>
+        read_op_impl(boost::asio::io_service& ios,
+                MutableBufferSequence const& b, DeducedHandler&& h)
+            : ios_(ios)
+            , b_(b)
+            , h_(std::forward<DeducedHandler>(h))
+        {
+        }
+
+        void
+        operator()(state& s) override
+        {
+            error_code ec;
+            auto const n = s.read(b_, ec);
+            ios_.post(bind_handler(std::move(h_), ec, n));
+        }
+    };
+
+    state s0_;
+    state s1_;
+
+public:
+    /// One end of the pipe.
+    class stream
+    {
+        friend class pipe;
+
+        boost::asio::io_service* ios_;
+        state* in_;
+        state* out_;
+
+        stream(boost::asio::io_service& ios, state& in, state& out)
+            : ios_(&ios)
+            , in_(&in)
+            , out_(&out)
+        {
+        }
+
+    public:
+        stream(stream&&) = default;
+        stream& operator=(stream&&) = default;
+
+        /// Returns the `io_service` associated with the stream.
+        boost::asio::io_service&
+        get_io_service()
+        {
+            return *ios_;
+        }
+
+        /** Set the largest number of bytes returned by one read.
+
+            The default is unlimited. A small value models data
+            arriving in many small segments.
+        */
+        void
+        read_size(std::size_t n)
+        {
+            BOOST_ASSERT(n > 0);
+            std::lock_guard<std::mutex> lock(in_->m);
+            in_->read_size = n;
+        }
+
+        /** Set the delay before data written by the other end may be read.
+
+            The delay applies to data written after the call.
+            The default is zero.
+        */
+        void
+        latency(clock_type::duration d)
+        {
+            std::lock_guard<std::mutex> lock(in_->m);
+            in_->latency = d;
+        }
+
+        /** Close this end of the pipe.
+
+            A pending read on this end completes with
+            `boost::asio::error::operation_aborted`, and the other end
+            reads `boost::asio::error::eof` after any data written
+            before the close.
+        */
+        void
+        close()
+        {
+            {
+                std::lock_guard<std::mutex> lock(in_->m);
+                in_->closed = true;
+                in_->timer.cancel();
+                in_->waiting = false;
+                in_->maybe_complete();
+                in_->cv.notify_all();
+            }
+            {
+                std::lock_guard<std::mutex> lock(out_->m);
+                out_->eof = true;
+                out_->maybe_complete();
+                out_->cv.notify_all();
+            }
+        }
+
+        /** Cancel the pending read on this end.
+
+            The read completes with `boost::asio::error::operation_aborted`.
+            Writes complete immediately, so they are never cancelled.
+        */
+        void
+        cancel(error_code& ec)
+        {
+            std::lock_guard<std::mutex> lock(in_->m);
+            ec = {};
+            if(! in_->op)
+                return;
+            in_->aborted = true;
+            in_->timer.cancel();
+            in_->waiting = false;
+            in_->maybe_complete();
+        }
+
+        template<class MutableBufferSequence>
+        std::size_t
+        read_some(MutableBufferSequence const& buffers)
+        {
+            error_code ec;
+            auto const n = read_some(buffers, ec);
+            if(ec)
+                throw system_error{ec};
+            return n;
+        }
+
+        template<class MutableBufferSequence>
+        std::size_t
+        read_some(MutableBufferSequence const& buffers,
+            error_code& ec)
+        {
+            ec = {};
+            if(boost::asio::buffer_size(buffers) == 0)
+                return 0;
+            std::unique_lock<std::mutex> lock(in_->m);
+            for(;;)
+            {
+                in_->arrive();
+                if(in_->can_complete())
+                    return in_->read(buffers, ec);
+                if(in_->arriving.empty())
+                    in_->cv.wait(lock);
+                else
+                    in_->cv.wait_until(lock,
+                        in_->arriving.front().first);
+            }
+        }
+
+        template<class MutableBufferSequence, class ReadHandler>
+        typename async_completion<ReadHandler,
+            void(error_code, std::size_t)>::result_type
+        async_read_some(MutableBufferSequence const& buffers,
+            ReadHandler&& handler)
+        {
+            async_completion<ReadHandler,
+                void(error_code, std::size_t)> completion(handler);
+            if(boost::asio::buffer_size(buffers) == 0)
+            {
+                ios_->post(bind_handler(
+                    completion.handler, error_code{}, 0));
+                return completion.result.get();
+            }
+            std::lock_guard<std::mutex> lock(in_->m);
+            BOOST_ASSERT(! in_->op);
+            in_->op.reset(new read_op_impl<MutableBufferSequence,
+                typename std::decay<decltype(completion.handler)>::type>(
+                    *ios_, buffers, std::move(completion.handler)));
+            in_->maybe_complete();
+            return completion.result.get();
+        }
+
+        template<class ConstBufferSequence>
+        std::size_t
+        write_some(ConstBufferSequence const& buffers)
+        {
+            error_code ec;
+            auto const n = write_some(buffers, ec);
+            if(ec)
+                throw system_error{ec};
+            return n;
+        }
+
+        template<class ConstBufferSequence>
+        std::size_t
+        write_some(ConstBufferSequence const& buffers,
+            error_code& ec)
+        {
+            std::lock_guard<std::mutex> lock(out_->m);
+            if(out_->eof)
+            {
+                ec = boost::asio::error::bad_descriptor;
+                return 0;
+            }
+            if(out_->closed)
+            {
+                ec = boost::asio::error::broken_pipe;
+                return 0;
+            }
+            ec = {};
+            auto const n = boost::asio::buffer_copy(
+                out_->b.prepare(boost::asio::buffer_size(buffers)),
+                    buffers);
+            out_->b.commit(n);
+            if(out_->latency == clock_type::duration::zero())
+                out_->ready += n;
+            else
+                out_->arriving.emplace_back(
+                    clock_type::now() + out_->latency, n);
+            out_->maybe_complete();
+            out_->cv.notify_all();
+            return n;
+        }
+
+        template<class ConstBufferSequence, class WriteHandler>
+        typename async_completion<WriteHandler,
+            void(error_code, std::size_t)>::result_type
+        async_write_some(ConstBufferSequence const& buffers,
+            WriteHandler&& handler)
+        {
+            async_completion<WriteHandler,
+                void(error_code, std::size_t)> completion(handler);
+            error_code ec;
+            auto const n = write_some(buffers, ec);
+            ios_->post(bind_handler(completion.handler, ec, n));
+            return completion.result.get();
+        }
+
+        friend
+        void
+        teardown(stream& s, boost::system::error_code& ec)
+        {
+            s.close();
+            ec = {};
+        }
+
+        template<class TeardownHandler>
+        friend
+        void
+        async_teardown(stream& s, TeardownHandler&& handler)
+        {
+            s.close();
+            s.get_io_service().post(bind_handler(
+                std::forward<TeardownHandler>(handler), error_code{}));
+        }
+    };
+
+    /// The end which usually initiates the exchange.
+    stream client;
+
+    /// The end which usually responds.
+    stream server;
+
+    pipe(pipe const&) = delete;
+    pipe& operator=(pipe const&) = delete;
+
+    /// Construct a pipe whose ends use the given `io_service`.
+    explicit
+    pipe(boost::asio::io_service& ios)
+        : s0_(ios)
+        , s1_(ios)
+        , client(ios, s0_, s1_)
+        , server(ios, s1_, s0_)
+    {
+    }
+};
+
+} // test
+} // beast
+
+#endif
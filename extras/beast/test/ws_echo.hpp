@@ -0,0 +1,166 @@
+//
+// Copyright (c) 2013-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BEAST_TEST_WS_ECHO_HPP
+#define BEAST_TEST_WS_ECHO_HPP
+
+#include <beast/core/error.hpp>
+#include <beast/core/streambuf.hpp>
+#include <beast/core/to_string.hpp>
+#include <beast/websocket/stream.hpp>
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/io_service.hpp>
+#include <functional>
+#include <string>
+
+namespace beast {
+namespace test {
+
+/// Optional callbacks for @ref run_echo.
+struct echo_hooks
+{
+    /// Called when the server's accept completes.
+    std::function<void()> accepted;
+
+    /// Called when the server's final read completes.
+    std::function<void()> server_closed;
+
+    /// Called when the client's final read completes.
+    std::function<void()> client_closed;
+};
+
+/// The outcome of @ref run_echo.
+struct echo_result
+{
+    /// The message the client received.
+    std::string echoed;
+
+    /// The error which ended the server's exchange.
+    error_code server;
+
+    /// The error which ended the client's exchange.
+    error_code client;
+};
+
+/** Run a WebSocket echo exchange between two connected streams.
+
+    The server accepts, echoes one message, and reads until the client
+    closes. The client performs the handshake, sends "Hello", reads the
+    echo, then closes and reads until the server's close frame arrives.
+    The io_service is run until both sides are done. In a successful
+    exchange both errors are `websocket::error::closed`.
+
+    The side which starts the close does not tear down its connection,
+    so when the server's teardown waits for the client to close, the
+    `client_closed` hook should close the client's next layer.
+*/
+template<class ServerStream, class ClientStream>
+echo_result
+run_echo(websocket::stream<ServerStream>& server,
+    websocket::stream<ClientStream>& client,
+        boost::asio::io_service& ios,
+            echo_hooks const& hooks = {})
+{
+    using boost::asio::buffer;
+    echo_result result;
+    websocket::opcode op;
+    streambuf sb1;
+    streambuf sb2;
+    auto const call =
+        [](std::function<void()> const& f)
+        {
+            if(f)
+                f();
+        };
+    server.async_accept(
+        [&](error_code ec)
+        {
+            call(hooks.accepted);
+            if(ec)
+            {
+                result.server = ec;
+                return;
+            }
+            server.async_read(op, sb1,
+                [&](error_code ec)
+                {
+                    if(ec)
+                    {
+                        result.server = ec;
+                        return;
+                    }
+                    server.async_write(sb1.data(),
+                        [&](error_code ec)
+                        {
+                            if(ec)
+                            {
+                                result.server = ec;
+                                return;
+                            }
+                            // Completes when the client closes
+                            sb1.consume(sb1.size());
+                            server.async_read(op, sb1,
+                                [&](error_code ec)
+                                {
+                                    result.server = ec;
+                                    call(hooks.server_closed);
+                                });
+                        });
+                });
+        });
+    client.async_handshake("localhost", "/",
+        [&](error_code ec)
+        {
+            if(ec)
+            {
+                result.client = ec;
+                return;
+            }
+            client.async_write(buffer("Hello", 5),
+                [&](error_code ec)
+                {
+                    if(ec)
+                    {
+                        result.client = ec;
+                        return;
+                    }
+                    client.async_read(op, sb2,
+                        [&](error_code ec)
+                        {
+                            if(ec)
+                            {
+                                result.client = ec;
+                                return;
+                            }
+                            result.echoed = to_string(sb2.data());
+                            client.async_close(
+                                websocket::close_code::normal,
+                                [&](error_code ec)
+                                {
+                                    if(ec)
+                                    {
+                                        result.client = ec;
+                                        return;
+                                    }
+                                    client.async_read(op, sb2,
+                                        [&](error_code ec)
+                                        {
+                                            result.client = ec;
+                                            call(hooks.client_closed);
+                                        });
+                                });
+                        });
+                });
+        });
+    ios.run();
+    return result;
+}
+
+} // test
+} // beast
+
+#endif
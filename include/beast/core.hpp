@@ -14,18 +14,28 @@
 #include <beast/core/buffer_cat.hpp>
 #include <beast/core/buffer_concepts.hpp>
 #include <beast/core/buffers_adapter.hpp>
+#include <beast/core/circular_streambuf.hpp>
 #include <beast/core/consuming_buffers.hpp>
 #include <beast/core/error.hpp>
+#include <beast/core/flat_streambuf.hpp>
 #include <beast/core/handler_alloc.hpp>
 #include <beast/core/handler_concepts.hpp>
+#include <beast/core/handler_ptr.hpp>
 #include <beast/core/placeholders.hpp>
 #include <beast/core/prepare_buffers.hpp>
+#include <beast/core/recycle_handler.hpp>
 #include <beast/core/static_streambuf.hpp>
 #include <beast/core/static_string.hpp>
+#include <beast/core/stats_stream.hpp>
 #include <beast/core/stream_concepts.hpp>
+#include <beast/core/stream_stats.hpp>
 #include <beast/core/streambuf.hpp>
+#include <beast/core/streambuf_pool.hpp>
 #include <beast/core/dynabuf_readstream.hpp>
+#include <beast/core/timeout_stream.hpp>
+#include <beast/core/timer_wheel.hpp>
 #include <beast/core/to_string.hpp>
+#include <beast/core/trace.hpp>
 #include <beast/core/write_dynabuf.hpp>
 
 #endif
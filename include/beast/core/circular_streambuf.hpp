@@ -0,0 +1,166 @@
+//
+// Copyright (c) 2013-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BEAST_CIRCULAR_STREAMBUF_HPP
+#define BEAST_CIRCULAR_STREAMBUF_HPP
+
+#include <boost/asio/buffer.hpp>
+#include <cstddef>
+#include <cstdint>
+
+#if ! defined(_WIN32)
+
+namespace beast {
+
+/** A @b `DynamicBuffer` using a fixed size circular buffer.
+
+    The storage is a ring of memory pages which is mapped twice into
+    the address space, one mapping directly after the other. Bytes
+    written past the end of the first mapping appear at the start of
+    the ring, so the input sequence and the output sequence are each
+    a single contiguous buffer no matter where they wrap around.
+    Nothing is ever copied or reallocated: `consume` and `commit` only
+    move offsets.
+
+    The capacity is fixed at construction and rounded up to a multiple
+    of the page size. Calls to `prepare` which would exceed it throw
+    `std::length_error`.
+
+    This class is available on POSIX systems only. On Linux the pages
+    come from `memfd_create`, elsewhere from `shm_open`.
+
+    @note Meets the requirements of @b `DynamicBuffer`.
+*/
+class circular_streambuf
+{
+    std::uint8_t* base_ = nullptr;
+    std::size_t size_ = 0;  // capacity
+    std::size_t in_ = 0;    // input offset
+    std::size_t len_ = 0;   // input size
+    std::size_t out_ = 0;   // output size
+
+public:
+    /// The type used to represent the input sequence as a list of buffers.
+    using const_buffers_type = boost::asio::const_buffers_1;
+
+    /// The type used to represent the output sequence as a list of buffers.
+    using mutable_buffers_type = boost::asio::mutable_buffers_1;
+
+    /// Destructor.
+    ~circular_streambuf();
+
+    /** Move constructor.
+
+        After the move, the moved-from object will have
+        no storage and a capacity of zero.
+    */
+    circular_streambuf(circular_streambuf&& other);
+
+    /** Move assignment.
+
+        After the move, the moved-from object will have
+        no storage and a capacity of zero.
+    */
+    circular_streambuf&
+    operator=(circular_streambuf&& other);
+
+    /** Default constructor.
+
+        The stream buffer will have no storage and a capacity of
+        zero. A buffer with storage may be move assigned to it. This
+        allows the class to be used where a default constructible
+        @b `DynamicBuffer` is required, such as @ref dynabuf_readstream.
+    */
+    circular_streambuf() = default;
+
+    /** Construct a circular stream buffer.
+
+        @param capacity The minimum capacity. This is rounded up
+        to a multiple of the page size.
+
+        @throws system_error if the storage cannot be mapped.
+    */
+    explicit
+    circular_streambuf(std::size_t capacity);
+
+    /// Returns the size of the input sequence.
+    std::size_t
+    size() const
+    {
+        return len_;
+    }
+
+    /// Returns the permitted maximum sum of the sizes of the input and output sequence.
+    std::size_t
+    max_size() const
+    {
+        return size_;
+    }
+
+    /// Returns the maximum sum of the sizes of the input sequence and output sequence the buffer can hold without requiring reallocation.
+    std::size_t
+    capacity() const
+    {
+        return size_;
+    }
+
+    /// Get a buffer that represents the input sequence.
+    const_buffers_type
+    data() const
+    {
+        return const_buffers_type{base_ + in_, len_};
+    }
+
+    /** Get a buffer that represents the output sequence, with the given size.
+
+        @throws std::length_error if `size() + n` exceeds `max_size()`.
+
+        @note Buffers representing the input sequence acquired prior to
+        this call remain valid.
+    */
+    mutable_buffers_type
+    prepare(std::size_t n);
+
+    /** Move bytes from the output sequence to the input sequence.
+
+        @note Buffers representing the input sequence acquired prior to
+        this call remain valid.
+    */
+    void
+    commit(std::size_t n)
+    {
+        len_ += n < out_ ? n : out_;
+        out_ = 0;
+    }
+
+    /// Remove bytes from the input sequence.
+    void
+    consume(std::size_t n);
+
+    // Helper for boost::asio::read_until
+    friend
+    std::size_t
+    read_size_helper(circular_streambuf const& streambuf,
+        std::size_t max_size)
+    {
+        auto const avail =
+            streambuf.size_ - streambuf.len_;
+        return max_size < avail ? max_size : avail;
+    }
+
+private:
+    void
+    release();
+};
+
+} // beast
+
+#include <beast/core/impl/circular_streambuf.ipp>
+
+#endif
+
+#endif
@@ -0,0 +1,33 @@
+//
+// Copyright (c) 2013-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BEAST_DETAIL_IS_STREAM_SOCKET_HPP
+#define BEAST_DETAIL_IS_STREAM_SOCKET_HPP
+
+#include <boost/asio/basic_stream_socket.hpp>
+#include <type_traits>
+
+namespace beast {
+namespace detail {
+
+// true if T is a boost::asio::basic_stream_socket,
+// which supports waiting with null_buffers.
+template<class T>
+struct is_stream_socket : std::false_type
+{
+};
+
+template<class Protocol, class StreamSocketService>
+struct is_stream_socket<boost::asio::basic_stream_socket<
+        Protocol, StreamSocketService>> : std::true_type
+{
+};
+
+} // detail
+} // beast
+
+#endif
@@ -0,0 +1,136 @@
+//
+// Copyright (c) 2013-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BEAST_DETAIL_RECYCLE_CACHE_HPP
+#define BEAST_DETAIL_RECYCLE_CACHE_HPP
+
+#include <beast/core/detail/thread_local_instance.hpp>
+#include <cstddef>
+#include <new>
+
+namespace beast {
+namespace detail {
+
+/*  Per-thread cache of memory blocks for handlers.
+
+    Requests are rounded up to a power of two size class between
+    64 and 4096 bytes. Freed blocks go on the list for their class
+    in the freeing thread's cache, up to a limit, and are handed out
+    again by the next allocation of that class on the same thread.
+    Larger requests, and blocks freed while a list is full, go
+    straight to the global operator new and delete.
+
+    Since every block of a class has the same size, a block may be
+    freed on a different thread than the one which allocated it.
+*/
+class recycle_cache
+{
+    struct block
+    {
+        block* next;
+    };
+
+    static std::size_t constexpr min_size = 64;
+    static std::size_t constexpr classes = 7;       // 64..4096
+    static std::size_t constexpr max_blocks = 32;   // per class
+
+    block* free_[classes];
+    std::size_t count_[classes];
+
+    recycle_cache()
+    {
+        for(std::size_t i = 0; i < classes; ++i)
+        {
+            free_[i] = nullptr;
+            count_[i] = 0;
+        }
+    }
+
+    ~recycle_cache()
+    {
+        for(std::size_t i = 0; i < classes; ++i)
+        {
+            while(free_[i])
+            {
+                auto const b = free_[i];
+                free_[i] = b->next;
+                ::operator delete(b);
+            }
+        }
+    }
+
+    friend class thread_local_instance<recycle_cache>;
+
+    static
+    recycle_cache*
+    get()
+    {
+        return thread_local_instance<recycle_cache>::get();
+    }
+
+    // Returns the size class, or `classes` if none fits
+    static
+    std::size_t
+    index(std::size_t size)
+    {
+        std::size_t i = 0;
+        std::size_t n = min_size;
+        while(i < classes && size > n)
+        {
+            n <<= 1;
+            ++i;
+        }
+        return i;
+    }
+
+public:
+    recycle_cache(recycle_cache const&) = delete;
+    recycle_cache& operator=(recycle_cache const&) = delete;
+
+    static
+    void*
+    allocate(std::size_t size)
+    {
+        auto const i = index(size);
+        if(i == classes)
+            return ::operator new(size);
+        auto const c = get();
+        if(c && c->free_[i])
+        {
+            auto const b = c->free_[i];
+            c->free_[i] = b->next;
+            --c->count_[i];
+            return b;
+        }
+        return ::operator new(min_size << i);
+    }
+
+    static
+    void
+    deallocate(void* p, std::size_t size)
+    {
+        auto const i = index(size);
+        if(i < classes)
+        {
+            auto const c = get();
+            if(c && c->count_[i] < max_blocks)
+            {
+                auto const b = static_cast<block*>(p);
+                b->next = c->free_[i];
+                c->free_[i] = b;
+                ++c->count_[i];
+                return;
+            }
+        }
+        ::operator delete(p);
+    }
+};
+
+} // detail
+} // beast
+
+#endif
@@ -0,0 +1,89 @@
+//
+// Copyright (c) 2013-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BEAST_DETAIL_RECYCLED_HANDLER_HPP
+#define BEAST_DETAIL_RECYCLED_HANDLER_HPP
+
+#include <beast/core/detail/recycle_cache.hpp>
+#include <boost/asio/detail/handler_cont_helpers.hpp>
+#include <boost/asio/detail/handler_invoke_helpers.hpp>
+#include <type_traits>
+#include <utility>
+
+namespace beast {
+namespace detail {
+
+/*  Handler which allocates from the per-thread recycle cache.
+
+    The recycled handler provides the same io_service execution
+    guarantees as the original handler.
+*/
+template<class Handler>
+class recycled_handler
+{
+private:
+    Handler h_;
+
+public:
+    recycled_handler(recycled_handler&&) = default;
+    recycled_handler(recycled_handler const&) = default;
+
+    template<class DeducedHandler,
+        class = typename std::enable_if<! std::is_same<
+            typename std::decay<DeducedHandler>::type,
+                recycled_handler>::value>::type>
+    explicit
+    recycled_handler(DeducedHandler&& handler)
+        : h_(std::forward<DeducedHandler>(handler))
+    {
+    }
+
+    template<class... Args>
+    void
+    operator()(Args&&... args)
+    {
+        h_(std::forward<Args>(args)...);
+    }
+
+    friend
+    void*
+    asio_handler_allocate(
+        std::size_t size, recycled_handler*)
+    {
+        return recycle_cache::allocate(size);
+    }
+
+    friend
+    void
+    asio_handler_deallocate(
+        void* p, std::size_t size, recycled_handler*)
+    {
+        recycle_cache::deallocate(p, size);
+    }
+
+    friend
+    bool
+    asio_handler_is_continuation(recycled_handler* h)
+    {
+        return boost_asio_handler_cont_helpers::
+            is_continuation(h->h_);
+    }
+
+    template<class F>
+    friend
+    void
+    asio_handler_invoke(F&& f, recycled_handler* h)
+    {
+        boost_asio_handler_invoke_helpers::
+            invoke(f, h->h_);
+    }
+};
+
+} // detail
+} // beast
+
+#endif
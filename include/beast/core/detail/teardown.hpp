@@ -0,0 +1,33 @@
+//
+// Copyright (c) 2013-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BEAST_DETAIL_TEARDOWN_HPP
+#define BEAST_DETAIL_TEARDOWN_HPP
+
+#include <beast/core/error.hpp>
+
+namespace beast {
+namespace websocket_helpers {
+
+// Declared here so that the stream wrappers in core can
+// pass a WebSocket teardown to their next layer without
+// including websocket headers. The definitions are in
+// <beast/websocket/teardown.hpp>, which is included
+// wherever a teardown is requested.
+
+template<class Socket>
+void
+call_teardown(Socket& socket, error_code& ec);
+
+template<class Socket, class TeardownHandler>
+void
+call_async_teardown(Socket& socket, TeardownHandler&& handler);
+
+} // websocket_helpers
+} // beast
+
+#endif
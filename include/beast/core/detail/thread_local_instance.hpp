@@ -0,0 +1,59 @@
+//
+// Copyright (c) 2013-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BEAST_DETAIL_THREAD_LOCAL_INSTANCE_HPP
+#define BEAST_DETAIL_THREAD_LOCAL_INSTANCE_HPP
+
+namespace beast {
+namespace detail {
+
+/*  Provides one instance of T for each thread.
+
+    The instance is constructed on first use. During thread exit
+    the instance may be destroyed before other thread_local objects
+    which still refer to it, such as handlers or buffers released
+    late; from the time its destruction begins, get() returns null
+    and callers fall back to the global allocator.
+*/
+template<class T>
+class thread_local_instance
+{
+    struct holder
+    {
+        T t;
+
+        ~holder()
+        {
+            // Runs before t is destroyed
+            destroyed() = true;
+        }
+    };
+
+    static
+    bool&
+    destroyed()
+    {
+        static thread_local bool b = false;
+        return b;
+    }
+
+public:
+    static
+    T*
+    get()
+    {
+        if(destroyed())
+            return nullptr;
+        static thread_local holder h;
+        return &h.t;
+    }
+};
+
+} // detail
+} // beast
+
+#endif
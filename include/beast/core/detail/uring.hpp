@@ -0,0 +1,324 @@
+//
+// Copyright (c) 2013-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BEAST_DETAIL_URING_HPP
+#define BEAST_DETAIL_URING_HPP
+
+#include <beast/core/error.hpp>
+#include <boost/asio/buffer.hpp>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <linux/io_uring.h>
+#include <linux/version.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+// Multishot receive and provided buffer rings
+// need the definitions from Linux 6.0.
+#if LINUX_VERSION_CODE < KERNEL_VERSION(6,0,0)
+#error "io_uring support requires Linux kernel headers 6.0 or later"
+#endif
+
+namespace beast {
+namespace detail {
+
+// An operation waiting for a completion queue entry.
+// The address of the operation is the user_data.
+struct uring_op
+{
+    virtual
+    ~uring_op() = default;
+
+    // Called for each completion. res is the result of the
+    // system call, or a negated errno value on failure.
+    virtual
+    void
+    complete(int res, unsigned flags) = 0;
+};
+
+// The leading non-empty buffers of a
+// sequence, as an array of iovec.
+struct uring_buffers
+{
+    static std::size_t constexpr max_iov = 16;
+
+    iovec iov[max_iov];
+    std::size_t count = 0;
+    std::size_t size = 0;
+
+    template<class BufferSequence>
+    explicit
+    uring_buffers(BufferSequence const& buffers)
+    {
+        using boost::asio::buffer_cast;
+        using boost::asio::buffer_size;
+        for(auto it = buffers.begin();
+            it != buffers.end() && count < max_iov; ++it)
+        {
+            boost::asio::const_buffer const b = *it;
+            auto const n = buffer_size(b);
+            if(n == 0)
+                continue;
+            iov[count].iov_base = const_cast<void*>(
+                buffer_cast<void const*>(b));
+            iov[count].iov_len = n;
+            ++count;
+            size += n;
+        }
+    }
+};
+
+// A minimal io_uring instance using the raw system calls, so
+// that no library besides the kernel headers is required.
+//
+// The ring is not thread safe.
+//
+class uring
+{
+    int fd_ = -1;
+
+    void* sq_ptr_ = nullptr;
+    std::size_t sq_len_ = 0;
+    void* cq_ptr_ = nullptr;
+    std::size_t cq_len_ = 0;
+    io_uring_sqe* sqes_ = nullptr;
+    std::size_t sqes_len_ = 0;
+
+    unsigned* sq_head_;
+    unsigned* sq_tail_;
+    unsigned* sq_array_;
+    unsigned sq_mask_;
+    unsigned sq_entries_;
+    unsigned sq_local_tail_ = 0;
+    unsigned to_submit_ = 0;
+
+    unsigned* cq_head_;
+    unsigned* cq_tail_;
+    unsigned cq_mask_;
+    io_uring_cqe* cqes_;
+
+public:
+    uring(uring const&) = delete;
+    uring& operator=(uring const&) = delete;
+
+    ~uring()
+    {
+        close();
+    }
+
+    // Throws system_error if the kernel does not provide io_uring
+    explicit
+    uring(unsigned entries)
+    {
+        io_uring_params p;
+        std::memset(&p, 0, sizeof(p));
+        p.flags = IORING_SETUP_CQSIZE;
+        p.cq_entries = 4 * entries;
+        fd_ = static_cast<int>(::syscall(
+            __NR_io_uring_setup, entries, &p));
+        if(fd_ == -1)
+            fail();
+        sq_len_ = p.sq_off.array +
+            p.sq_entries * sizeof(unsigned);
+        cq_len_ = p.cq_off.cqes +
+            p.cq_entries * sizeof(io_uring_cqe);
+        bool const single = (p.features &
+            IORING_FEAT_SINGLE_MMAP) != 0;
+        if(single && cq_len_ > sq_len_)
+            sq_len_ = cq_len_;
+        sq_ptr_ = map(sq_len_, IORING_OFF_SQ_RING);
+        if(single)
+            cq_ptr_ = sq_ptr_;
+        else
+            cq_ptr_ = map(cq_len_, IORING_OFF_CQ_RING);
+        sqes_len_ = p.sq_entries * sizeof(io_uring_sqe);
+        sqes_ = static_cast<io_uring_sqe*>(
+            map(sqes_len_, IORING_OFF_SQES));
+
+        auto const sq = static_cast<char*>(sq_ptr_);
+        sq_head_ = reinterpret_cast<unsigned*>(sq + p.sq_off.head);
+        sq_tail_ = reinterpret_cast<unsigned*>(sq + p.sq_off.tail);
+        sq_array_ = reinterpret_cast<unsigned*>(sq + p.sq_off.array);
+        sq_mask_ = *reinterpret_cast<unsigned*>(
+            sq + p.sq_off.ring_mask);
+        sq_entries_ = p.sq_entries;
+        sq_local_tail_ = *sq_tail_;
+
+        auto const cq = static_cast<char*>(cq_ptr_);
+        cq_head_ = reinterpret_cast<unsigned*>(cq + p.cq_off.head);
+        cq_tail_ = reinterpret_cast<unsigned*>(cq + p.cq_off.tail);
+        cq_mask_ = *reinterpret_cast<unsigned*>(
+            cq + p.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe*>(
+            cq + p.cq_off.cqes);
+    }
+
+    int
+    native_handle() const
+    {
+        return fd_;
+    }
+
+    // Number of entries queued but not yet submitted
+    unsigned
+    pending() const
+    {
+        return to_submit_;
+    }
+
+    // Returns a zeroed submission queue entry,
+    // or nullptr if the submission queue is full.
+    io_uring_sqe*
+    get_sqe()
+    {
+        auto const head =
+            __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+        if(sq_local_tail_ - head >= sq_entries_)
+            return nullptr;
+        auto const i = sq_local_tail_ & sq_mask_;
+        auto const sqe = &sqes_[i];
+        std::memset(sqe, 0, sizeof(*sqe));
+        sq_array_[i] = i;
+        ++sq_local_tail_;
+        ++to_submit_;
+        return sqe;
+    }
+
+    // Submit all queued entries with one system call
+    void
+    submit(error_code& ec)
+    {
+        if(to_submit_ == 0)
+            return;
+        __atomic_store_n(sq_tail_,
+            sq_local_tail_, __ATOMIC_RELEASE);
+        while(to_submit_ > 0)
+        {
+            auto const n = ::syscall(__NR_io_uring_enter,
+                fd_, to_submit_, 0, 0, nullptr, 0);
+            if(n < 0)
+            {
+                if(errno == EINTR)
+                    continue;
+                ec.assign(errno,
+                    boost::system::generic_category());
+                return;
+            }
+            to_submit_ -= static_cast<unsigned>(n);
+        }
+    }
+
+    // Calls f(cqe) for each available completion.
+    // Returns the number of completions.
+    template<class F>
+    unsigned
+    reap(F&& f)
+    {
+        auto head = *cq_head_;
+        unsigned n = 0;
+        for(;;)
+        {
+            auto const tail =
+                __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+            if(head == tail)
+                break;
+            // Copy the entry and release its slot
+            // before the upcall, which may submit.
+            auto const cqe = cqes_[head & cq_mask_];
+            ++head;
+            ++n;
+            __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+            f(cqe);
+        }
+        return n;
+    }
+
+    void
+    register_eventfd(int fd, error_code& ec)
+    {
+        do_register(IORING_REGISTER_EVENTFD, &fd, 1, ec);
+    }
+
+    void
+    register_buffers(
+        iovec const* iov, unsigned n, error_code& ec)
+    {
+        do_register(IORING_REGISTER_BUFFERS, iov, n, ec);
+    }
+
+    void
+    unregister_buffers(error_code& ec)
+    {
+        do_register(IORING_UNREGISTER_BUFFERS, nullptr, 0, ec);
+    }
+
+    void
+    register_buf_ring(io_uring_buf_reg& reg, error_code& ec)
+    {
+        do_register(IORING_REGISTER_PBUF_RING, &reg, 1, ec);
+    }
+
+private:
+    void
+    close()
+    {
+        if(sqes_)
+            ::munmap(sqes_, sqes_len_);
+        if(cq_ptr_ && cq_ptr_ != sq_ptr_)
+            ::munmap(cq_ptr_, cq_len_);
+        if(sq_ptr_)
+            ::munmap(sq_ptr_, sq_len_);
+        if(fd_ != -1)
+            ::close(fd_);
+        sqes_ = nullptr;
+        cq_ptr_ = nullptr;
+        sq_ptr_ = nullptr;
+        fd_ = -1;
+    }
+
+    // Releases everything acquired so far, since
+    // the destructor does not run when a constructor
+    // throws, and reports the last error.
+    [[noreturn]]
+    void
+    fail()
+    {
+        error_code const ec{errno,
+            boost::system::generic_category()};
+        close();
+        throw system_error{ec};
+    }
+
+    void*
+    map(std::size_t size, unsigned long long offset)
+    {
+        auto const p = ::mmap(nullptr, size,
+            PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                fd_, static_cast<off_t>(offset));
+        if(p == MAP_FAILED)
+            fail();
+        return p;
+    }
+
+    void
+    do_register(unsigned op,
+        void const* arg, unsigned n, error_code& ec)
+    {
+        if(::syscall(__NR_io_uring_register,
+                fd_, op, arg, n) < 0)
+            ec.assign(errno,
+                boost::system::generic_category());
+    }
+};
+
+} // detail
+} // beast
+
+#endif
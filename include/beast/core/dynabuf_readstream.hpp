@@ -14,10 +14,12 @@
 #include <beast/core/stream_concepts.hpp>
 #include <beast/core/streambuf.hpp>
 #include <beast/core/detail/get_lowest_layer.hpp>
+#include <beast/core/detail/is_stream_socket.hpp>
 #include <boost/asio/buffer.hpp>
 #include <boost/asio/io_service.hpp>
 #include <boost/system/error_code.hpp>
 #include <cstdint>
+#include <type_traits>
 #include <utility>
 
 namespace beast {
@@ -98,8 +100,14 @@ class dynabuf_readstream
 
     DynamicBuffer sb_;
     std::size_t capacity_ = 0;
+    std::size_t read_max_ = 0;
+    std::size_t read_size_ = 0;
+    bool release_ = false;
     Stream next_layer_;
 
+    using can_wait = detail::is_stream_socket<
+        typename std::remove_reference<Stream>::type>;
+
 public:
     /// The type of the internal buffer
     using dynabuf_type = DynamicBuffer;
@@ -214,6 +222,65 @@ public:
         capacity_ = size;
     }
 
+    /** Set the limit for adaptive read sizes.
+
+        By default each buffered read asks the next layer for at most
+        the number of bytes set with @ref capacity. When the limit is
+        greater than that, the read size adapts to the traffic: it
+        doubles each time a read fills the prepared buffer, up to the
+        limit, and halves each time a read uses less than a quarter
+        of it, down to the capacity. Bulk transfers are then received
+        with fewer, larger reads while idle connections keep small
+        buffers.
+
+        Only the size of each read is tuned. A @ref streambuf
+        prepares a single element large enough for the whole read,
+        so the next layer receives one contiguous buffer.
+
+        Thread safety:
+            The caller is responsible for making sure the call is
+            made from the same implicit or explicit strand.
+
+        @param limit The largest number of bytes to read at once.
+        If this is not greater than the capacity, the read size
+        does not adapt.
+    */
+    void
+    read_size_limit(std::size_t limit)
+    {
+        read_max_ = limit;
+    }
+
+    /** Set whether the internal buffer is released while idle.
+
+        When enabled, the internal buffer is replaced with an empty
+        copy of itself when it is empty at the time of this call, and
+        each time a read starts or finishes with it empty, freeing its
+        memory while the connection has nothing to read. The copy
+        keeps the allocator and allocation size of the buffer. If the
+        next layer is a socket, buffered reads first
+        wait for the socket to become readable using
+        `boost::asio::null_buffers`, so that memory for the buffer is
+        only acquired once data has arrived.
+
+        Combined with a @b `DynamicBuffer` that draws from a shared
+        pool, such as @ref pooled_streambuf, this allows a large
+        number of mostly idle connections to share a small amount
+        of buffer memory.
+
+        Thread safety:
+            The caller is responsible for making sure the call is
+            made from the same implicit or explicit strand.
+
+        @param value `true` to release the buffer while idle.
+    */
+    void
+    release_when_idle(bool value)
+    {
+        release_ = value;
+        maybe_release();
+    }
+
     /// Write the given data to the stream. Returns the number of bytes written.
     /// Throws an exception on failure.
     template<class ConstBufferSequence>
@@ -271,6 +338,86 @@ public:
 #endif
     async_read_some(MutableBufferSequence const& buffers,
         ReadHandler&& handler);
+
+private:
+    // Returns the number of bytes to prepare for a buffered read
+    std::size_t
+    read_size() const
+    {
+        if(read_max_ <= capacity_)
+            return capacity_;
+        if(read_size_ < capacity_)
+            return capacity_;
+        if(read_size_ > read_max_)
+            return read_max_;
+        return read_size_;
+    }
+
+    // Update the adaptive read size after a read of
+    // bytes_transferred into a buffer of the given size
+    void
+    adapt(std::size_t size, std::size_t bytes_transferred)
+    {
+        if(read_max_ <= capacity_)
+            return;
+        if(bytes_transferred >= size)
+            read_size_ = size <= read_max_ / 2 ?
+                size * 2 : read_max_;
+        else if(bytes_transferred < size / 4)
+            read_size_ = size / 2;
+        else
+            read_size_ = size;
+    }
+
+    void
+    maybe_release()
+    {
+        maybe_release(std::integral_constant<bool,
+            std::is_copy_constructible<DynamicBuffer>::value &&
+                std::is_move_assignable<DynamicBuffer>::value>{});
+    }
+
+    void
+    maybe_release(std::true_type)
+    {
+        // A copy of the empty buffer holds no memory, and
+        // keeps the allocator and the allocation size.
+        if(release_ && sb_.size() == 0)
+            sb_ = DynamicBuffer(
+                static_cast<DynamicBuffer const&>(sb_));
+    }
+
+    void
+    maybe_release(std::false_type)
+    {
+    }
+
+    void
+    wait_readable(error_code& ec, std::true_type)
+    {
+        next_layer_.read_some(
+            boost::asio::null_buffers{}, ec);
+    }
+
+    void
+    wait_readable(error_code&, std::false_type)
+    {
+    }
+
+    template<class Handler>
+    void
+    async_wait_readable(Handler&& handler, std::true_type)
+    {
+        next_layer_.async_read_some(
+            boost::asio::null_buffers{},
+                std::forward<Handler>(handler));
+    }
+
+    template<class Handler>
+    void
+    async_wait_readable(Handler&&, std::false_type)
+    {
+    }
 };
 
 } // beast
@@ -0,0 +1,168 @@
+//
+// Copyright (c) 2013-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BEAST_HANDLER_PTR_HPP
+#define BEAST_HANDLER_PTR_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace beast {
+
+/** A smart pointer container for the state of a composed operation.
+
+    This container owns a completion handler together with an object
+    of type `T` holding the state of an asynchronous operation. Both
+    are placed in a single block of memory obtained from the
+    handler's `asio_handler_allocate` customization, so a composed
+    operation using this container performs no allocations of its
+    own when the handler provides recycled memory.
+
+    The object of type `T` is constructed with a reference to the
+    stored handler as its first argument, followed by any additional
+    arguments passed to the constructor of the container.
+
+    Calling @ref invoke destroys the owned object and frees the
+    memory before the handler is invoked, as required for handler
+    allocation to be effective.
+
+    Copies of the container share the same state, as asynchronous
+    initiating functions require handlers to be copy constructible.
+    The count of copies is atomic, so a copy may be destroyed on
+    one thread while another thread runs the operation, as happens
+    when a suspended operation is resumed from a different thread.
+    The owned object and the handler are not synchronized; only
+    the thread running the operation may access them.
+
+    @tparam T The type of the owned object.
+
+    @tparam Handler The type of the completion handler.
+*/
+template<class T, class Handler>
+class handler_ptr
+{
+    struct P
+    {
+        Handler handler;
+        std::atomic<std::size_t> n{1};
+        T* t = nullptr;
+        typename std::aligned_storage<
+            sizeof(T), alignof(T)>::type buf;
+
+        template<class DeducedHandler>
+        explicit
+        P(DeducedHandler&& h)
+            : handler(std::forward<DeducedHandler>(h))
+        {
+        }
+    };
+
+    P* p_;
+
+public:
+    /// The type of the owned object.
+    using element_type = T;
+
+    /// The type of the completion handler.
+    using handler_type = Handler;
+
+    /// Copy assignment (disallowed).
+    handler_ptr& operator=(handler_ptr const&) = delete;
+
+    /** Destructor.
+
+        When the last copy is destroyed, the owned object and the
+        handler are destroyed and the memory is freed.
+    */
+    ~handler_ptr();
+
+    /** Move constructor.
+
+        After the move, `other` owns nothing.
+    */
+    handler_ptr(handler_ptr&& other);
+
+    /** Copy constructor.
+
+        The new container shares ownership with `other`.
+    */
+    handler_ptr(handler_ptr const& other);
+
+    /** Construct a new handler_ptr.
+
+        Memory for the handler and the owned object is obtained from
+        the handler's allocation customization. The handler is moved
+        or copied into the container, and then the owned object is
+        constructed as if by `T(handler, std::forward<Args>(args)...)`.
+
+        @param handler The completion handler to store.
+
+        @param args Optional arguments forwarded to the
+        constructor of the owned object.
+    */
+#if GENERATING_DOCS
+    template<class DeducedHandler, class... Args>
+#else
+    template<class DeducedHandler, class... Args,
+        class = typename std::enable_if<! std::is_same<
+            typename std::decay<DeducedHandler>::type,
+                handler_ptr>::value>::type>
+#endif
+    explicit
+    handler_ptr(DeducedHandler&& handler, Args&&... args);
+
+    /// Returns a reference to the stored handler.
+    handler_type&
+    handler() const
+    {
+        return p_->handler;
+    }
+
+    /** Returns a pointer to the owned object.
+
+        If @ref invoke has been called, `nullptr` is returned.
+    */
+    T*
+    get() const
+    {
+        return p_ ? p_->t : nullptr;
+    }
+
+    /// Returns a reference to the owned object.
+    T&
+    operator*() const
+    {
+        return *p_->t;
+    }
+
+    /// Returns a pointer to the owned object.
+    T*
+    operator->() const
+    {
+        return p_->t;
+    }
+
+    /** Invoke the handler in the container.
+
+        The owned object is destroyed and, if this is the last copy,
+        the memory is freed. The handler is then invoked with the
+        forwarded arguments. Afterwards this container owns nothing.
+
+        @param args Arguments forwarded to the handler.
+    */
+    template<class... Args>
+    void
+    invoke(Args&&... args);
+};
+
+} // beast
+
+#include <beast/core/impl/handler_ptr.ipp>
+
+#endif
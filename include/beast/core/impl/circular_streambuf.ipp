@@ -0,0 +1,208 @@
+//
+// Copyright (c) 2013-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BEAST_IMPL_CIRCULAR_STREAMBUF_IPP
+#define BEAST_IMPL_CIRCULAR_STREAMBUF_IPP
+
+#include <beast/core/error.hpp>
+#include <cerrno>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <sys/syscall.h>
+#else
+#include <atomic>
+#include <string>
+#endif
+
+namespace beast {
+
+namespace detail {
+
+// Returns a file descriptor for n bytes of anonymous shared memory
+inline
+int
+ring_memory_fd(std::size_t n, error_code& ec)
+{
+#if defined(__linux__) && defined(SYS_memfd_create)
+    // Called through syscall, since older C
+    // libraries do not declare memfd_create.
+    int const fd = static_cast<int>(::syscall(
+        SYS_memfd_create, "beast.circular_streambuf", 1u)); // MFD_CLOEXEC
+#else
+    static std::atomic<unsigned> seq{0};
+    auto const name = "/beast.circular_streambuf." +
+        std::to_string(::getpid()) + "." + std::to_string(++seq);
+    int const fd = ::shm_open(name.c_str(),
+        O_RDWR | O_CREAT | O_EXCL, 0600);
+    if(fd != -1)
+        ::shm_unlink(name.c_str());
+#endif
+    if(fd == -1)
+    {
+        ec.assign(errno, boost::system::generic_category());
+        return -1;
+    }
+    if(::ftruncate(fd, static_cast<off_t>(n)) != 0)
+    {
+        ec.assign(errno, boost::system::generic_category());
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Maps n bytes of memory twice, back to back
+inline
+void*
+map_ring_memory(std::size_t n, error_code& ec)
+{
+    auto const fd = ring_memory_fd(n, ec);
+    if(fd == -1)
+        return nullptr;
+    // Reserve the address range for both mappings,
+    // then map the memory over each half.
+    auto const p = static_cast<std::uint8_t*>(::mmap(nullptr,
+        2 * n, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+    if(p == MAP_FAILED)
+    {
+        ec.assign(errno, boost::system::generic_category());
+        ::close(fd);
+        return nullptr;
+    }
+    if(::mmap(p, n, PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED ||
+        ::mmap(p + n, n, PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED)
+    {
+        ec.assign(errno, boost::system::generic_category());
+        ::munmap(p, 2 * n);
+        ::close(fd);
+        return nullptr;
+    }
+    // The mappings keep the memory alive
+    ::close(fd);
+    return p;
+}
+
+} // detail
+
+inline
+circular_streambuf::
+~circular_streambuf()
+{
+    release();
+}
+
+inline
+circular_streambuf::
+circular_streambuf(circular_streambuf&& other)
+    : base_(other.base_)
+    , size_(other.size_)
+    , in_(other.in_)
+    , len_(other.len_)
+{
+    other.base_ = nullptr;
+    other.size_ = 0;
+    other.in_ = 0;
+    other.len_ = 0;
+    other.out_ = 0;
+}
+
+inline
+auto
+circular_streambuf::
+operator=(circular_streambuf&& other) ->
+    circular_streambuf&
+{
+    if(this == &other)
+        return *this;
+    release();
+    base_ = other.base_;
+    size_ = other.size_;
+    in_ = other.in_;
+    len_ = other.len_;
+    out_ = 0;
+    other.base_ = nullptr;
+    other.size_ = 0;
+    other.in_ = 0;
+    other.len_ = 0;
+    other.out_ = 0;
+    return *this;
+}
+
+inline
+circular_streambuf::
+circular_streambuf(std::size_t capacity)
+{
+    auto const page = static_cast<std::size_t>(
+        ::sysconf(_SC_PAGESIZE));
+    if(capacity == 0)
+        capacity = 1;
+    size_ = (capacity + page - 1) / page * page;
+    error_code ec;
+    base_ = static_cast<std::uint8_t*>(
+        detail::map_ring_memory(size_, ec));
+    if(ec)
+    {
+        size_ = 0;
+        throw system_error{ec};
+    }
+}
+
+inline
+auto
+circular_streambuf::
+prepare(std::size_t n) ->
+    mutable_buffers_type
+{
+    if(n > size_ - len_)
+        throw std::length_error{
+            "circular_streambuf overflow"};
+    out_ = n;
+    auto pos = in_ + len_;
+    if(pos >= size_)
+        pos -= size_;
+    return mutable_buffers_type{base_ + pos, n};
+}
+
+inline
+void
+circular_streambuf::
+consume(std::size_t n)
+{
+    if(n >= len_ && out_ == 0)
+    {
+        // Start over at the front, which keeps
+        // small messages within the same pages.
+        in_ = 0;
+        len_ = 0;
+        return;
+    }
+    if(n > len_)
+        n = len_;
+    in_ += n;
+    if(in_ >= size_)
+        in_ -= size_;
+    len_ -= n;
+}
+
+inline
+void
+circular_streambuf::
+release()
+{
+    if(base_)
+        ::munmap(base_, 2 * size_);
+    base_ = nullptr;
+}
+
+} // beast
+
+#endif
@@ -10,7 +10,7 @@
 
 #include <beast/core/bind_handler.hpp>
 #include <beast/core/handler_concepts.hpp>
-#include <beast/core/handler_alloc.hpp>
+#include <beast/core/handler_ptr.hpp>
 #include <boost/system/error_code.hpp>
 #include <boost/system/system_error.hpp>
 
@@ -21,28 +21,22 @@ template<class MutableBufferSequence, class Handler>
 class dynabuf_readstream<
     Stream, DynamicBuffer>::read_some_op
 {
-    using alloc_type =
-        handler_alloc<char, Handler>;
-
     struct data
     {
         dynabuf_readstream& srs;
         MutableBufferSequence bs;
-        Handler h;
+        std::size_t size = 0;
         int state = 0;
 
-        template<class DeducedHandler>
-        data(DeducedHandler&& h_,
-            dynabuf_readstream& srs_,
+        data(Handler&, dynabuf_readstream& srs_,
                 MutableBufferSequence const& bs_)
             : srs(srs_)
             , bs(bs_)
-            , h(std::forward<DeducedHandler>(h_))
         {
         }
     };
 
-    std::shared_ptr<data> d_;
+    handler_ptr<data, Handler> d_;
 
 public:
     read_some_op(read_some_op&&) = default;
@@ -51,9 +45,8 @@ public:
     template<class DeducedHandler, class... Args>
     read_some_op(DeducedHandler&& h,
             dynabuf_readstream& srs, Args&&... args)
-        : d_(std::allocate_shared<data>(alloc_type{h},
-            std::forward<DeducedHandler>(h), srs,
-                std::forward<Args>(args)...))
+        : d_(std::forward<DeducedHandler>(h),
+            srs, std::forward<Args>(args)...)
     {
         (*this)(error_code{}, 0);
     }
@@ -67,7 +60,7 @@ public:
         std::size_t size, read_some_op* op)
     {
         return boost_asio_handler_alloc_helpers::
-            allocate(size, op->d_->h);
+            allocate(size, op->d_.handler());
     }
 
     friend
@@ -75,14 +68,14 @@ public:
         void* p, std::size_t size, read_some_op* op)
     {
         return boost_asio_handler_alloc_helpers::
-            deallocate(p, size, op->d_->h);
+            deallocate(p, size, op->d_.handler());
     }
 
     friend
     bool asio_handler_is_continuation(read_some_op* op)
     {
         return boost_asio_handler_cont_helpers::
-            is_continuation(op->d_->h);
+            is_continuation(op->d_.handler());
     }
 
     template <class Function>
@@ -90,7 +83,7 @@ public:
     void asio_handler_invoke(Function&& f, read_some_op* op)
     {
         return boost_asio_handler_invoke_helpers::
-            invoke(f, op->d_->h);
+            invoke(f, op->d_.handler());
     }
 };
 
@@ -109,6 +102,9 @@ read_some_op<MutableBufferSequence, Handler>::operator()(
         case 0:
             if(d.srs.sb_.size() == 0)
             {
+                // The buffer may have been filled
+                // directly, for example by a handshake.
+                d.srs.maybe_release();
                 d.state =
                     d.srs.capacity_ > 0 ? 2 : 1;
                 break;
@@ -126,10 +122,23 @@ read_some_op<MutableBufferSequence, Handler>::operator()(
             return;
 
         case 2:
+            if(d.srs.release_ && can_wait::value)
+            {
+                // wait for data before
+                // acquiring the buffer
+                d.state = 5;
+                d.srs.async_wait_readable(
+                    std::move(*this), can_wait{});
+                return;
+            }
+            // fall through
+
+        case 5:
             // read
             d.state = 3;
+            d.size = d.srs.read_size();
             d.srs.next_layer_.async_read_some(
-                d.srs.sb_.prepare(d.srs.capacity_),
+                d.srs.sb_.prepare(d.size),
                     std::move(*this));
             return;
 
@@ -137,6 +146,7 @@ read_some_op<MutableBufferSequence, Handler>::operator()(
         case 3:
             d.state = 4;
             d.srs.sb_.commit(bytes_transferred);
+            d.srs.adapt(d.size, bytes_transferred);
             break;
 
         // copy
@@ -145,12 +155,13 @@ read_some_op<MutableBufferSequence, Handler>::operator()(
                 boost::asio::buffer_copy(
                     d.bs, d.srs.sb_.data());
             d.srs.sb_.consume(bytes_transferred);
+            d.srs.maybe_release();
             // call handler
             d.state = 99;
             break;
         }
     }
-    d.h(ec, bytes_transferred);
+    d_.invoke(ec, bytes_transferred);
 }
 
 //------------------------------------------------------------------------------
@@ -219,16 +230,27 @@ read_some(MutableBufferSequence const& buffers,
     using boost::asio::buffer_copy;
     if(sb_.size() == 0)
     {
+        maybe_release();
         if(capacity_ == 0)
             return next_layer_.read_some(buffers, ec);
-        sb_.commit(next_layer_.read_some(
-            sb_.prepare(capacity_), ec));
+        if(release_)
+        {
+            wait_readable(ec, can_wait{});
+            if(ec)
+                return 0;
+        }
+        auto const size = read_size();
+        auto const n = next_layer_.read_some(
+            sb_.prepare(size), ec);
+        sb_.commit(n);
         if(ec)
             return 0;
+        adapt(size, n);
     }
     auto bytes_transferred =
         buffer_copy(buffers, sb_.data());
     sb_.consume(bytes_transferred);
+    maybe_release();
     return bytes_transferred;
 }
 
@@ -0,0 +1,280 @@
+//
+// Copyright (c) 2013-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BEAST_IMPL_FLAT_STREAMBUF_IPP
+#define BEAST_IMPL_FLAT_STREAMBUF_IPP
+
+#include <beast/core/detail/write_dynabuf.hpp>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+namespace beast {
+
+/*  Layout:
+
+      begin_      in_         out_        last_        end_
+        |<--------->|<--------->|<--------->|<--------->|
+           unused      input       output      unused
+
+    commit() sets last_ to out_, and consume() moves everything
+    back to begin_ when the input sequence becomes empty.
+*/
+
+template<class Allocator>
+basic_flat_streambuf<Allocator>::
+~basic_flat_streambuf()
+{
+    if(begin_)
+        alloc_traits::deallocate(
+            this->member(), begin_, capacity());
+}
+
+template<class Allocator>
+basic_flat_streambuf<Allocator>::
+basic_flat_streambuf(basic_flat_streambuf&& other)
+    : detail::empty_base_optimization<allocator_type>(
+        std::move(other.member()))
+    , max_(other.max_)
+{
+    move_from(other);
+}
+
+template<class Allocator>
+auto
+basic_flat_streambuf<Allocator>::
+operator=(basic_flat_streambuf&& other) ->
+    basic_flat_streambuf&
+{
+    if(this == &other)
+        return *this;
+    max_ = other.max_;
+    if(alloc_traits::propagate_on_container_move_assignment::value ||
+        this->member() == other.member())
+    {
+        reset();
+        if(alloc_traits::propagate_on_container_move_assignment::value)
+            this->member() = std::move(other.member());
+        move_from(other);
+    }
+    else
+    {
+        in_ = out_ = last_ = begin_;
+        copy_from(other);
+        other.reset();
+    }
+    return *this;
+}
+
+template<class Allocator>
+basic_flat_streambuf<Allocator>::
+basic_flat_streambuf(basic_flat_streambuf const& other)
+    : detail::empty_base_optimization<allocator_type>(
+        alloc_traits::select_on_container_copy_construction(
+            other.member()))
+    , max_(other.max_)
+{
+    copy_from(other);
+}
+
+template<class Allocator>
+auto
+basic_flat_streambuf<Allocator>::
+operator=(basic_flat_streambuf const& other) ->
+    basic_flat_streambuf&
+{
+    if(this == &other)
+        return *this;
+    if(alloc_traits::propagate_on_container_copy_assignment::value &&
+        this->member() != other.member())
+    {
+        reset();
+        this->member() = other.member();
+    }
+    max_ = other.max_;
+    in_ = out_ = last_ = begin_;
+    copy_from(other);
+    return *this;
+}
+
+template<class Allocator>
+basic_flat_streambuf<Allocator>::
+basic_flat_streambuf(std::size_t limit,
+        Allocator const& alloc)
+    : detail::empty_base_optimization<allocator_type>(alloc)
+    , max_(limit)
+{
+    if(limit == 0)
+        throw std::invalid_argument(
+            "basic_flat_streambuf: invalid limit");
+}
+
+template<class Allocator>
+auto
+basic_flat_streambuf<Allocator>::
+prepare(std::size_t n) ->
+    mutable_buffers_type
+{
+    if(n <= static_cast<std::size_t>(end_ - out_))
+    {
+        // existing capacity is sufficient
+        last_ = out_ + n;
+        return mutable_buffers_type{out_, n};
+    }
+    auto const len = size();
+    if(n > max_ - len)
+        throw std::length_error{
+            "basic_flat_streambuf overflow"};
+    if(n <= capacity() - len)
+    {
+        // after compacting,
+        // capacity is sufficient
+        if(len > 0)
+            std::memmove(begin_, in_, len);
+        in_ = begin_;
+        out_ = in_ + len;
+        last_ = out_ + n;
+        return mutable_buffers_type{out_, n};
+    }
+    // grow geometrically
+    auto const cap = capacity();
+    std::size_t const lo = min_size;
+    auto new_size = (std::max<std::size_t>)(len + n,
+        cap < max_ / 2 ? cap * 2 : max_);
+    new_size = (std::min<std::size_t>)(max_,
+        (std::max<std::size_t>)(new_size, lo));
+    auto const p = alloc_traits::allocate(
+        this->member(), new_size);
+    if(len > 0)
+        std::memcpy(p, in_, len);
+    if(begin_)
+        alloc_traits::deallocate(
+            this->member(), begin_, cap);
+    begin_ = p;
+    in_ = begin_;
+    out_ = in_ + len;
+    last_ = out_ + n;
+    end_ = begin_ + new_size;
+    return mutable_buffers_type{out_, n};
+}
+
+template<class Allocator>
+void
+basic_flat_streambuf<Allocator>::
+consume(std::size_t n)
+{
+    if(n >= size())
+    {
+        // Rewind, so the next prepare
+        // does not need to compact.
+        in_ = begin_;
+        out_ = begin_;
+        last_ = begin_;
+        return;
+    }
+    in_ += n;
+}
+
+template<class Allocator>
+void
+basic_flat_streambuf<Allocator>::
+shrink_to_fit()
+{
+    auto const len = size();
+    if(len == capacity())
+        return;
+    std::uint8_t* p = nullptr;
+    if(len > 0)
+    {
+        p = alloc_traits::allocate(this->member(), len);
+        std::memcpy(p, in_, len);
+    }
+    if(begin_)
+        alloc_traits::deallocate(
+            this->member(), begin_, capacity());
+    begin_ = p;
+    in_ = begin_;
+    out_ = begin_ + len;
+    last_ = out_;
+    end_ = out_;
+}
+
+template<class Allocator>
+void
+basic_flat_streambuf<Allocator>::
+reset()
+{
+    if(begin_)
+        alloc_traits::deallocate(
+            this->member(), begin_, capacity());
+    begin_ = nullptr;
+    in_ = nullptr;
+    out_ = nullptr;
+    last_ = nullptr;
+    end_ = nullptr;
+}
+
+// Requires an empty input sequence
+template<class Allocator>
+void
+basic_flat_streambuf<Allocator>::
+copy_from(basic_flat_streambuf const& other)
+{
+    auto const n = other.size();
+    if(n == 0)
+        return;
+    std::memcpy(boost::asio::buffer_cast<void*>(
+        prepare(n)), other.in_, n);
+    commit(n);
+}
+
+// Requires no storage
+template<class Allocator>
+void
+basic_flat_streambuf<Allocator>::
+move_from(basic_flat_streambuf& other)
+{
+    begin_ = other.begin_;
+    in_ = other.in_;
+    out_ = other.out_;
+    last_ = out_;
+    end_ = other.end_;
+    other.begin_ = nullptr;
+    other.in_ = nullptr;
+    other.out_ = nullptr;
+    other.last_ = nullptr;
+    other.end_ = nullptr;
+}
+
+template<class Allocator>
+std::size_t
+read_size_helper(basic_flat_streambuf<
+    Allocator> const& streambuf, std::size_t max_size)
+{
+    auto const size = streambuf.size();
+    auto const limit = streambuf.max_size() - size;
+    if(limit == 0)
+        return 0;
+    auto const avail = streambuf.capacity() - size;
+    if(avail > 0)
+        return (std::min)(max_size, (std::min)(limit, avail));
+    return (std::min)(max_size, (std::min)(limit,
+        (std::max<std::size_t>)(512, size)));
+}
+
+template<class Allocator, class T>
+basic_flat_streambuf<Allocator>&
+operator<<(basic_flat_streambuf<Allocator>& streambuf, T const& t)
+{
+    detail::write_dynabuf(streambuf, t);
+    return streambuf;
+}
+
+} // beast
+
+#endif
@@ -0,0 +1,113 @@
+//
+// Copyright (c) 2013-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BEAST_IMPL_HANDLER_PTR_IPP
+#define BEAST_IMPL_HANDLER_PTR_IPP
+
+#include <boost/asio/detail/handler_alloc_helpers.hpp>
+#include <cassert>
+#include <new>
+
+namespace beast {
+
+template<class T, class Handler>
+handler_ptr<T, Handler>::
+~handler_ptr()
+{
+    if(! p_ || p_->n.fetch_sub(1,
+            std::memory_order_acq_rel) > 1)
+        return;
+    if(p_->t)
+        p_->t->~T();
+    // The handler is needed to free the memory,
+    // so it is moved out of the block first.
+    Handler h(std::move(p_->handler));
+    p_->~P();
+    boost_asio_handler_alloc_helpers::
+        deallocate(p_, sizeof(P), h);
+}
+
+template<class T, class Handler>
+handler_ptr<T, Handler>::
+handler_ptr(handler_ptr&& other)
+    : p_(other.p_)
+{
+    other.p_ = nullptr;
+}
+
+template<class T, class Handler>
+handler_ptr<T, Handler>::
+handler_ptr(handler_ptr const& other)
+    : p_(other.p_)
+{
+    if(p_)
+        p_->n.fetch_add(1, std::memory_order_relaxed);
+}
+
+template<class T, class Handler>
+template<class DeducedHandler, class... Args, class>
+handler_ptr<T, Handler>::
+handler_ptr(DeducedHandler&& handler, Args&&... args)
+{
+    p_ = static_cast<P*>(boost_asio_handler_alloc_helpers::
+        allocate(sizeof(P), handler));
+    ::new(p_) P(std::forward<DeducedHandler>(handler));
+    try
+    {
+        p_->t = ::new(&p_->buf) T(p_->handler,
+            std::forward<Args>(args)...);
+    }
+    catch(...)
+    {
+        Handler h(std::move(p_->handler));
+        p_->~P();
+        boost_asio_handler_alloc_helpers::
+            deallocate(p_, sizeof(P), h);
+        throw;
+    }
+}
+
+template<class T, class Handler>
+template<class... Args>
+void
+handler_ptr<T, Handler>::
+invoke(Args&&... args)
+{
+    assert(p_ && p_->t);
+    auto const p = p_;
+    p_ = nullptr;
+    p->t->~T();
+    p->t = nullptr;
+    if(p->n.load(std::memory_order_acquire) > 1)
+    {
+        // Other copies may be destroyed on another thread,
+        // so the handler is copied before our reference is
+        // released. Whichever copy goes last frees the memory.
+        Handler h(p->handler);
+        if(p->n.fetch_sub(1, std::memory_order_acq_rel) > 1)
+        {
+            h(std::forward<Args>(args)...);
+            return;
+        }
+        p->~P();
+        boost_asio_handler_alloc_helpers::
+            deallocate(p, sizeof(P), h);
+        h(std::forward<Args>(args)...);
+        return;
+    }
+    // This is the only copy, so no other thread
+    // can change the count while we hold it.
+    Handler h(std::move(p->handler));
+    p->~P();
+    boost_asio_handler_alloc_helpers::
+        deallocate(p, sizeof(P), h);
+    h(std::forward<Args>(args)...);
+}
+
+} // beast
+
+#endif
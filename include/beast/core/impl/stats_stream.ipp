@@ -0,0 +1,216 @@
+//
+// Copyright (c) 2013-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BEAST_IMPL_STATS_STREAM_IPP
+#define BEAST_IMPL_STATS_STREAM_IPP
+
+#include <beast/core/handler_concepts.hpp>
+#include <boost/asio/detail/handler_alloc_helpers.hpp>
+#include <boost/asio/detail/handler_cont_helpers.hpp>
+#include <boost/asio/detail/handler_invoke_helpers.hpp>
+#include <boost/system/system_error.hpp>
+
+namespace beast {
+
+// Counts the bytes transferred before invoking the handler
+template<class NextLayer>
+template<class Handler, bool isRead>
+class stats_stream<NextLayer>::io_op
+{
+    Handler h_;
+    detail::default_stats_recorder& rec_;
+
+public:
+    io_op(io_op&&) = default;
+    io_op(io_op const&) = default;
+
+    template<class DeducedHandler>
+    io_op(DeducedHandler&& h,
+            detail::default_stats_recorder& rec)
+        : h_(std::forward<DeducedHandler>(h))
+        , rec_(rec)
+    {
+    }
+
+    void
+    operator()(error_code const& ec,
+        std::size_t bytes_transferred)
+    {
+        if(isRead)
+            rec_.on_read(bytes_transferred);
+        else
+            rec_.on_write(bytes_transferred);
+        h_(ec, bytes_transferred);
+    }
+
+    friend
+    void* asio_handler_allocate(
+        std::size_t size, io_op* op)
+    {
+        return boost_asio_handler_alloc_helpers::
+            allocate(size, op->h_);
+    }
+
+    friend
+    void asio_handler_deallocate(
+        void* p, std::size_t size, io_op* op)
+    {
+        return boost_asio_handler_alloc_helpers::
+            deallocate(p, size, op->h_);
+    }
+
+    friend
+    bool asio_handler_is_continuation(io_op* op)
+    {
+        return boost_asio_handler_cont_helpers::
+            is_continuation(op->h_);
+    }
+
+    template<class Function>
+    friend
+    void asio_handler_invoke(Function&& f, io_op* op)
+    {
+        return boost_asio_handler_invoke_helpers::
+            invoke(f, op->h_);
+    }
+};
+
+//------------------------------------------------------------------------------
+
+template<class NextLayer>
+template<class MutableBufferSequence>
+std::size_t
+stats_stream<NextLayer>::
+read_some(MutableBufferSequence const& buffers)
+{
+    static_assert(is_SyncReadStream<next_layer_type>::value,
+        "SyncReadStream requirements not met");
+    static_assert(is_MutableBufferSequence<
+        MutableBufferSequence>::value,
+            "MutableBufferSequence requirements not met");
+    error_code ec;
+    auto n = read_some(buffers, ec);
+    if(ec)
+        throw system_error{ec};
+    return n;
+}
+
+template<class NextLayer>
+template<class MutableBufferSequence>
+std::size_t
+stats_stream<NextLayer>::
+read_some(MutableBufferSequence const& buffers,
+    error_code& ec)
+{
+    static_assert(is_SyncReadStream<next_layer_type>::value,
+        "SyncReadStream requirements not met");
+    static_assert(is_MutableBufferSequence<
+        MutableBufferSequence>::value,
+            "MutableBufferSequence requirements not met");
+    auto const n = next_layer_.read_some(buffers, ec);
+    rec_.on_read(n);
+    return n;
+}
+
+template<class NextLayer>
+template<class MutableBufferSequence, class ReadHandler>
+auto
+stats_stream<NextLayer>::
+async_read_some(MutableBufferSequence const& buffers,
+    ReadHandler&& handler) ->
+        typename async_completion<ReadHandler,
+            void(error_code, std::size_t)>::result_type
+{
+    static_assert(is_AsyncReadStream<next_layer_type>::value,
+        "AsyncReadStream requirements not met");
+    static_assert(is_MutableBufferSequence<
+        MutableBufferSequence>::value,
+            "MutableBufferSequence requirements not met");
+    static_assert(is_CompletionHandler<ReadHandler,
+        void(error_code, std::size_t)>::value,
+            "ReadHandler requirements not met");
+#if BEAST_STREAM_STATS
+    beast::async_completion<ReadHandler,
+        void(error_code, std::size_t)> completion(handler);
+    next_layer_.async_read_some(buffers, io_op<
+        decltype(completion.handler), true>{
+            completion.handler, rec_});
+    return completion.result.get();
+#else
+    return next_layer_.async_read_some(buffers,
+        std::forward<ReadHandler>(handler));
+#endif
+}
+
+template<class NextLayer>
+template<class ConstBufferSequence>
+std::size_t
+stats_stream<NextLayer>::
+write_some(ConstBufferSequence const& buffers)
+{
+    static_assert(is_SyncWriteStream<next_layer_type>::value,
+        "SyncWriteStream requirements not met");
+    static_assert(is_ConstBufferSequence<
+        ConstBufferSequence>::value,
+            "ConstBufferSequence requirements not met");
+    error_code ec;
+    auto n = write_some(buffers, ec);
+    if(ec)
+        throw system_error{ec};
+    return n;
+}
+
+template<class NextLayer>
+template<class ConstBufferSequence>
+std::size_t
+stats_stream<NextLayer>::
+write_some(ConstBufferSequence const& buffers,
+    error_code& ec)
+{
+    static_assert(is_SyncWriteStream<next_layer_type>::value,
+        "SyncWriteStream requirements not met");
+    static_assert(is_ConstBufferSequence<
+        ConstBufferSequence>::value,
+            "ConstBufferSequence requirements not met");
+    auto const n = next_layer_.write_some(buffers, ec);
+    rec_.on_write(n);
+    return n;
+}
+
+template<class NextLayer>
+template<class ConstBufferSequence, class WriteHandler>
+auto
+stats_stream<NextLayer>::
+async_write_some(ConstBufferSequence const& buffers,
+    WriteHandler&& handler) ->
+        typename async_completion<WriteHandler,
+            void(error_code, std::size_t)>::result_type
+{
+    static_assert(is_AsyncWriteStream<next_layer_type>::value,
+        "AsyncWriteStream requirements not met");
+    static_assert(is_ConstBufferSequence<
+        ConstBufferSequence>::value,
+            "ConstBufferSequence requirements not met");
+    static_assert(is_CompletionHandler<WriteHandler,
+        void(error_code, std::size_t)>::value,
+            "WriteHandler requirements not met");
+#if BEAST_STREAM_STATS
+    beast::async_completion<WriteHandler,
+        void(error_code, std::size_t)> completion(handler);
+    next_layer_.async_write_some(buffers, io_op<
+        decltype(completion.handler), false>{
+            completion.handler, rec_});
+    return completion.result.get();
+#else
+    return next_layer_.async_write_some(buffers,
+        std::forward<WriteHandler>(handler));
+#endif
+}
+
+} // beast
+
+#endif
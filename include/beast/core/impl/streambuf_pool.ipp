@@ -0,0 +1,206 @@
+//
+// Copyright (c) 2013-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BEAST_IMPL_STREAMBUF_POOL_IPP
+#define BEAST_IMPL_STREAMBUF_POOL_IPP
+
+#include <beast/core/detail/thread_local_instance.hpp>
+#include <new>
+
+namespace beast {
+
+class streambuf_pool::impl
+{
+    struct block
+    {
+        block* next;
+    };
+
+    // Blocks of one size. A list which
+    // becomes empty may be reused for
+    // another size.
+    struct list
+    {
+        std::size_t size = 0;
+        std::size_t count = 0;
+        block* head = nullptr;
+    };
+
+    static std::size_t constexpr max_lists = 8;
+
+    list lists_[max_lists];
+    std::size_t max_bytes_ = default_max_bytes;
+    stats stats_;
+
+public:
+    impl() = default;
+    impl(impl const&) = delete;
+    impl& operator=(impl const&) = delete;
+
+    ~impl()
+    {
+        shrink_to(0);
+    }
+
+    stats const&
+    get_stats() const
+    {
+        return stats_;
+    }
+
+    std::size_t
+    max_bytes() const
+    {
+        return max_bytes_;
+    }
+
+    void
+    max_bytes(std::size_t n)
+    {
+        max_bytes_ = n;
+        shrink_to(n);
+    }
+
+    void
+    shrink_to(std::size_t n)
+    {
+        for(auto& l : lists_)
+        {
+            while(stats_.bytes_held > n && l.head)
+            {
+                auto const b = l.head;
+                l.head = b->next;
+                --l.count;
+                --stats_.blocks_held;
+                stats_.bytes_held -= l.size;
+                ::operator delete(b);
+            }
+        }
+    }
+
+    void*
+    allocate(std::size_t n)
+    {
+        for(auto& l : lists_)
+        {
+            if(l.size == n && l.head)
+            {
+                auto const b = l.head;
+                l.head = b->next;
+                --l.count;
+                --stats_.blocks_held;
+                stats_.bytes_held -= n;
+                ++stats_.hits;
+                return b;
+            }
+        }
+        ++stats_.misses;
+        return ::operator new(n);
+    }
+
+    void
+    deallocate(void* p, std::size_t n)
+    {
+        if(stats_.bytes_held + n <= max_bytes_)
+        {
+            list* dest = nullptr;
+            for(auto& l : lists_)
+            {
+                if(l.size == n)
+                {
+                    dest = &l;
+                    break;
+                }
+                if(! dest && l.count == 0)
+                    dest = &l;
+            }
+            if(dest)
+            {
+                auto const b = static_cast<block*>(p);
+                dest->size = n;
+                b->next = dest->head;
+                dest->head = b;
+                ++dest->count;
+                ++stats_.blocks_held;
+                stats_.bytes_held += n;
+                return;
+            }
+        }
+        ::operator delete(p);
+    }
+};
+
+inline
+auto
+streambuf_pool::get() ->
+    impl*
+{
+    return detail::thread_local_instance<impl>::get();
+}
+
+inline
+auto
+streambuf_pool::get_stats() ->
+    stats
+{
+    auto const p = get();
+    if(! p)
+        return {};
+    return p->get_stats();
+}
+
+inline
+std::size_t
+streambuf_pool::max_bytes()
+{
+    auto const p = get();
+    if(! p)
+        return 0;
+    return p->max_bytes();
+}
+
+inline
+void
+streambuf_pool::max_bytes(std::size_t n)
+{
+    auto const p = get();
+    if(p)
+        p->max_bytes(n);
+}
+
+inline
+void
+streambuf_pool::shrink()
+{
+    auto const p = get();
+    if(p)
+        p->shrink_to(0);
+}
+
+inline
+void*
+streambuf_pool::allocate(std::size_t n)
+{
+    auto const p = get();
+    if(! p || n < sizeof(void*))
+        return ::operator new(n);
+    return p->allocate(n);
+}
+
+inline
+void
+streambuf_pool::deallocate(void* ptr, std::size_t n)
+{
+    auto const p = get();
+    if(! p || n < sizeof(void*))
+        return ::operator delete(ptr);
+    p->deallocate(ptr, n);
+}
+
+} // beast
+
+#endif
@@ -0,0 +1,293 @@
+//
+// Copyright (c) 2013-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BEAST_IMPL_TIMEOUT_STREAM_IPP
+#define BEAST_IMPL_TIMEOUT_STREAM_IPP
+
+#include <beast/core/bind_handler.hpp>
+#include <beast/core/handler_concepts.hpp>
+#include <boost/asio/error.hpp>
+#include <boost/asio/detail/handler_alloc_helpers.hpp>
+#include <boost/asio/detail/handler_cont_helpers.hpp>
+#include <boost/asio/detail/handler_invoke_helpers.hpp>
+#include <boost/system/system_error.hpp>
+
+namespace beast {
+
+// Rearms the idle timer on completion, and reports
+// an operation cancelled by a timeout as timed out.
+template<class NextLayer>
+template<class Handler>
+class timeout_stream<NextLayer>::io_op
+{
+    Handler h_;
+    timeout_stream& s_;
+
+public:
+    io_op(io_op&&) = default;
+    io_op(io_op const&) = default;
+
+    template<class DeducedHandler>
+    io_op(DeducedHandler&& h, timeout_stream& s)
+        : h_(std::forward<DeducedHandler>(h))
+        , s_(s)
+    {
+    }
+
+    void
+    operator()(error_code ec,
+        std::size_t bytes_transferred)
+    {
+        if(s_.expired())
+        {
+            if(ec == boost::asio::error::operation_aborted)
+                ec = boost::asio::error::timed_out;
+        }
+        else
+        {
+            s_.on_activity();
+        }
+        h_(ec, bytes_transferred);
+    }
+
+    friend
+    void* asio_handler_allocate(
+        std::size_t size, io_op* op)
+    {
+        return boost_asio_handler_alloc_helpers::
+            allocate(size, op->h_);
+    }
+
+    friend
+    void asio_handler_deallocate(
+        void* p, std::size_t size, io_op* op)
+    {
+        return boost_asio_handler_alloc_helpers::
+            deallocate(p, size, op->h_);
+    }
+
+    friend
+    bool asio_handler_is_continuation(io_op* op)
+    {
+        return boost_asio_handler_cont_helpers::
+            is_continuation(op->h_);
+    }
+
+    template<class Function>
+    friend
+    void asio_handler_invoke(Function&& f, io_op* op)
+    {
+        return boost_asio_handler_invoke_helpers::
+            invoke(f, op->h_);
+    }
+};
+
+//------------------------------------------------------------------------------
+
+template<class NextLayer>
+timeout_stream<NextLayer>::
+timeout_stream(timeout_stream&& other)
+    : next_layer_(std::move(other.next_layer_))
+    , idle_(std::move(other.idle_), *this)
+    , deadline_(std::move(other.deadline_), *this)
+    , idle_timeout_(other.idle_timeout_)
+    , expired_(other.expired())
+{
+}
+
+template<class NextLayer>
+template<class... Args>
+timeout_stream<NextLayer>::
+timeout_stream(timer_wheel& wheel, Args&&... args)
+    : next_layer_(std::forward<Args>(args)...)
+    , idle_(wheel, *this)
+    , deadline_(wheel, *this)
+    , expired_(false)
+{
+}
+
+template<class NextLayer>
+void
+timeout_stream<NextLayer>::
+idle_timeout(duration d)
+{
+    idle_timeout_ = d;
+    if(d > duration::zero())
+        idle_.expires_after(d);
+    else
+        idle_.cancel();
+}
+
+template<class NextLayer>
+void
+timeout_stream<NextLayer>::
+on_activity()
+{
+    if(idle_timeout_ > duration::zero())
+        idle_.expires_after(idle_timeout_);
+}
+
+template<class NextLayer>
+void
+timeout_stream<NextLayer>::
+on_expire()
+{
+    if(expired_.exchange(true, std::memory_order_acq_rel))
+        return;
+    idle_.cancel();
+    deadline_.cancel();
+    error_code ec;
+    lowest_layer().cancel(ec);
+}
+
+template<class NextLayer>
+template<class MutableBufferSequence>
+std::size_t
+timeout_stream<NextLayer>::
+read_some(MutableBufferSequence const& buffers)
+{
+    static_assert(is_SyncReadStream<next_layer_type>::value,
+        "SyncReadStream requirements not met");
+    static_assert(is_MutableBufferSequence<
+        MutableBufferSequence>::value,
+            "MutableBufferSequence requirements not met");
+    error_code ec;
+    auto n = read_some(buffers, ec);
+    if(ec)
+        throw system_error{ec};
+    return n;
+}
+
+template<class NextLayer>
+template<class MutableBufferSequence>
+std::size_t
+timeout_stream<NextLayer>::
+read_some(MutableBufferSequence const& buffers,
+    error_code& ec)
+{
+    static_assert(is_SyncReadStream<next_layer_type>::value,
+        "SyncReadStream requirements not met");
+    static_assert(is_MutableBufferSequence<
+        MutableBufferSequence>::value,
+            "MutableBufferSequence requirements not met");
+    if(expired())
+    {
+        ec = boost::asio::error::timed_out;
+        return 0;
+    }
+    auto const n = next_layer_.read_some(buffers, ec);
+    on_activity();
+    return n;
+}
+
+template<class NextLayer>
+template<class MutableBufferSequence, class ReadHandler>
+auto
+timeout_stream<NextLayer>::
+async_read_some(MutableBufferSequence const& buffers,
+    ReadHandler&& handler) ->
+        typename async_completion<ReadHandler,
+            void(error_code, std::size_t)>::result_type
+{
+    static_assert(is_AsyncReadStream<next_layer_type>::value,
+        "AsyncReadStream requirements not met");
+    static_assert(is_MutableBufferSequence<
+        MutableBufferSequence>::value,
+            "MutableBufferSequence requirements not met");
+    static_assert(is_CompletionHandler<ReadHandler,
+        void(error_code, std::size_t)>::value,
+            "ReadHandler requirements not met");
+    beast::async_completion<ReadHandler,
+        void(error_code, std::size_t)> completion(handler);
+    if(expired())
+    {
+        get_io_service().post(bind_handler(completion.handler,
+            error_code{boost::asio::error::timed_out}, 0));
+        return completion.result.get();
+    }
+    on_activity();
+    next_layer_.async_read_some(buffers, io_op<
+        decltype(completion.handler)>{
+            completion.handler, *this});
+    return completion.result.get();
+}
+
+template<class NextLayer>
+template<class ConstBufferSequence>
+std::size_t
+timeout_stream<NextLayer>::
+write_some(ConstBufferSequence const& buffers)
+{
+    static_assert(is_SyncWriteStream<next_layer_type>::value,
+        "SyncWriteStream requirements not met");
+    static_assert(is_ConstBufferSequence<
+        ConstBufferSequence>::value,
+            "ConstBufferSequence requirements not met");
+    error_code ec;
+    auto n = write_some(buffers, ec);
+    if(ec)
+        throw system_error{ec};
+    return n;
+}
+
+template<class NextLayer>
+template<class ConstBufferSequence>
+std::size_t
+timeout_stream<NextLayer>::
+write_some(ConstBufferSequence const& buffers,
+    error_code& ec)
+{
+    static_assert(is_SyncWriteStream<next_layer_type>::value,
+        "SyncWriteStream requirements not met");
+    static_assert(is_ConstBufferSequence<
+        ConstBufferSequence>::value,
+            "ConstBufferSequence requirements not met");
+    if(expired())
+    {
+        ec = boost::asio::error::timed_out;
+        return 0;
+    }
+    auto const n = next_layer_.write_some(buffers, ec);
+    on_activity();
+    return n;
+}
+
+template<class NextLayer>
+template<class ConstBufferSequence, class WriteHandler>
+auto
+timeout_stream<NextLayer>::
+async_write_some(ConstBufferSequence const& buffers,
+    WriteHandler&& handler) ->
+        typename async_completion<WriteHandler,
+            void(error_code, std::size_t)>::result_type
+{
+    static_assert(is_AsyncWriteStream<next_layer_type>::value,
+        "AsyncWriteStream requirements not met");
+    static_assert(is_ConstBufferSequence<
+        ConstBufferSequence>::value,
+            "ConstBufferSequence requirements not met");
+    static_assert(is_CompletionHandler<WriteHandler,
+        void(error_code, std::size_t)>::value,
+            "WriteHandler requirements not met");
+    beast::async_completion<WriteHandler,
+        void(error_code, std::size_t)> completion(handler);
+    if(expired())
+    {
+        get_io_service().post(bind_handler(completion.handler,
+            error_code{boost::asio::error::timed_out}, 0));
+        return completion.result.get();
+    }
+    on_activity();
+    next_layer_.async_write_some(buffers, io_op<
+        decltype(completion.handler)>{
+            completion.handler, *this});
+    return completion.result.get();
+}
+
+} // beast
+
+#endif
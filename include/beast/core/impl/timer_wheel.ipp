@@ -0,0 +1,231 @@
+//
+// Copyright (c) 2013-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BEAST_IMPL_TIMER_WHEEL_IPP
+#define BEAST_IMPL_TIMER_WHEEL_IPP
+
+#include <boost/asio/error.hpp>
+#include <boost/assert.hpp>
+
+namespace beast {
+
+inline
+timer_wheel::timer::
+timer(timer&& other)
+    : w_(other.w_)
+{
+    w_->replace(other, *this);
+}
+
+inline
+timer_wheel::timer::
+~timer()
+{
+    w_->cancel(*this);
+}
+
+//------------------------------------------------------------------------------
+
+inline
+timer_wheel::
+timer_wheel(boost::asio::io_service& ios,
+        clock_type::duration resolution)
+    : t_(ios)
+    , res_(resolution)
+    , origin_(clock_type::now())
+{
+    BOOST_ASSERT(res_ > clock_type::duration::zero());
+}
+
+inline
+timer_wheel::
+~timer_wheel()
+{
+    BOOST_ASSERT(count_ == 0);
+    error_code ec;
+    t_.cancel(ec);
+}
+
+inline
+std::size_t
+timer_wheel::
+size()
+{
+    std::lock_guard<std::mutex> lock(m_);
+    return count_;
+}
+
+// Returns the number of whole ticks since the origin
+inline
+std::uint64_t
+timer_wheel::
+elapsed() const
+{
+    return static_cast<std::uint64_t>(
+        (clock_type::now() - origin_) / res_);
+}
+
+// Link an armed timer into the slot for its
+// expiration tick, relative to the current tick.
+inline
+void
+timer_wheel::
+insert(timer& t)
+{
+    auto const delta = t.when_ > now_ ? t.when_ - now_ : 0;
+    std::size_t level = 0;
+    while(level < levels - 1 &&
+            delta >= (std::uint64_t{1} << (bits * (level + 1))))
+        ++level;
+    auto const i = static_cast<std::size_t>(
+        (t.when_ >> (bits * level)) & (slots - 1));
+    wheel_[level][i].push_back(t);
+}
+
+inline
+void
+timer_wheel::
+arm(timer& t, clock_type::duration d)
+{
+    std::lock_guard<std::mutex> lock(m_);
+    if(count_ == 0 && ! running_)
+    {
+        // The wheel is empty, so catching up
+        // to the present skips no timers.
+        now_ = elapsed();
+    }
+    // Round up, and expire no sooner than the next tick
+    std::uint64_t n = d <= clock_type::duration::zero() ? 0 :
+        static_cast<std::uint64_t>((d + res_ -
+            clock_type::duration{1}) / res_);
+    auto const limit = (std::uint64_t{1} << (bits * levels)) - 1;
+    if(n > limit)
+        n = limit;
+    if(n == 0)
+        n = 1;
+    if(t.armed_)
+        t.unlink();
+    else
+        ++count_;
+    t.when_ = now_ + n;
+    t.armed_ = true;
+    insert(t);
+    if(! running_)
+        start();
+}
+
+inline
+void
+timer_wheel::
+cancel(timer& t)
+{
+    std::lock_guard<std::mutex> lock(m_);
+    if(! t.armed_)
+        return;
+    t.unlink();
+    t.armed_ = false;
+    --count_;
+}
+
+inline
+void
+timer_wheel::
+replace(timer& from, timer& to)
+{
+    std::lock_guard<std::mutex> lock(m_);
+    if(! from.armed_)
+        return;
+    to.when_ = from.when_;
+    to.armed_ = true;
+    to.prev = from.prev;
+    to.next = from.next;
+    to.prev->next = &to;
+    to.next->prev = &to;
+    from.prev = &from;
+    from.next = &from;
+    from.armed_ = false;
+}
+
+// Called with the lock held
+inline
+void
+timer_wheel::
+start()
+{
+    running_ = true;
+    t_.expires_at(origin_ + res_ * (now_ + 1));
+    t_.async_wait(
+        [this](error_code const& ec)
+        {
+            on_tick(ec);
+        });
+}
+
+inline
+void
+timer_wheel::
+on_tick(error_code const& ec)
+{
+    if(ec == boost::asio::error::operation_aborted)
+        return;
+    {
+        std::lock_guard<std::mutex> lock(m_);
+        running_ = false;
+        auto const target = elapsed();
+        while(now_ < target)
+        {
+            ++now_;
+            // Move timers down from the higher levels
+            // whenever the level below wraps around.
+            for(std::size_t level = 1; level < levels; ++level)
+            {
+                if(((now_ >> (bits * (level - 1))) &
+                        (slots - 1)) != 0)
+                    break;
+                auto& slot = wheel_[level][static_cast<std::size_t>(
+                    (now_ >> (bits * level)) & (slots - 1))];
+                while(! slot.empty())
+                {
+                    auto& t = static_cast<timer&>(*slot.next);
+                    t.unlink();
+                    insert(t);
+                }
+            }
+            auto& slot = wheel_[0][static_cast<std::size_t>(
+                now_ & (slots - 1))];
+            while(! slot.empty())
+            {
+                auto& t = static_cast<timer&>(*slot.next);
+                t.unlink();
+                expired_.push_back(t);
+            }
+        }
+        if(count_ > 0)
+            start();
+    }
+    // Call each expired timer without holding the lock,
+    // so that it may arm or cancel timers. A timer
+    // cancelled meanwhile is removed from the list.
+    for(;;)
+    {
+        timer* t;
+        {
+            std::lock_guard<std::mutex> lock(m_);
+            if(expired_.empty())
+                break;
+            t = static_cast<timer*>(expired_.next);
+            t->unlink();
+            t->armed_ = false;
+            --count_;
+        }
+        t->on_expire();
+    }
+}
+
+} // beast
+
+#endif
@@ -0,0 +1,175 @@
+//
+// Copyright (c) 2013-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BEAST_IMPL_TRACE_IPP
+#define BEAST_IMPL_TRACE_IPP
+
+#include <algorithm>
+#include <utility>
+
+namespace beast {
+
+// Holds the buffer of each live thread
+class trace_buffer::registry
+{
+    std::mutex m_;
+    std::vector<std::shared_ptr<trace_buffer>> v_;
+    std::size_t next_ = 0;
+
+public:
+    static
+    registry&
+    get()
+    {
+        static registry r;
+        return r;
+    }
+
+    std::shared_ptr<trace_buffer>
+    insert()
+    {
+        std::lock_guard<std::mutex> lock(m_);
+        auto p = std::make_shared<trace_buffer>(++next_);
+        v_.push_back(p);
+        return p;
+    }
+
+    void
+    erase(trace_buffer const* p)
+    {
+        std::lock_guard<std::mutex> lock(m_);
+        v_.erase(std::remove_if(v_.begin(), v_.end(),
+            [p](std::shared_ptr<trace_buffer> const& sp)
+            {
+                return sp.get() == p;
+            }), v_.end());
+    }
+
+    std::vector<std::shared_ptr<trace_buffer>>
+    list()
+    {
+        std::lock_guard<std::mutex> lock(m_);
+        return v_;
+    }
+};
+
+inline
+trace_buffer::
+trace_buffer(std::size_t id)
+    : v_(new slot[BEAST_TRACE_SIZE])
+    , head_(0)
+    , begin_(0)
+    , id_(id)
+{
+}
+
+inline
+void
+trace_buffer::
+record(void const* op, char const* name,
+    trace_kind kind, int value)
+{
+    using namespace std::chrono;
+    auto const n = head_.load(std::memory_order_relaxed);
+    // Announce the slot before overwriting it
+    begin_.store(n + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    auto& s = v_[n & (BEAST_TRACE_SIZE - 1)];
+    s.time.store(static_cast<std::uint64_t>(
+        duration_cast<nanoseconds>(steady_clock::now().
+            time_since_epoch()).count()), std::memory_order_relaxed);
+    s.op.store(op, std::memory_order_relaxed);
+    s.name.store(name, std::memory_order_relaxed);
+    s.kind.store(static_cast<int>(kind), std::memory_order_relaxed);
+    s.value.store(value, std::memory_order_relaxed);
+    head_.store(n + 1, std::memory_order_release);
+}
+
+inline
+std::vector<trace_event>
+trace_buffer::
+events() const
+{
+    auto const n1 = head_.load(std::memory_order_acquire);
+    auto const first = n1 > BEAST_TRACE_SIZE ?
+        n1 - BEAST_TRACE_SIZE : 0;
+    std::vector<trace_event> v;
+    v.reserve(static_cast<std::size_t>(n1 - first));
+    for(auto i = first; i < n1; ++i)
+    {
+        auto const& s = v_[i & (BEAST_TRACE_SIZE - 1)];
+        v.push_back(trace_event{
+            s.time.load(std::memory_order_relaxed),
+            s.op.load(std::memory_order_relaxed),
+            s.name.load(std::memory_order_relaxed),
+            static_cast<trace_kind>(
+                s.kind.load(std::memory_order_relaxed)),
+            s.value.load(std::memory_order_relaxed)});
+    }
+    // Drop the events which the owning thread
+    // started to overwrite while we copied.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    auto const n2 = begin_.load(std::memory_order_relaxed);
+    if(n2 > first + BEAST_TRACE_SIZE)
+        v.erase(v.begin(), v.begin() + static_cast<std::size_t>(
+            (std::min)(n2 - BEAST_TRACE_SIZE - first,
+                static_cast<std::uint64_t>(v.size()))));
+    return v;
+}
+
+inline
+trace_buffer&
+trace_buffer::
+local()
+{
+    struct holder
+    {
+        std::shared_ptr<trace_buffer> p =
+            registry::get().insert();
+
+        ~holder()
+        {
+            registry::get().erase(p.get());
+        }
+    };
+    static thread_local holder h;
+    return *h.p;
+}
+
+template<class Function>
+void
+trace_buffer::
+for_each(Function&& f)
+{
+    for(auto const& p : registry::get().list())
+        f(*p);
+}
+
+inline
+void
+trace_dump(std::ostream& os)
+{
+    static char const* const kinds[] = {
+        "begin", "step", "wait", "end" };
+    trace_buffer::for_each(
+        [&](trace_buffer const& b)
+        {
+            os << "thread " << b.id() << "\n";
+            for(auto const& e : b.events())
+                os <<
+                    e.time << " " <<
+                    e.op << " " <<
+                    e.name << " " <<
+                    kinds[static_cast<int>(e.kind)] << " " <<
+                    e.value << "\n";
+        });
+    os.flush();
+}
+
+} // beast
+
+#endif
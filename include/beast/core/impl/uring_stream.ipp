@@ -0,0 +1,859 @@
+//
+// Copyright (c) 2013-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BEAST_IMPL_URING_STREAM_IPP
+#define BEAST_IMPL_URING_STREAM_IPP
+
+#include <beast/core/bind_handler.hpp>
+#include <beast/core/buffer_concepts.hpp>
+#include <beast/core/handler_concepts.hpp>
+#include <beast/core/stream_concepts.hpp>
+#include <boost/asio/detail/handler_alloc_helpers.hpp>
+#include <boost/asio/detail/handler_invoke_helpers.hpp>
+#include <boost/asio/error.hpp>
+#include <cassert>
+#include <new>
+#include <stdexcept>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+
+namespace beast {
+
+// Provided buffers for multishot receive
+class uring_service::buf_ring
+{
+    io_uring_buf_ring* ring_;
+    std::size_t ring_len_;
+    std::unique_ptr<char[]> data_;
+    std::size_t size_;
+    unsigned mask_;
+    unsigned short tail_ = 0;
+
+public:
+    buf_ring(buf_ring const&) = delete;
+    buf_ring& operator=(buf_ring const&) = delete;
+
+    ~buf_ring()
+    {
+        ::munmap(ring_, ring_len_);
+    }
+
+    buf_ring(detail::uring& ring,
+            std::size_t count, std::size_t size)
+        : ring_len_(count * sizeof(io_uring_buf))
+        , data_(new char[count * size])
+        , size_(size)
+        , mask_(static_cast<unsigned>(count - 1))
+    {
+        // The ring must be page aligned
+        auto const p = ::mmap(nullptr, ring_len_,
+            PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if(p == MAP_FAILED)
+            throw system_error{error_code{errno,
+                boost::system::generic_category()}};
+        ring_ = static_cast<io_uring_buf_ring*>(p);
+        io_uring_buf_reg reg;
+        std::memset(&reg, 0, sizeof(reg));
+        reg.ring_addr = reinterpret_cast<std::uintptr_t>(p);
+        reg.ring_entries = static_cast<unsigned>(count);
+        reg.bgid = 0;
+        error_code ec;
+        ring.register_buf_ring(reg, ec);
+        if(ec)
+        {
+            ::munmap(ring_, ring_len_);
+            throw system_error{ec};
+        }
+        for(std::size_t i = 0; i < count; ++i)
+            recycle(static_cast<unsigned>(i));
+    }
+
+    char*
+    data(unsigned bid)
+    {
+        return data_.get() + bid * size_;
+    }
+
+    // Give a buffer back to the kernel
+    void
+    recycle(unsigned bid)
+    {
+        // The entries start at the beginning of the ring. This
+        // does not use the bufs member, which has a different
+        // offset when the kernel header is compiled as C++.
+        auto& b = reinterpret_cast<io_uring_buf*>(
+            ring_)[tail_ & mask_];
+        b.addr = reinterpret_cast<std::uintptr_t>(data(bid));
+        b.len = static_cast<std::uint32_t>(size_);
+        b.bid = static_cast<std::uint16_t>(bid);
+        ++tail_;
+        __atomic_store_n(&ring_->tail, tail_, __ATOMIC_RELEASE);
+    }
+};
+
+inline
+uring_service::
+~uring_service()
+{
+    error_code ec;
+    event_.close(ec);
+}
+
+inline
+uring_service::
+uring_service(boost::asio::io_service& ios, unsigned entries)
+    : ios_(ios)
+    , ring_(entries)
+    , event_(ios)
+{
+    int const fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if(fd == -1)
+        throw system_error{error_code{errno,
+            boost::system::generic_category()}};
+    event_.assign(fd);
+    error_code ec;
+    ring_.register_eventfd(fd, ec);
+    if(ec)
+        throw system_error{ec};
+}
+
+inline
+void
+uring_service::
+register_buffers(std::vector<
+    boost::asio::mutable_buffer> const& buffers)
+{
+    using boost::asio::buffer_cast;
+    using boost::asio::buffer_size;
+    error_code ec;
+    if(! fixed_.empty())
+    {
+        ring_.unregister_buffers(ec);
+        if(ec)
+            throw system_error{ec};
+        fixed_.clear();
+    }
+    if(buffers.empty())
+        return;
+    std::vector<iovec> v;
+    v.reserve(buffers.size());
+    for(auto const& b : buffers)
+        v.push_back(iovec{
+            buffer_cast<void*>(b), buffer_size(b)});
+    ring_.register_buffers(v.data(),
+        static_cast<unsigned>(v.size()), ec);
+    if(ec)
+        throw system_error{ec};
+    fixed_ = std::move(v);
+}
+
+inline
+void
+uring_service::
+provide_buffers(std::size_t count, std::size_t size)
+{
+    if(bufs_)
+        throw std::logic_error{
+            "uring_service: buffers already provided"};
+    if(count == 0 || count > 32768 ||
+            (count & (count - 1)) != 0 || size == 0)
+        throw std::invalid_argument{
+            "uring_service: invalid buffer count or size"};
+    bufs_.reset(new buf_ring(ring_, count, size));
+}
+
+inline
+io_uring_sqe*
+uring_service::
+get_sqe(detail::uring_op& op)
+{
+    auto sqe = ring_.get_sqe();
+    if(! sqe)
+    {
+        // The queue is full, submitting
+        // what is there makes room.
+        flush();
+        sqe = ring_.get_sqe();
+        if(! sqe)
+            throw system_error{error_code{EBUSY,
+                boost::system::generic_category()}};
+    }
+    sqe->user_data = reinterpret_cast<std::uintptr_t>(&op);
+    ++outstanding_;
+    wait();
+    // Completion handlers are followed by a flush,
+    // anywhere else the submission is deferred so
+    // that it is batched with any which come next.
+    if(! reaping_ && ! flushing_)
+    {
+        flushing_ = true;
+        ios_.post(
+            [this]
+            {
+                flushing_ = false;
+                flush();
+            });
+    }
+    return sqe;
+}
+
+inline
+void
+uring_service::
+flush()
+{
+    // On failure the entries stay queued
+    // and are submitted by the next flush.
+    error_code ec;
+    ring_.submit(ec);
+}
+
+inline
+void
+uring_service::
+wait()
+{
+    if(waiting_ || outstanding_ == 0)
+        return;
+    waiting_ = true;
+    event_.async_read_some(boost::asio::buffer(
+        &event_value_, sizeof(event_value_)),
+        [this](error_code const& ec, std::size_t)
+        {
+            if(ec == boost::asio::error::operation_aborted)
+                return;
+            on_event(ec);
+        });
+}
+
+inline
+void
+uring_service::
+on_event(error_code const&)
+{
+    struct guard
+    {
+        uring_service& self;
+
+        ~guard()
+        {
+            self.reaping_ = false;
+            self.wait();
+        }
+    };
+
+    waiting_ = false;
+    reaping_ = true;
+    guard g{*this};
+    for(;;)
+    {
+        auto const n = ring_.reap(
+            [this](io_uring_cqe const& cqe)
+            {
+                if(! (cqe.flags & IORING_CQE_F_MORE))
+                    --outstanding_;
+                reinterpret_cast<detail::uring_op*>(
+                    static_cast<std::uintptr_t>(cqe.user_data))->
+                        complete(cqe.res, cqe.flags);
+            });
+        flush();
+        if(n == 0)
+            break;
+    }
+}
+
+inline
+int
+uring_service::
+find_fixed(void const* p, std::size_t n) const
+{
+    auto const c = static_cast<char const*>(p);
+    for(std::size_t i = 0; i < fixed_.size(); ++i)
+    {
+        auto const base = static_cast<
+            char const*>(fixed_[i].iov_base);
+        if(c >= base && c + n <= base + fixed_[i].iov_len)
+            return static_cast<int>(i);
+    }
+    return -1;
+}
+
+//------------------------------------------------------------------------------
+
+struct uring_stream::io_op_base : detail::uring_op
+{
+    detail::uring_buffers b;
+    msghdr msg;
+
+    template<class BufferSequence>
+    explicit
+    io_op_base(BufferSequence const& buffers)
+        : b(buffers)
+    {
+        std::memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = b.iov;
+        msg.msg_iovlen = b.count;
+    }
+
+    // Destroy the operation and post its handler
+    virtual
+    void
+    post(error_code const& ec, std::size_t n) = 0;
+};
+
+template<class Handler>
+class uring_stream::io_op : public io_op_base
+{
+    Handler h_;
+    boost::asio::io_service& ios_;
+    bool read_;
+
+public:
+    template<class DeducedHandler, class BufferSequence>
+    io_op(DeducedHandler&& h, boost::asio::io_service& ios,
+            BufferSequence const& buffers, bool read)
+        : io_op_base(buffers)
+        , h_(std::forward<DeducedHandler>(h))
+        , ios_(ios)
+        , read_(read)
+    {
+    }
+
+    void
+    complete(int res, unsigned) override
+    {
+        error_code ec;
+        std::size_t n = 0;
+        if(res < 0)
+            ec.assign(-res, boost::system::system_category());
+        else if(res == 0 && read_)
+            ec = boost::asio::error::eof;
+        else
+            n = static_cast<std::size_t>(res);
+        auto f = bind_handler(std::move(h_), ec, n);
+        destroy(f);
+        boost_asio_handler_invoke_helpers::invoke(f, f);
+    }
+
+    void
+    post(error_code const& ec, std::size_t n) override
+    {
+        auto& ios = ios_;
+        auto f = bind_handler(std::move(h_), ec, n);
+        destroy(f);
+        ios.post(std::move(f));
+    }
+
+private:
+    // Free the memory before the upcall,
+    // using the handler's allocation hooks.
+    template<class Function>
+    void
+    destroy(Function& f)
+    {
+        auto const p = this;
+        p->~io_op();
+        boost_asio_handler_alloc_helpers::
+            deallocate(p, sizeof(io_op), f);
+    }
+};
+
+// A multishot receive. It is owned by itself until the
+// final completion, since that may come after the stream
+// which armed it is gone.
+class uring_stream::rx_op : public detail::uring_op
+{
+    uring_service& svc_;
+
+public:
+    uring_stream* s;
+
+    explicit
+    rx_op(uring_stream& stream)
+        : svc_(*stream.svc_)
+        , s(&stream)
+    {
+    }
+
+    void
+    complete(int res, unsigned flags) override
+    {
+        bool const more = (flags & IORING_CQE_F_MORE) != 0;
+        io_op_base* op = nullptr;
+        int result = 0;
+        if(s)
+        {
+            if(! more)
+                s->rx_ = nullptr;
+            op = s->on_receive(res, flags, result);
+        }
+        else if(flags & IORING_CQE_F_BUFFER)
+        {
+            svc_.bufs_->recycle(
+                flags >> IORING_CQE_BUFFER_SHIFT);
+        }
+        if(! more)
+            delete this;
+        // The upcall comes last, as it
+        // may destroy the stream.
+        if(op)
+            op->complete(result, 0);
+    }
+};
+
+inline
+uring_stream::
+~uring_stream()
+{
+    close();
+}
+
+inline
+uring_stream::
+uring_stream(uring_stream&& other)
+    : svc_(other.svc_)
+    , fd_(other.fd_)
+    , multishot_(other.multishot_)
+    , rx_(other.rx_)
+    , rd_(other.rd_)
+    , rx_buf_(std::move(other.rx_buf_))
+    , rx_ec_(other.rx_ec_)
+{
+    if(rx_)
+        rx_->s = this;
+    other.fd_ = -1;
+    other.rx_ = nullptr;
+    other.rd_ = nullptr;
+}
+
+inline
+void
+uring_stream::
+assign(int fd)
+{
+    close();
+    fd_ = fd;
+}
+
+inline
+void
+uring_stream::
+close()
+{
+    if(fd_ == -1)
+        return;
+    // Entries still in the submission queue
+    // refer to the descriptor by number.
+    svc_->flush();
+    if(rx_)
+    {
+        rx_->s = nullptr;
+        rx_ = nullptr;
+    }
+    // Wakes up pending operations
+    ::shutdown(fd_, SHUT_RDWR);
+    ::close(fd_);
+    fd_ = -1;
+    rx_buf_.consume(rx_buf_.size());
+    rx_ec_ = {};
+    if(rd_)
+    {
+        auto const op = rd_;
+        rd_ = nullptr;
+        op->post(boost::asio::error::operation_aborted, 0);
+    }
+}
+
+inline
+void
+uring_stream::
+shutdown(boost::asio::socket_base::shutdown_type what,
+    error_code& ec)
+{
+    ec = {};
+    if(fd_ == -1)
+        ec = boost::asio::error::bad_descriptor;
+    else if(::shutdown(fd_, static_cast<int>(what)) != 0)
+        ec.assign(errno, boost::system::system_category());
+}
+
+template<class MutableBufferSequence>
+std::size_t
+uring_stream::
+read_some(MutableBufferSequence const& buffers)
+{
+    static_assert(is_MutableBufferSequence<
+        MutableBufferSequence>::value,
+            "MutableBufferSequence requirements not met");
+    error_code ec;
+    auto const n = read_some(buffers, ec);
+    if(ec)
+        throw system_error{ec};
+    return n;
+}
+
+template<class MutableBufferSequence>
+std::size_t
+uring_stream::
+read_some(MutableBufferSequence const& buffers,
+    error_code& ec)
+{
+    static_assert(is_MutableBufferSequence<
+        MutableBufferSequence>::value,
+            "MutableBufferSequence requirements not met");
+    ec = {};
+    if(fd_ == -1)
+    {
+        ec = boost::asio::error::bad_descriptor;
+        return 0;
+    }
+    detail::uring_buffers b(buffers);
+    if(b.size == 0)
+        return 0;
+    if(rx_buf_.size() > 0)
+        return take(b);
+    if(rx_ec_)
+    {
+        ec = rx_ec_;
+        return 0;
+    }
+    for(;;)
+    {
+        auto const n = ::readv(fd_, b.iov,
+            static_cast<int>(b.count));
+        if(n > 0)
+            return static_cast<std::size_t>(n);
+        if(n == 0)
+        {
+            ec = boost::asio::error::eof;
+            return 0;
+        }
+        if(errno == EAGAIN || errno == EWOULDBLOCK)
+        {
+            wait(POLLIN, ec);
+            if(ec)
+                return 0;
+        }
+        else if(errno != EINTR)
+        {
+            ec.assign(errno, boost::system::system_category());
+            return 0;
+        }
+    }
+}
+
+template<class ConstBufferSequence>
+std::size_t
+uring_stream::
+write_some(ConstBufferSequence const& buffers)
+{
+    static_assert(is_ConstBufferSequence<
+        ConstBufferSequence>::value,
+            "ConstBufferSequence requirements not met");
+    error_code ec;
+    auto const n = write_some(buffers, ec);
+    if(ec)
+        throw system_error{ec};
+    return n;
+}
+
+template<class ConstBufferSequence>
+std::size_t
+uring_stream::
+write_some(ConstBufferSequence const& buffers,
+    error_code& ec)
+{
+    static_assert(is_ConstBufferSequence<
+        ConstBufferSequence>::value,
+            "ConstBufferSequence requirements not met");
+    ec = {};
+    if(fd_ == -1)
+    {
+        ec = boost::asio::error::bad_descriptor;
+        return 0;
+    }
+    detail::uring_buffers b(buffers);
+    if(b.size == 0)
+        return 0;
+    msghdr msg;
+    std::memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = b.iov;
+    msg.msg_iovlen = b.count;
+    for(;;)
+    {
+        auto const n = ::sendmsg(fd_, &msg, MSG_NOSIGNAL);
+        if(n >= 0)
+            return static_cast<std::size_t>(n);
+        if(errno == EAGAIN || errno == EWOULDBLOCK)
+        {
+            wait(POLLOUT, ec);
+            if(ec)
+                return 0;
+        }
+        else if(errno != EINTR)
+        {
+            ec.assign(errno, boost::system::system_category());
+            return 0;
+        }
+    }
+}
+
+template<class MutableBufferSequence, class ReadHandler>
+auto
+uring_stream::
+async_read_some(MutableBufferSequence const& buffers,
+    ReadHandler&& handler) ->
+        typename async_completion<ReadHandler,
+            void(error_code, std::size_t)>::result_type
+{
+    static_assert(is_MutableBufferSequence<
+        MutableBufferSequence>::value,
+            "MutableBufferSequence requirements not met");
+    static_assert(is_CompletionHandler<ReadHandler,
+        void(error_code, std::size_t)>::value,
+            "ReadHandler requirements not met");
+    beast::async_completion<ReadHandler,
+        void(error_code, std::size_t)> completion(handler);
+    start_read(*make_op(completion.handler, buffers, true));
+    return completion.result.get();
+}
+
+template<class ConstBufferSequence, class WriteHandler>
+auto
+uring_stream::
+async_write_some(ConstBufferSequence const& buffers,
+    WriteHandler&& handler) ->
+        typename async_completion<WriteHandler,
+            void(error_code, std::size_t)>::result_type
+{
+    static_assert(is_ConstBufferSequence<
+        ConstBufferSequence>::value,
+            "ConstBufferSequence requirements not met");
+    static_assert(is_CompletionHandler<WriteHandler,
+        void(error_code, std::size_t)>::value,
+            "WriteHandler requirements not met");
+    beast::async_completion<WriteHandler,
+        void(error_code, std::size_t)> completion(handler);
+    start_write(*make_op(completion.handler, buffers, false));
+    return completion.result.get();
+}
+
+template<class Handler, class BufferSequence>
+auto
+uring_stream::
+make_op(Handler& handler,
+    BufferSequence const& buffers, bool read) ->
+        io_op<Handler>*
+{
+    using op_type = io_op<Handler>;
+    auto const p = boost_asio_handler_alloc_helpers::
+        allocate(sizeof(op_type), handler);
+    try
+    {
+        return ::new(p) op_type(std::move(handler),
+            get_io_service(), buffers, read);
+    }
+    catch(...)
+    {
+        boost_asio_handler_alloc_helpers::
+            deallocate(p, sizeof(op_type), handler);
+        throw;
+    }
+}
+
+inline
+void
+uring_stream::
+start_read(io_op_base& op)
+{
+    if(fd_ == -1)
+        return op.post(boost::asio::error::bad_descriptor, 0);
+    if(op.b.size == 0)
+        return op.post({}, 0);
+    if(rx_buf_.size() > 0)
+        return op.post({}, take(op.b));
+    if(rx_ec_)
+        return op.post(rx_ec_, 0);
+    if(multishot_)
+    {
+        if(! svc_->bufs_)
+            return op.post(boost::asio::error::
+                operation_not_supported, 0);
+        assert(! rd_);
+        rd_ = &op;
+        if(! rx_)
+            arm();
+        return;
+    }
+    auto const sqe = svc_->get_sqe(op);
+    sqe->fd = fd_;
+    if(op.b.count == 1)
+    {
+        auto const& iov = op.b.iov[0];
+        auto const i = svc_->find_fixed(
+            iov.iov_base, iov.iov_len);
+        if(i >= 0)
+        {
+            sqe->opcode = IORING_OP_READ_FIXED;
+            sqe->buf_index = static_cast<std::uint16_t>(i);
+        }
+        else
+        {
+            sqe->opcode = IORING_OP_RECV;
+        }
+        sqe->addr = reinterpret_cast<std::uintptr_t>(iov.iov_base);
+        sqe->len = static_cast<std::uint32_t>(iov.iov_len);
+    }
+    else
+    {
+        sqe->opcode = IORING_OP_RECVMSG;
+        sqe->addr = reinterpret_cast<std::uintptr_t>(&op.msg);
+        sqe->len = 1;
+    }
+}
+
+inline
+void
+uring_stream::
+start_write(io_op_base& op)
+{
+    if(fd_ == -1)
+        return op.post(boost::asio::error::bad_descriptor, 0);
+    if(op.b.size == 0)
+        return op.post({}, 0);
+    auto const sqe = svc_->get_sqe(op);
+    sqe->fd = fd_;
+    sqe->msg_flags = MSG_NOSIGNAL;
+    if(op.b.count == 1)
+    {
+        sqe->opcode = IORING_OP_SEND;
+        sqe->addr = reinterpret_cast<
+            std::uintptr_t>(op.b.iov[0].iov_base);
+        sqe->len = static_cast<
+            std::uint32_t>(op.b.iov[0].iov_len);
+    }
+    else
+    {
+        sqe->opcode = IORING_OP_SENDMSG;
+        sqe->addr = reinterpret_cast<std::uintptr_t>(&op.msg);
+        sqe->len = 1;
+    }
+}
+
+inline
+void
+uring_stream::
+arm()
+{
+    std::unique_ptr<rx_op> op(new rx_op(*this));
+    auto const sqe = svc_->get_sqe(*op);
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = fd_;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = 0;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    rx_ = op.release();
+}
+
+// Returns the waiting read to complete, if any
+inline
+auto
+uring_stream::
+on_receive(int res, unsigned flags, int& result) ->
+    io_op_base*
+{
+    io_op_base* op = nullptr;
+    if(res > 0)
+    {
+        auto const bid = flags >> IORING_CQE_BUFFER_SHIFT;
+        auto const p = svc_->bufs_->data(bid);
+        std::size_t n = static_cast<std::size_t>(res);
+        std::size_t used = 0;
+        if(rd_)
+        {
+            op = rd_;
+            rd_ = nullptr;
+            auto& b = op->b;
+            for(std::size_t i = 0; i < b.count && used < n; ++i)
+            {
+                auto const m = (std::min)(
+                    b.iov[i].iov_len, n - used);
+                std::memcpy(b.iov[i].iov_base, p + used, m);
+                used += m;
+            }
+            result = static_cast<int>(used);
+        }
+        if(used < n)
+            rx_buf_.commit(boost::asio::buffer_copy(
+                rx_buf_.prepare(n - used),
+                    boost::asio::buffer(p + used, n - used)));
+        svc_->bufs_->recycle(bid);
+    }
+    // Running out of buffers ends the multishot
+    // receive, a waiting read re-arms it below.
+    else if(res != -ENOBUFS)
+    {
+        if(res == 0)
+            rx_ec_ = boost::asio::error::eof;
+        else
+            rx_ec_.assign(-res, boost::system::system_category());
+        if(rd_)
+        {
+            op = rd_;
+            rd_ = nullptr;
+            result = res;
+        }
+    }
+    if(! rx_ && rd_)
+        arm();
+    return op;
+}
+
+// Copy buffered received data
+inline
+std::size_t
+uring_stream::
+take(detail::uring_buffers& b)
+{
+    std::size_t n = 0;
+    for(std::size_t i = 0; i < b.count; ++i)
+    {
+        auto const m = boost::asio::buffer_copy(
+            boost::asio::buffer(b.iov[i].iov_base,
+                b.iov[i].iov_len), rx_buf_.data());
+        rx_buf_.consume(m);
+        n += m;
+        if(m < b.iov[i].iov_len)
+            break;
+    }
+    return n;
+}
+
+inline
+void
+uring_stream::
+wait(short events, error_code& ec)
+{
+    pollfd p;
+    p.fd = fd_;
+    p.events = events;
+    p.revents = 0;
+    while(::poll(&p, 1, -1) == -1)
+    {
+        if(errno != EINTR)
+        {
+            ec.assign(errno, boost::system::system_category());
+            return;
+        }
+    }
+}
+
+} // beast
+
+#endif
@@ -0,0 +1,65 @@
+//
+// Copyright (c) 2013-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BEAST_RECYCLE_HANDLER_HPP
+#define BEAST_RECYCLE_HANDLER_HPP
+
+#include <beast/core/detail/recycled_handler.hpp>
+#include <type_traits>
+#include <utility>
+
+namespace beast {
+
+/** Wrap a completion handler so its operations recycle memory.
+
+    This function returns a new handler which, when invoked, calls the
+    original handler with the same arguments. The returned handler
+    provides the same `io_service` execution guarantees as the original
+    handler, but its `asio_handler_allocate` and `asio_handler_deallocate`
+    customizations are replaced with a per-thread cache of memory blocks.
+
+    Requests are rounded up to one of a few size classes, and each
+    thread keeps a short list of recently freed blocks for every class.
+    An operation started from a completion handler running on the same
+    thread usually receives the block just released by the operation
+    which completed, without touching the global allocator and without
+    any synchronization. Blocks freed on another thread are kept by
+    that thread. Requests larger than the biggest size class use
+    `operator new` directly.
+
+    The original handler's allocation customizations are not called.
+
+    Example:
+    @code
+    sock.async_read_some(boost::asio::buffer(buf),
+        recycle_handler(
+            [this](error_code ec, std::size_t bytes_transferred)
+            {
+                on_read(ec, bytes_transferred);
+            }));
+    @endcode
+
+    @param handler The handler to wrap. It is moved or copied into
+    the returned handler.
+*/
+template<class CompletionHandler>
+#if GENERATING_DOCS
+implementation_defined
+#else
+detail::recycled_handler<
+    typename std::decay<CompletionHandler>::type>
+#endif
+recycle_handler(CompletionHandler&& handler)
+{
+    return detail::recycled_handler<typename std::decay<
+        CompletionHandler>::type>(std::forward<
+            CompletionHandler>(handler));
+}
+
+} // beast
+
+#endif
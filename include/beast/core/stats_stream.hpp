@@ -0,0 +1,247 @@
+//
+// Copyright (c) 2013-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BEAST_STATS_STREAM_HPP
+#define BEAST_STATS_STREAM_HPP
+
+#include <beast/core/async_completion.hpp>
+#include <beast/core/buffer_concepts.hpp>
+#include <beast/core/error.hpp>
+#include <beast/core/handler_concepts.hpp>
+#include <beast/core/stream_concepts.hpp>
+#include <beast/core/stream_stats.hpp>
+#include <beast/core/detail/get_lowest_layer.hpp>
+#include <beast/core/detail/teardown.hpp>
+#include <boost/asio/io_service.hpp>
+#include <type_traits>
+#include <utility>
+
+namespace beast {
+
+namespace detail {
+struct stats_access;
+} // detail
+
+/** A @b `Stream` which records statistics about its use.
+
+    This wraps a @b `Stream` implementation, passing all calls through
+    to the underlying stream while counting the read and write
+    operations issued and the bytes transferred. The HTTP read and
+    write functions also count the messages they transfer on a stream
+    of this type, and the largest size reached by their buffers.
+
+    A `websocket::stream` keeps its own counts, which may be combined
+    with those of a `stats_stream` used as its next layer:
+
+    @code
+    websocket::stream<stats_stream<boost::asio::ip::tcp::socket>> ws(ios);
+    ...
+    stream_stats s = ws.stats();
+    s += ws.next_layer().stats();
+    @endcode
+
+    Counting only happens when the macro `BEAST_STREAM_STATS` is
+    defined to 1. Otherwise calls are passed through unchanged and
+    all counts are zero.
+
+    @tparam NextLayer The type of stream to wrap.
+*/
+template<class NextLayer>
+class stats_stream
+{
+    friend struct detail::stats_access;
+
+    template<class Handler, bool isRead>
+    class io_op;
+
+    NextLayer next_layer_;
+    detail::default_stats_recorder rec_;
+
+public:
+    /// The type of the next layer.
+    using next_layer_type =
+        typename std::remove_reference<NextLayer>::type;
+
+    /// The type of the lowest layer.
+    using lowest_layer_type =
+#if GENERATING_DOCS
+        implementation_defined;
+#else
+        typename detail::get_lowest_layer<
+            next_layer_type>::type;
+#endif
+
+    /** Move constructor.
+
+        @note The behavior of move assignment on or from streams
+        with active or pending operations is undefined.
+    */
+    stats_stream(stats_stream&&) = default;
+
+    /** Move assignment.
+
+        @note The behavior of move assignment on or from streams
+        with active or pending operations is undefined.
+    */
+    stats_stream& operator=(stats_stream&&) = default;
+
+    /** Construct the wrapping stream.
+
+        @param args Parameters forwarded to the `NextLayer` constructor.
+    */
+    template<class... Args>
+    explicit
+    stats_stream(Args&&... args)
+        : next_layer_(std::forward<Args>(args)...)
+    {
+    }
+
+    /// Get a reference to the next layer.
+    next_layer_type&
+    next_layer()
+    {
+        return next_layer_;
+    }
+
+    /// Get a reference to the lowest layer.
+    lowest_layer_type&
+    lowest_layer()
+    {
+        return next_layer_.lowest_layer();
+    }
+
+    /// Get a const reference to the lowest layer.
+    lowest_layer_type const&
+    lowest_layer() const
+    {
+        return next_layer_.lowest_layer();
+    }
+
+    /// Get the io_service associated with the object.
+    boost::asio::io_service&
+    get_io_service()
+    {
+        return next_layer_.get_io_service();
+    }
+
+    /// Returns the statistics recorded so far.
+    stream_stats const&
+    stats() const
+    {
+        return rec_.get();
+    }
+
+    /// Set all counts to zero.
+    void
+    reset_stats()
+    {
+        rec_.reset();
+    }
+
+    /// Read some data from the stream.
+    template<class MutableBufferSequence>
+    std::size_t
+    read_some(MutableBufferSequence const& buffers);
+
+    /// Read some data from the stream.
+    template<class MutableBufferSequence>
+    std::size_t
+    read_some(MutableBufferSequence const& buffers,
+        error_code& ec);
+
+    /// Start an asynchronous read.
+    template<class MutableBufferSequence, class ReadHandler>
+#if GENERATING_DOCS
+    void_or_deduced
+#else
+    typename async_completion<ReadHandler,
+        void(error_code, std::size_t)>::result_type
+#endif
+    async_read_some(MutableBufferSequence const& buffers,
+        ReadHandler&& handler);
+
+    /// Write some data to the stream.
+    template<class ConstBufferSequence>
+    std::size_t
+    write_some(ConstBufferSequence const& buffers);
+
+    /// Write some data to the stream.
+    template<class ConstBufferSequence>
+    std::size_t
+    write_some(ConstBufferSequence const& buffers,
+        error_code& ec);
+
+    /// Start an asynchronous write.
+    template<class ConstBufferSequence, class WriteHandler>
+#if GENERATING_DOCS
+    void_or_deduced
+#else
+    typename async_completion<WriteHandler,
+        void(error_code, std::size_t)>::result_type
+#endif
+    async_write_some(ConstBufferSequence const& buffers,
+        WriteHandler&& handler);
+
+    // Tears down the next layer, for websocket::stream
+    friend
+    void
+    teardown(stats_stream& s, error_code& ec)
+    {
+        websocket_helpers::call_teardown(
+            s.next_layer(), ec);
+    }
+
+    // Starts tearing down the next layer, for websocket::stream
+    template<class TeardownHandler>
+    friend
+    void
+    async_teardown(stats_stream& s, TeardownHandler&& handler)
+    {
+        static_assert(is_CompletionHandler<
+            TeardownHandler, void(error_code)>::value,
+                "TeardownHandler requirements not met");
+        websocket_helpers::call_async_teardown(
+            s.next_layer(), std::forward<
+                TeardownHandler>(handler));
+    }
+};
+
+namespace detail {
+
+struct stats_access
+{
+    template<class NextLayer>
+    static
+    default_stats_recorder&
+    recorder(stats_stream<NextLayer>& stream)
+    {
+        return stream.rec_;
+    }
+};
+
+// Returns the recorder for a stream, or null if it has none
+template<class Stream>
+default_stats_recorder*
+stats_of(Stream&)
+{
+    return nullptr;
+}
+
+template<class NextLayer>
+default_stats_recorder*
+stats_of(stats_stream<NextLayer>& stream)
+{
+    return &stats_access::recorder(stream);
+}
+
+} // detail
+
+} // beast
+
+#include <beast/core/impl/stats_stream.ipp>
+
+#endif
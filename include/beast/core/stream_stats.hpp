@@ -0,0 +1,285 @@
+//
+// Copyright (c) 2013-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BEAST_STREAM_STATS_HPP
+#define BEAST_STREAM_STATS_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+/** Set to 1 to record per-stream statistics.
+
+    When zero, the default, the statistics hooks in the library
+    compile to nothing and all reported counts are zero. The value
+    must be the same in every translation unit of a program.
+*/
+#ifndef BEAST_STREAM_STATS
+#define BEAST_STREAM_STATS 0
+#endif
+
+namespace beast {
+
+/** Counts of the work performed on a stream.
+
+    Objects of this type are reported by @ref stats_stream, which
+    counts the transport operations and HTTP messages, and by
+    `websocket::stream`, which counts frames, messages and the time
+    spent masking and validating. The counts from many streams, or
+    from the layers of one stream, may be combined with `operator+=`.
+
+    Counting only happens when the macro `BEAST_STREAM_STATS` is
+    defined to 1; otherwise all counts are zero.
+
+    Thread Safety:
+        The counts are plain integers updated by the stream's
+        operations. Read them from the same implicit or explicit
+        strand as the stream.
+*/
+struct stream_stats
+{
+    /// Bytes read from the transport.
+    std::uint64_t bytes_in = 0;
+
+    /// Bytes written to the transport.
+    std::uint64_t bytes_out = 0;
+
+    /// Read operations issued to the transport, usually one system call each.
+    std::uint64_t reads = 0;
+
+    /// Write operations issued to the transport, usually one system call each.
+    std::uint64_t writes = 0;
+
+    /// HTTP messages or complete WebSocket messages received.
+    std::uint64_t messages_in = 0;
+
+    /// HTTP messages or complete WebSocket messages sent.
+    std::uint64_t messages_out = 0;
+
+    /// WebSocket frames received, including control frames.
+    std::uint64_t frames_in = 0;
+
+    /// WebSocket frames sent, including control frames.
+    std::uint64_t frames_out = 0;
+
+    /// WebSocket control frames received.
+    std::uint64_t control_in = 0;
+
+    /// WebSocket control frames sent.
+    std::uint64_t control_out = 0;
+
+    /// The largest size reached by a buffer holding received data.
+    std::uint64_t read_buffer_max = 0;
+
+    /// The largest size reached by a buffer holding data to send.
+    std::uint64_t write_buffer_max = 0;
+
+    /// Nanoseconds spent applying and removing WebSocket masks.
+    std::uint64_t mask_ns = 0;
+
+    /// Nanoseconds spent validating UTF-8 in WebSocket text messages.
+    std::uint64_t utf8_ns = 0;
+
+    /** Add the counts of another object.
+
+        High-water marks take the larger of the two values.
+    */
+    stream_stats&
+    operator+=(stream_stats const& other)
+    {
+        bytes_in += other.bytes_in;
+        bytes_out += other.bytes_out;
+        reads += other.reads;
+        writes += other.writes;
+        messages_in += other.messages_in;
+        messages_out += other.messages_out;
+        frames_in += other.frames_in;
+        frames_out += other.frames_out;
+        control_in += other.control_in;
+        control_out += other.control_out;
+        if(other.read_buffer_max > read_buffer_max)
+            read_buffer_max = other.read_buffer_max;
+        if(other.write_buffer_max > write_buffer_max)
+            write_buffer_max = other.write_buffer_max;
+        mask_ns += other.mask_ns;
+        utf8_ns += other.utf8_ns;
+        return *this;
+    }
+};
+
+namespace detail {
+
+// Accumulates elapsed time into a counter on destruction
+class stats_timer
+{
+    using clock_type = std::chrono::steady_clock;
+
+    std::uint64_t* p_;
+    clock_type::time_point t0_;
+
+public:
+    explicit
+    stats_timer(std::uint64_t& n)
+        : p_(&n)
+        , t0_(clock_type::now())
+    {
+    }
+
+    stats_timer(stats_timer&& other)
+        : p_(other.p_)
+        , t0_(other.t0_)
+    {
+        other.p_ = nullptr;
+    }
+
+    ~stats_timer()
+    {
+        if(p_)
+            *p_ += static_cast<std::uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    clock_type::now() - t0_).count());
+    }
+};
+
+struct null_stats_timer
+{
+    // Not trivial, so an unused timer draws no warning
+    ~null_stats_timer()
+    {
+    }
+};
+
+/*  Records statistics for a stream.
+
+    The hooks are called unconditionally by the library. When
+    disabled, the hooks are empty and the object has no state.
+*/
+template<bool Enabled>
+class stats_recorder
+{
+    stream_stats s_;
+
+public:
+    stream_stats const&
+    get() const
+    {
+        return s_;
+    }
+
+    void
+    reset()
+    {
+        s_ = {};
+    }
+
+    void
+    on_read(std::size_t n)
+    {
+        ++s_.reads;
+        s_.bytes_in += n;
+    }
+
+    void
+    on_write(std::size_t n)
+    {
+        ++s_.writes;
+        s_.bytes_out += n;
+    }
+
+    void
+    on_message_in()
+    {
+        ++s_.messages_in;
+    }
+
+    void
+    on_message_out()
+    {
+        ++s_.messages_out;
+    }
+
+    // A frame header was received
+    void
+    on_frame_in(bool control, bool fin)
+    {
+        ++s_.frames_in;
+        if(control)
+            ++s_.control_in;
+        else if(fin)
+            ++s_.messages_in;
+    }
+
+    // A frame header was sent
+    void
+    on_frame_out(bool control, bool fin)
+    {
+        ++s_.frames_out;
+        if(control)
+            ++s_.control_out;
+        else if(fin)
+            ++s_.messages_out;
+    }
+
+    void
+    on_read_buffer(std::size_t n)
+    {
+        if(n > s_.read_buffer_max)
+            s_.read_buffer_max = n;
+    }
+
+    void
+    on_write_buffer(std::size_t n)
+    {
+        if(n > s_.write_buffer_max)
+            s_.write_buffer_max = n;
+    }
+
+    stats_timer
+    time_mask()
+    {
+        return stats_timer{s_.mask_ns};
+    }
+
+    stats_timer
+    time_utf8()
+    {
+        return stats_timer{s_.utf8_ns};
+    }
+};
+
+template<>
+class stats_recorder<false>
+{
+public:
+    stream_stats const&
+    get() const
+    {
+        static stream_stats const s{};
+        return s;
+    }
+
+    void reset() {}
+    void on_read(std::size_t) {}
+    void on_write(std::size_t) {}
+    void on_message_in() {}
+    void on_message_out() {}
+    void on_frame_in(bool, bool) {}
+    void on_frame_out(bool, bool) {}
+    void on_read_buffer(std::size_t) {}
+    void on_write_buffer(std::size_t) {}
+    null_stats_timer time_mask() { return {}; }
+    null_stats_timer time_utf8() { return {}; }
+};
+
+using default_stats_recorder =
+    stats_recorder<BEAST_STREAM_STATS != 0>;
+
+} // detail
+
+} // beast
+
+#endif
@@ -0,0 +1,182 @@
+//
+// Copyright (c) 2013-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BEAST_STREAMBUF_POOL_HPP
+#define BEAST_STREAMBUF_POOL_HPP
+
+#include <beast/core/basic_streambuf.hpp>
+#include <cstddef>
+#include <type_traits>
+
+namespace beast {
+
+/** A per-thread cache of memory blocks for stream buffers.
+
+    A @ref basic_streambuf allocates one block for each of its
+    internal character arrays, and frees the block when the array is
+    consumed. Stream buffers using @ref streambuf_pool_allocator take
+    their blocks from the pool of the calling thread and give them
+    back to the pool of the thread which frees them, instead of
+    calling the global allocator each time.
+
+    Freed blocks are kept in a few lists, one for each block size
+    seen, so stream buffers created with the same allocation size
+    share their blocks. The total size of the cached blocks on each
+    thread is capped, blocks freed while the cap would be exceeded
+    go back to the global allocator.
+
+    All functions act on the pool belonging to the calling thread.
+    No synchronization takes place.
+*/
+class streambuf_pool
+{
+public:
+    /// The default cap on the bytes cached by each thread.
+    static std::size_t constexpr default_max_bytes = 1024 * 1024;
+
+    /// Statistics describing the pool of a thread.
+    struct stats
+    {
+        /// The number of allocations satisfied from the pool.
+        std::size_t hits = 0;
+
+        /// The number of allocations passed to the global allocator.
+        std::size_t misses = 0;
+
+        /// The number of blocks currently held by the pool.
+        std::size_t blocks_held = 0;
+
+        /// The number of bytes currently held by the pool.
+        std::size_t bytes_held = 0;
+
+        /// Returns the fraction of allocations satisfied from the pool.
+        double
+        hit_rate() const
+        {
+            auto const n = hits + misses;
+            return n > 0 ? static_cast<double>(hits) / n : 0;
+        }
+    };
+
+    /// Returns the statistics for the calling thread's pool.
+    static
+    stats
+    get_stats();
+
+    /// Returns the cap on the bytes cached by the calling thread.
+    static
+    std::size_t
+    max_bytes();
+
+    /** Set the cap on the bytes cached by the calling thread.
+
+        If the pool holds more than `n` bytes, blocks are
+        freed until the cap is met.
+    */
+    static
+    void
+    max_bytes(std::size_t n);
+
+    /// Free all blocks held by the calling thread's pool.
+    static
+    void
+    shrink();
+
+    /** Allocate a block from the calling thread's pool.
+
+        @param n The size of the block in bytes.
+    */
+    static
+    void*
+    allocate(std::size_t n);
+
+    /** Return a block to the calling thread's pool.
+
+        @param p A pointer previously returned by @ref allocate
+        on any thread.
+
+        @param n The size passed to @ref allocate.
+    */
+    static
+    void
+    deallocate(void* p, std::size_t n);
+
+private:
+    class impl;
+
+    static
+    impl*
+    get();
+};
+
+/** An allocator which draws from the @ref streambuf_pool.
+
+    All instances compare equal, so stream buffers using this
+    allocator may be moved and swapped freely, including between
+    threads.
+
+    @tparam T The type of objects allocated by the allocator.
+*/
+template<class T>
+class streambuf_pool_allocator
+{
+public:
+    using value_type = T;
+    using is_always_equal = std::true_type;
+
+    streambuf_pool_allocator() = default;
+
+    template<class U>
+    streambuf_pool_allocator(
+        streambuf_pool_allocator<U> const&) noexcept
+    {
+    }
+
+    value_type*
+    allocate(std::size_t n)
+    {
+        return static_cast<value_type*>(
+            streambuf_pool::allocate(n * sizeof(T)));
+    }
+
+    void
+    deallocate(value_type* p, std::size_t n)
+    {
+        streambuf_pool::deallocate(p, n * sizeof(T));
+    }
+
+    template<class U>
+    friend
+    bool
+    operator==(streambuf_pool_allocator const&,
+        streambuf_pool_allocator<U> const&)
+    {
+        return true;
+    }
+
+    template<class U>
+    friend
+    bool
+    operator!=(streambuf_pool_allocator const&,
+        streambuf_pool_allocator<U> const&)
+    {
+        return false;
+    }
+};
+
+/** A @b `DynamicBuffer` which recycles its memory in the @ref streambuf_pool.
+
+    @note Meets the requirements of @b `DynamicBuffer`.
+*/
+using pooled_streambuf =
+    basic_streambuf<streambuf_pool_allocator<char>>;
+
+} // beast
+
+#include <beast/core/impl/streambuf_pool.ipp>
+
+#endif
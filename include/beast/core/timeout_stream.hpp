@@ -0,0 +1,293 @@
+//
+// Copyright (c) 2013-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BEAST_TIMEOUT_STREAM_HPP
+#define BEAST_TIMEOUT_STREAM_HPP
+
+#include <beast/core/async_completion.hpp>
+#include <beast/core/buffer_concepts.hpp>
+#include <beast/core/error.hpp>
+#include <beast/core/handler_concepts.hpp>
+#include <beast/core/stream_concepts.hpp>
+#include <beast/core/timer_wheel.hpp>
+#include <beast/core/detail/get_lowest_layer.hpp>
+#include <beast/core/detail/teardown.hpp>
+#include <boost/asio/io_service.hpp>
+#include <atomic>
+#include <type_traits>
+#include <utility>
+
+namespace beast {
+
+/** A @b `Stream` whose operations time out.
+
+    This wraps a @b `Stream` implementation, passing all calls through
+    to the underlying stream, and arms timers in a shared
+    @ref timer_wheel to limit how long the stream may go without
+    making progress, and how long a step such as reading a request
+    header or completing a handshake may take.
+
+    When a timeout expires, pending operations on the lowest layer
+    are cancelled and complete with `boost::asio::error::timed_out`,
+    as does every operation started afterwards. The stream is then
+    expected to be closed.
+
+    Because the HTTP and WebSocket operations are composed of reads
+    and writes on their stream, the same timeouts apply to them when
+    a `timeout_stream` is used as the next layer:
+
+    @code
+    timer_wheel wheel(ios);
+    websocket::stream<timeout_stream<boost::asio::ip::tcp::socket>> ws(wheel, ios);
+    ws.next_layer().idle_timeout(std::chrono::seconds(60));
+    ws.next_layer().expires_after(std::chrono::seconds(10));
+    ws.async_accept(
+        [&](error_code const& ec)
+        {
+            ws.next_layer().expires_never();
+            ...
+        });
+    @endcode
+
+    The timeouts only cancel asynchronous operations. Synchronous
+    operations are not interrupted, but fail once the stream expired.
+
+    Thread Safety:
+        Expiration cancels operations from a handler of the wheel's
+        `io_service`. The stream must be used from the same thread
+        or strand which runs that `io_service`, as with any other
+        call to `cancel` on the lowest layer.
+
+    @tparam NextLayer The type of stream to wrap. The lowest layer
+    must provide `cancel(error_code&)`.
+*/
+template<class NextLayer>
+class timeout_stream
+{
+    class timer_type : public timer_wheel::timer
+    {
+        timeout_stream* s_;
+
+    public:
+        timer_type(timer_wheel& w, timeout_stream& s)
+            : timer_wheel::timer(w)
+            , s_(&s)
+        {
+        }
+
+        timer_type(timer_type&& other, timeout_stream& s)
+            : timer_wheel::timer(std::move(other))
+            , s_(&s)
+        {
+        }
+
+    protected:
+        void
+        on_expire() override
+        {
+            s_->on_expire();
+        }
+    };
+
+    template<class Handler>
+    class io_op;
+
+    NextLayer next_layer_;
+    timer_type idle_;
+    timer_type deadline_;
+    timer_wheel::clock_type::duration idle_timeout_{};
+    std::atomic<bool> expired_;
+
+public:
+    /// The type of the next layer.
+    using next_layer_type =
+        typename std::remove_reference<NextLayer>::type;
+
+    /// The type of the lowest layer.
+    using lowest_layer_type =
+#if GENERATING_DOCS
+        implementation_defined;
+#else
+        typename detail::get_lowest_layer<
+            next_layer_type>::type;
+#endif
+
+    /// The type of duration used for timeouts.
+    using duration = timer_wheel::clock_type::duration;
+
+    /** Move constructor.
+
+        The timers of `other` are transferred to the new stream.
+
+        @note The behavior of move construction from streams
+        with active or pending operations is undefined.
+    */
+    timeout_stream(timeout_stream&& other);
+
+    /// Move assignment (deleted).
+    timeout_stream& operator=(timeout_stream&&) = delete;
+
+    /** Construct the wrapping stream.
+
+        @param wheel The wheel in which the timers are armed.
+        It must outlive the stream.
+
+        @param args Parameters forwarded to the `NextLayer` constructor.
+    */
+    template<class... Args>
+    explicit
+    timeout_stream(timer_wheel& wheel, Args&&... args);
+
+    /// Get a reference to the next layer.
+    next_layer_type&
+    next_layer()
+    {
+        return next_layer_;
+    }
+
+    /// Get a reference to the lowest layer.
+    lowest_layer_type&
+    lowest_layer()
+    {
+        return lowest_layer(std::integral_constant<bool,
+            detail::has_lowest_layer<next_layer_type>::value>{});
+    }
+
+    /// Get the io_service associated with the object.
+    boost::asio::io_service&
+    get_io_service()
+    {
+        return next_layer_.get_io_service();
+    }
+
+    /** Set the idle timeout.
+
+        The stream expires when this much time passes without an
+        operation starting or completing. The timer is rearmed by
+        each operation, so a busy stream rarely touches the wheel's
+        slots for more than a relink. A value of zero, the default,
+        disables the idle timeout.
+    */
+    void
+    idle_timeout(duration d);
+
+    /** Set a deadline relative to the current time.
+
+        The stream expires when the deadline is reached, regardless
+        of progress. This is used to limit a single step, such as
+        reading a request header or completing a handshake. Calling
+        this again replaces the deadline.
+    */
+    void
+    expires_after(duration d)
+    {
+        deadline_.expires_after(d);
+    }
+
+    /// Cancel the deadline.
+    void
+    expires_never()
+    {
+        deadline_.cancel();
+    }
+
+    /// Returns `true` if a timeout has expired.
+    bool
+    expired() const
+    {
+        return expired_.load(std::memory_order_acquire);
+    }
+
+    /// Read some data from the stream.
+    template<class MutableBufferSequence>
+    std::size_t
+    read_some(MutableBufferSequence const& buffers);
+
+    /// Read some data from the stream.
+    template<class MutableBufferSequence>
+    std::size_t
+    read_some(MutableBufferSequence const& buffers,
+        error_code& ec);
+
+    /// Start an asynchronous read.
+    template<class MutableBufferSequence, class ReadHandler>
+#if GENERATING_DOCS
+    void_or_deduced
+#else
+    typename async_completion<ReadHandler,
+        void(error_code, std::size_t)>::result_type
+#endif
+    async_read_some(MutableBufferSequence const& buffers,
+        ReadHandler&& handler);
+
+    /// Write some data to the stream.
+    template<class ConstBufferSequence>
+    std::size_t
+    write_some(ConstBufferSequence const& buffers);
+
+    /// Write some data to the stream.
+    template<class ConstBufferSequence>
+    std::size_t
+    write_some(ConstBufferSequence const& buffers,
+        error_code& ec);
+
+    /// Start an asynchronous write.
+    template<class ConstBufferSequence, class WriteHandler>
+#if GENERATING_DOCS
+    void_or_deduced
+#else
+    typename async_completion<WriteHandler,
+        void(error_code, std::size_t)>::result_type
+#endif
+    async_write_some(ConstBufferSequence const& buffers,
+        WriteHandler&& handler);
+
+    // Tears down the next layer, for websocket::stream
+    friend
+    void
+    teardown(timeout_stream& s, error_code& ec)
+    {
+        websocket_helpers::call_teardown(
+            s.next_layer(), ec);
+    }
+
+    // Starts tearing down the next layer, for websocket::stream
+    template<class TeardownHandler>
+    friend
+    void
+    async_teardown(timeout_stream& s, TeardownHandler&& handler)
+    {
+        static_assert(is_CompletionHandler<
+            TeardownHandler, void(error_code)>::value,
+                "TeardownHandler requirements not met");
+        websocket_helpers::call_async_teardown(
+            s.next_layer(), std::forward<
+                TeardownHandler>(handler));
+    }
+
+private:
+    lowest_layer_type&
+    lowest_layer(std::true_type)
+    {
+        return next_layer_.lowest_layer();
+    }
+
+    lowest_layer_type&
+    lowest_layer(std::false_type)
+    {
+        return next_layer_;
+    }
+
+    void on_activity();
+    void on_expire();
+};
+
+} // beast
+
+#include <beast/core/impl/timeout_stream.ipp>
+
+#endif
@@ -0,0 +1,230 @@
+//
+// Copyright (c) 2013-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BEAST_TIMER_WHEEL_HPP
+#define BEAST_TIMER_WHEEL_HPP
+
+#include <beast/core/error.hpp>
+#include <boost/asio/basic_waitable_timer.hpp>
+#include <boost/asio/io_service.hpp>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+namespace beast {
+
+/** A hierarchical timer wheel shared by many timers.
+
+    A server with many connections usually needs a timeout for
+    each of them, which is rarely reached and frequently moved.
+    Giving each connection its own asio timer costs an entry in
+    the reactor's timer queue and a system call for every change.
+    The wheel instead keeps its timers in intrusive lists, so that
+    arming, rearming and cancelling a @ref timer_wheel::timer are
+    constant time operations which never allocate, and drives them
+    all with a single asio timer which ticks only while at least
+    one timer is armed.
+
+    Timers expire on the first tick at or after their expiration
+    time, so they may run late by up to one resolution. The wheel
+    holds four levels of 256 slots, reaching 2^32 ticks ahead;
+    longer durations are shortened to this limit.
+
+    Thread Safety:
+        Timers may be armed and cancelled from any thread. The
+        expiration function of a timer runs in a handler of the
+        wheel's `io_service`.
+
+    The wheel must outlive its timers, and the pending handlers
+    of its `io_service`.
+
+    Example:
+    @code
+    boost::asio::io_service ios;
+    timer_wheel wheel(ios, std::chrono::milliseconds(100));
+    timeout_stream<boost::asio::ip::tcp::socket> sock(wheel, ios);
+    sock.idle_timeout(std::chrono::seconds(30));
+    @endcode
+*/
+class timer_wheel
+{
+public:
+    /// The clock used to measure time.
+    using clock_type = std::chrono::steady_clock;
+
+    class timer;
+
+private:
+    struct hook
+    {
+        hook* prev;
+        hook* next;
+
+        hook()
+            : prev(this)
+            , next(this)
+        {
+        }
+
+        hook(hook const&) = delete;
+        hook& operator=(hook const&) = delete;
+
+        bool
+        empty() const
+        {
+            return next == this;
+        }
+
+        void
+        push_back(hook& h)
+        {
+            h.prev = prev;
+            h.next = this;
+            prev->next = &h;
+            prev = &h;
+        }
+
+        void
+        unlink()
+        {
+            prev->next = next;
+            next->prev = prev;
+            prev = this;
+            next = this;
+        }
+    };
+
+    static std::size_t constexpr levels = 4;
+    static std::size_t constexpr bits = 8;
+    static std::size_t constexpr slots = 1 << bits;
+
+    std::mutex m_;
+    boost::asio::basic_waitable_timer<clock_type> t_;
+    clock_type::duration res_;
+    clock_type::time_point origin_;
+    std::uint64_t now_ = 0;         // the last tick processed
+    std::size_t count_ = 0;         // armed timers
+    bool running_ = false;          // t_ has a pending wait
+    hook wheel_[levels][slots];
+    hook expired_;                  // waiting to be called
+
+public:
+    timer_wheel(timer_wheel const&) = delete;
+    timer_wheel& operator=(timer_wheel const&) = delete;
+
+    /** Construct the wheel.
+
+        @param ios The `io_service` used to drive the wheel.
+
+        @param resolution The interval between ticks.
+    */
+    explicit
+    timer_wheel(boost::asio::io_service& ios,
+        clock_type::duration resolution =
+            std::chrono::milliseconds(100));
+
+    /// Destructor.
+    ~timer_wheel();
+
+    /// Returns the interval between ticks.
+    clock_type::duration
+    resolution() const
+    {
+        return res_;
+    }
+
+    /// Returns the number of armed timers.
+    std::size_t
+    size();
+
+private:
+    std::uint64_t elapsed() const;
+    void insert(timer& t);
+    void arm(timer& t, clock_type::duration d);
+    void cancel(timer& t);
+    void replace(timer& from, timer& to);
+    void start();
+    void on_tick(error_code const& ec);
+};
+
+/** A timer which is armed in a @ref timer_wheel.
+
+    Derived classes override `on_expire`, which is called when the
+    timer expires. The timer is no longer armed when it is called,
+    and it may be armed again from within the call.
+
+    Destroying an armed timer cancels it. The timer must not be
+    destroyed while its `on_expire` may be running.
+*/
+class timer_wheel::timer : private timer_wheel::hook
+{
+    friend class timer_wheel;
+
+    timer_wheel* w_;
+    std::uint64_t when_ = 0;
+    bool armed_ = false;
+
+protected:
+    /// Called when the timer expires.
+    virtual
+    void
+    on_expire() = 0;
+
+public:
+    /// Construct an unarmed timer for the given wheel.
+    explicit
+    timer(timer_wheel& w)
+        : w_(&w)
+    {
+    }
+
+    /** Move constructor.
+
+        The new timer takes the place of `other` in the wheel, and
+        `other` is left unarmed.
+    */
+    timer(timer&& other);
+
+    /// Move assignment (deleted).
+    timer& operator=(timer&&) = delete;
+
+    /// Destructor.
+    virtual
+    ~timer();
+
+    /// Returns the wheel associated with the timer.
+    timer_wheel&
+    wheel() const
+    {
+        return *w_;
+    }
+
+    /** Arm the timer to expire after a duration.
+
+        If the timer is already armed, its expiration time is
+        replaced.
+    */
+    void
+    expires_after(clock_type::duration d)
+    {
+        w_->arm(*this, d);
+    }
+
+    /// Cancel the timer if it is armed.
+    void
+    cancel()
+    {
+        w_->cancel(*this);
+    }
+};
+
+} // beast
+
+#include <beast/core/impl/timer_wheel.ipp>
+
+#endif
@@ -0,0 +1,209 @@
+//
+// Copyright (c) 2013-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BEAST_TRACE_HPP
+#define BEAST_TRACE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+/** Set to 1 to trace composed operations.
+
+    When zero, the default, the tracing hooks in the library compile
+    to nothing. The value must be the same in every translation unit
+    of a program.
+*/
+#ifndef BEAST_TRACE
+#define BEAST_TRACE 0
+#endif
+
+/** The number of events kept for each thread.
+
+    This must be a power of two.
+*/
+#ifndef BEAST_TRACE_SIZE
+#define BEAST_TRACE_SIZE 4096
+#endif
+
+namespace beast {
+
+/// The kind of a @ref trace_event.
+enum class trace_kind
+{
+    /// The operation was started.
+    begin,
+
+    /// The operation entered a state.
+    step,
+
+    /// The operation suspended until another operation completes.
+    wait,
+
+    /// The operation is about to invoke its handler.
+    end
+};
+
+/** An event recorded by a composed operation.
+
+    Events are recorded when the macro `BEAST_TRACE` is defined
+    to 1. An operation records @ref trace_kind::begin when it
+    starts, @ref trace_kind::step each time its state machine is
+    entered, @ref trace_kind::wait when it suspends behind another
+    operation on the same stream, and @ref trace_kind::end just
+    before it invokes the final handler.
+*/
+struct trace_event
+{
+    /// Nanoseconds since the epoch of `std::chrono::steady_clock`.
+    std::uint64_t time;
+
+    /// Identifies the operation; stable for the life of the operation.
+    void const* op;
+
+    /// The name of the operation.
+    char const* name;
+
+    /// The kind of event.
+    trace_kind kind;
+
+    /** The state of the operation, or for @ref trace_kind::end
+        the value of the error code passed to the handler.
+    */
+    int value;
+};
+
+/** A ring buffer holding the most recent trace events of one thread.
+
+    Each thread which records an event has its own buffer, which
+    keeps the last `BEAST_TRACE_SIZE` events. Recording is wait-free
+    and takes no locks. The buffer may be read from any thread while
+    the owning thread is recording; events overwritten during the
+    read are left out.
+
+    Example:
+    @code
+    // Write the events of every thread, for example on a signal
+    // or from an administrative endpoint.
+    trace_dump(std::cerr);
+    @endcode
+*/
+class trace_buffer
+{
+    static_assert((BEAST_TRACE_SIZE &
+        (BEAST_TRACE_SIZE - 1)) == 0,
+            "BEAST_TRACE_SIZE must be a power of two");
+
+    struct slot
+    {
+        std::atomic<std::uint64_t> time;
+        std::atomic<void const*> op;
+        std::atomic<char const*> name;
+        std::atomic<int> kind;
+        std::atomic<int> value;
+    };
+
+    class registry;
+
+    std::unique_ptr<slot[]> v_;
+    std::atomic<std::uint64_t> head_;   // events published
+    std::atomic<std::uint64_t> begin_;  // events started
+    std::size_t id_;
+
+public:
+    /// Construct an empty buffer.
+    explicit
+    trace_buffer(std::size_t id = 0);
+
+    trace_buffer(trace_buffer const&) = delete;
+    trace_buffer& operator=(trace_buffer const&) = delete;
+
+    /// Returns the number of events the buffer holds.
+    static
+    std::size_t
+    capacity()
+    {
+        return BEAST_TRACE_SIZE;
+    }
+
+    /// Returns a number which identifies the thread owning the buffer.
+    std::size_t
+    id() const
+    {
+        return id_;
+    }
+
+    /** Record an event.
+
+        This may only be called from one thread at a time.
+    */
+    void
+    record(void const* op, char const* name,
+        trace_kind kind, int value);
+
+    /// Returns the events in the buffer, oldest first.
+    std::vector<trace_event>
+    events() const;
+
+    /// Returns the buffer of the calling thread.
+    static
+    trace_buffer&
+    local();
+
+    /** Call a function with the buffer of each thread.
+
+        Buffers belong to threads which have recorded an event and
+        have not exited.
+    */
+    template<class Function>
+    static
+    void
+    for_each(Function&& f);
+};
+
+/** Write the trace events of every thread to a stream.
+
+    Each line holds the time in nanoseconds, the operation, its
+    name, the kind of event and the state or error value.
+*/
+void
+trace_dump(std::ostream& os);
+
+namespace detail {
+
+#if BEAST_TRACE
+
+inline
+void
+trace(void const* op, char const* name,
+    trace_kind kind, int value = 0)
+{
+    trace_buffer::local().record(op, name, kind, value);
+}
+
+#else
+
+inline
+void
+trace(void const*, char const*, trace_kind, int = 0)
+{
+}
+
+#endif
+
+} // detail
+
+} // beast
+
+#include <beast/core/impl/trace.ipp>
+
+#endif
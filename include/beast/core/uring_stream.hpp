@@ -0,0 +1,416 @@
+//
+// Copyright (c) 2013-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BEAST_URING_STREAM_HPP
+#define BEAST_URING_STREAM_HPP
+
+#if defined(__linux__)
+
+#include <beast/core/async_completion.hpp>
+#include <beast/core/error.hpp>
+#include <beast/core/streambuf.hpp>
+#include <beast/core/detail/uring.hpp>
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/posix/stream_descriptor.hpp>
+#include <boost/asio/socket_base.hpp>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace beast {
+
+/** An io_uring instance which completes operations on an io_service.
+
+    Operations started on any @ref uring_stream using this service
+    are placed in the io_uring submission queue. Entries queued while
+    a completion handler runs are submitted together with a single
+    system call once the handler returns, and entries queued from
+    elsewhere are submitted by a handler posted to the io_service. The
+    kernel signals completions through an eventfd which the service
+    waits on with the io_service, so io_uring streams and ordinary
+    asio objects may be used together on the same io_service.
+
+    Thread Safety:
+        @e Distinct @e objects: Safe.@n
+        @e Shared @e objects: Unsafe. The service and all streams
+        using it must be used from a single thread calling
+        `io_service::run`, such as one io_service per thread.
+
+    @note All streams using the service must be closed, and all of
+    their operations must have completed, before the service is
+    destroyed. The service must be destroyed after the io_service has
+    stopped running.
+*/
+class uring_service
+{
+    friend class uring_stream;
+
+    class buf_ring;
+
+    boost::asio::io_service& ios_;
+    detail::uring ring_;
+    boost::asio::posix::stream_descriptor event_;
+    std::uint64_t event_value_;
+    std::size_t outstanding_ = 0;
+    bool waiting_ = false;
+    bool flushing_ = false;
+    bool reaping_ = false;
+    std::vector<iovec> fixed_;
+    std::unique_ptr<buf_ring> bufs_;
+
+public:
+    /// Destructor.
+    ~uring_service();
+
+    uring_service(uring_service const&) = delete;
+    uring_service& operator=(uring_service const&) = delete;
+
+    /** Construct the service.
+
+        @param ios The io_service used to wait for completions and
+        to invoke completion handlers.
+
+        @param entries The size of the submission queue. The
+        completion queue holds four times as many entries.
+
+        @throws system_error if the kernel does not support io_uring,
+        or the ring cannot be created.
+    */
+    explicit
+    uring_service(
+        boost::asio::io_service& ios, unsigned entries = 256);
+
+    /// Return the io_service associated with the service.
+    boost::asio::io_service&
+    get_io_service()
+    {
+        return ios_;
+    }
+
+    /** Register buffers with the kernel.
+
+        The kernel maps registered buffers once, instead of on every
+        operation. Afterwards, a read on a @ref uring_stream whose
+        buffer sequence is a single buffer lying inside a registered
+        buffer is performed with `IORING_OP_READ_FIXED`. No change to
+        calling code is needed to benefit, for example when the
+        storage of a @ref flat_streambuf is registered.
+
+        Buffers registered by a previous call are unregistered first.
+        The memory must remain valid until it is unregistered, or
+        the service is destroyed.
+
+        @param buffers The buffers to register. An empty list
+        unregisters all buffers.
+
+        @throws system_error on failure.
+    */
+    void
+    register_buffers(std::vector<
+        boost::asio::mutable_buffer> const& buffers);
+
+    /** Provide buffers for multishot receive.
+
+        This creates a ring of `count` buffers of `size` bytes each,
+        from which the kernel takes buffers for streams which have
+        enabled @ref uring_stream::multishot. The buffers are shared
+        by all streams using the service. It may be called once.
+
+        @param count The number of buffers. This must be a power
+        of two no greater than 32768.
+
+        @param size The size of each buffer.
+
+        @throws system_error on failure.
+    */
+    void
+    provide_buffers(std::size_t count, std::size_t size);
+
+private:
+    io_uring_sqe*
+    get_sqe(detail::uring_op& op);
+
+    void
+    flush();
+
+    void
+    wait();
+
+    void
+    on_event(error_code const& ec);
+
+    int
+    find_fixed(void const* p, std::size_t n) const;
+};
+
+//------------------------------------------------------------------------------
+
+/** A stream socket whose operations are performed using io_uring.
+
+    This wraps a connected socket descriptor. Asynchronous reads and
+    writes are submitted to the @ref uring_service instead of waiting
+    for readiness with the io_service's reactor and then performing
+    the transfer, saving a system call per operation. The class meets
+    the requirements of @b `AsyncStream` and @b `SyncStream`, so it may
+    be used as the next layer of @ref http and @ref websocket objects
+    without changes to their code.
+
+    Single-buffer reads are performed with `IORING_OP_RECV`, or with
+    `IORING_OP_READ_FIXED` when the buffer is registered with the
+    service. Reads into several buffers use one `IORING_OP_RECVMSG`.
+    Writes use `IORING_OP_SEND` or `IORING_OP_SENDMSG` with
+    `MSG_NOSIGNAL`.
+
+    When @ref multishot is enabled, one multishot receive stays armed
+    for the stream and the kernel fills buffers from the service's
+    provided buffer ring as data arrives. Reads are then completed
+    from the received data without submitting anything.
+
+    Thread Safety:
+        @e Distinct @e objects: Safe.@n
+        @e Shared @e objects: Unsafe.
+
+    To use the stream as the next layer of a @ref websocket::stream,
+    include `<beast/websocket/uring.hpp>`, which provides the
+    teardown functions.
+
+    @note Closing the stream shuts down the socket. Pending reads
+    complete with `boost::asio::error::eof` and pending writes
+    with an error, instead of `operation_aborted`.
+
+    @note This header is not included by `<beast/core.hpp>`. It
+    requires Linux kernel headers 6.0 or later.
+*/
+class uring_stream
+{
+    struct io_op_base;
+    class rx_op;
+
+    template<class Handler>
+    class io_op;
+
+    uring_service* svc_;
+    int fd_ = -1;
+    bool multishot_ = false;
+    rx_op* rx_ = nullptr;           // armed multishot receive
+    io_op_base* rd_ = nullptr;      // read waiting for received data
+    streambuf rx_buf_;              // received data not yet read
+    error_code rx_ec_;              // error from multishot receive
+
+public:
+    /** Destructor.
+
+        The socket is closed if it is open.
+    */
+    ~uring_stream();
+
+    /** Move constructor.
+
+        @note The moved-from stream must not have pending
+        reads or writes.
+    */
+    uring_stream(uring_stream&& other);
+
+    uring_stream& operator=(uring_stream&&) = delete;
+    uring_stream(uring_stream const&) = delete;
+    uring_stream& operator=(uring_stream const&) = delete;
+
+    /** Construct a stream without a socket.
+
+        @param svc The service which performs operations. It
+        must remain valid for the lifetime of the stream.
+    */
+    explicit
+    uring_stream(uring_service& svc)
+        : svc_(&svc)
+    {
+    }
+
+    /** Construct a stream which owns a connected socket.
+
+        @param svc The service which performs operations. It
+        must remain valid for the lifetime of the stream.
+
+        @param fd A connected stream socket descriptor. The stream
+        takes ownership and closes the descriptor when done.
+    */
+    uring_stream(uring_service& svc, int fd)
+        : svc_(&svc)
+        , fd_(fd)
+    {
+    }
+
+    /// Return the io_service associated with the stream.
+    boost::asio::io_service&
+    get_io_service()
+    {
+        return svc_->get_io_service();
+    }
+
+    /// Return the service associated with the stream.
+    uring_service&
+    service()
+    {
+        return *svc_;
+    }
+
+    /// Return the socket descriptor, or -1 if there is none.
+    int
+    native_handle() const
+    {
+        return fd_;
+    }
+
+    /// Return `true` if the stream owns a socket.
+    bool
+    is_open() const
+    {
+        return fd_ != -1;
+    }
+
+    /** Take ownership of a connected socket.
+
+        Any socket currently owned is closed first.
+    */
+    void
+    assign(int fd);
+
+    /// Shut down and close the socket.
+    void
+    close();
+
+    /** Disable sends or receives on the socket.
+
+        @param what Determines what types of operation
+        will no longer be allowed.
+
+        @param ec Set to the error, if any occurred.
+    */
+    void
+    shutdown(boost::asio::socket_base::shutdown_type what,
+        error_code& ec);
+
+    /** Set whether reads use a multishot receive.
+
+        This requires buffers given to the service with
+        @ref uring_service::provide_buffers.
+
+        @param value `true` to enable multishot receive.
+    */
+    void
+    multishot(bool value)
+    {
+        multishot_ = value;
+    }
+
+    /** Read some data from the stream.
+
+        @throws system_error on failure.
+    */
+    template<class MutableBufferSequence>
+    std::size_t
+    read_some(MutableBufferSequence const& buffers);
+
+    /// Read some data from the stream.
+    template<class MutableBufferSequence>
+    std::size_t
+    read_some(MutableBufferSequence const& buffers,
+        error_code& ec);
+
+    /** Write some data to the stream.
+
+        @throws system_error on failure.
+    */
+    template<class ConstBufferSequence>
+    std::size_t
+    write_some(ConstBufferSequence const& buffers);
+
+    /// Write some data to the stream.
+    template<class ConstBufferSequence>
+    std::size_t
+    write_some(ConstBufferSequence const& buffers,
+        error_code& ec);
+
+    /** Start an asynchronous read.
+
+        @param buffers The buffers to read into. Up to 16 buffers
+        of the sequence are used in one operation.
+
+        @param handler The handler to be called when the read
+        completes. The equivalent function signature of the
+        handler must be:
+        @code void handler(
+            error_code const& error,        // result of operation
+            std::size_t bytes_transferred   // number of bytes read
+        ); @endcode
+    */
+    template<class MutableBufferSequence, class ReadHandler>
+#if GENERATING_DOCS
+    void_or_deduced
+#else
+    typename async_completion<
+        ReadHandler, void(error_code, std::size_t)>::result_type
+#endif
+    async_read_some(MutableBufferSequence const& buffers,
+        ReadHandler&& handler);
+
+    /** Start an asynchronous write.
+
+        @param buffers The buffers to write. Up to 16 buffers
+        of the sequence are used in one operation.
+
+        @param handler The handler to be called when the write
+        completes. The equivalent function signature of the
+        handler must be:
+        @code void handler(
+            error_code const& error,        // result of operation
+            std::size_t bytes_transferred   // number of bytes written
+        ); @endcode
+    */
+    template<class ConstBufferSequence, class WriteHandler>
+#if GENERATING_DOCS
+    void_or_deduced
+#else
+    typename async_completion<
+        WriteHandler, void(error_code, std::size_t)>::result_type
+#endif
+    async_write_some(ConstBufferSequence const& buffers,
+        WriteHandler&& handler);
+
+private:
+    template<class Handler, class BufferSequence>
+    io_op<Handler>*
+    make_op(Handler& handler,
+        BufferSequence const& buffers, bool read);
+
+    void
+    start_read(io_op_base& op);
+
+    void
+    start_write(io_op_base& op);
+
+    void
+    arm();
+
+    io_op_base*
+    on_receive(int res, unsigned flags, int& result);
+
+    std::size_t
+    take(detail::uring_buffers& b);
+
+    void
+    wait(short events, error_code& ec);
+};
+
+} // beast
+
+#include <beast/core/impl/uring_stream.ipp>
+
+#endif
+
+#endif
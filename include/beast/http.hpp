@@ -11,6 +11,7 @@
 #include <beast/http/basic_headers.hpp>
 #include <beast/http/basic_parser_v1.hpp>
 #include <beast/http/body_type.hpp>
+#include <beast/http/date.hpp>
 #include <beast/http/empty_body.hpp>
 #include <beast/http/headers.hpp>
 #include <beast/http/message.hpp>
@@ -21,6 +22,7 @@
 #include <beast/http/reason.hpp>
 #include <beast/http/resume_context.hpp>
 #include <beast/http/rfc7230.hpp>
+#include <beast/http/rfc7233.hpp>
 #include <beast/http/streambuf_body.hpp>
 #include <beast/http/string_body.hpp>
 #include <beast/http/write.hpp>
@@ -0,0 +1,33 @@
+//
+// Copyright (c) 2013-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BEAST_HTTP_CONTENT_CODING_HPP
+#define BEAST_HTTP_CONTENT_CODING_HPP
+
+namespace beast {
+namespace http {
+
+/** The content codings supported by @ref deflate_body and @ref inflate_body.
+
+    These correspond to values of the Content-Encoding field.
+*/
+enum class content_coding
+{
+    /// The body is sent unmodified
+    identity,
+
+    /// The body is a zlib stream, "Content-Encoding: deflate"
+    deflate,
+
+    /// The body is a gzip stream, "Content-Encoding: gzip"
+    gzip
+};
+
+} // http
+} // beast
+
+#endif
@@ -0,0 +1,147 @@
+//
+// Copyright (c) 2013-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BEAST_HTTP_DATE_HPP
+#define BEAST_HTTP_DATE_HPP
+
+#include <boost/utility/string_ref.hpp>
+#include <cstdint>
+#include <ctime>
+#include <string>
+
+namespace beast {
+namespace http {
+
+namespace detail {
+
+// Size of an IMF-fixdate, rfc7231 7.1.1.1
+std::size_t constexpr date_size = 29;
+
+// Writes the IMF-fixdate for t, without using the C
+// library's time conversions, which are not reentrant.
+inline
+void
+format_date(char* dest, std::time_t t)
+{
+    static char const* const days[] = {
+        "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat" };
+    static char const* const months[] = {
+        "Jan", "Feb", "Mar", "Apr", "May", "Jun",
+        "Jul", "Aug", "Sep", "Oct", "Nov", "Dec" };
+    auto const put2 =
+        [](char* p, int v)
+        {
+            p[0] = static_cast<char>('0' + v / 10);
+            p[1] = static_cast<char>('0' + v % 10);
+        };
+    std::int64_t secs = t;
+    std::int64_t z = secs / 86400;
+    secs -= z * 86400;
+    if(secs < 0)
+    {
+        secs += 86400;
+        --z;
+    }
+    // 1970-01-01 was a Thursday
+    auto const wd = static_cast<int>((z % 7 + 11) % 7);
+    // days to civil date, see
+    // http://howardhinnant.github.io/date_algorithms.html
+    z += 719468;
+    auto const era = (z >= 0 ? z : z - 146096) / 146097;
+    auto const doe = z - era * 146097;
+    auto const yoe = (doe - doe / 1460 +
+        doe / 36524 - doe / 146096) / 365;
+    auto const doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    auto const mp = (5 * doy + 2) / 153;
+    auto const d = static_cast<int>(doy - (153 * mp + 2) / 5 + 1);
+    auto const m = static_cast<int>(mp < 10 ? mp + 3 : mp - 9);
+    auto const y = static_cast<int>(yoe + era * 400 + (m <= 2));
+    auto const s = static_cast<int>(secs);
+    // "Sun, 06 Nov 1994 08:49:37 GMT"
+    auto p = dest;
+    p[0] = days[wd][0]; p[1] = days[wd][1]; p[2] = days[wd][2];
+    p[3] = ','; p[4] = ' ';
+    put2(p + 5, d);
+    p[7] = ' ';
+    p[8] = months[m - 1][0]; p[9] = months[m - 1][1];
+    p[10] = months[m - 1][2]; p[11] = ' ';
+    put2(p + 12, (y / 100) % 100);
+    put2(p + 14, y % 100);
+    p[16] = ' ';
+    put2(p + 17, s / 3600);
+    p[19] = ':';
+    put2(p + 20, (s / 60) % 60);
+    p[22] = ':';
+    put2(p + 23, s % 60);
+    p[25] = ' '; p[26] = 'G'; p[27] = 'M'; p[28] = 'T';
+}
+
+class date_cache
+{
+    std::time_t t_ = 0;
+    char buf_[date_size];
+
+public:
+    date_cache()
+    {
+        format_date(buf_, t_);
+    }
+
+    boost::string_ref
+    get()
+    {
+        auto const now = std::time(nullptr);
+        if(now != t_)
+        {
+            t_ = now;
+            format_date(buf_, t_);
+        }
+        return {buf_, date_size};
+    }
+};
+
+} // detail
+
+/** Returns a time formatted for the Date field.
+
+    The time is formatted as an IMF-fixdate, for example
+    "Sun, 06 Nov 1994 08:49:37 GMT".
+
+    @param t The time to format, in seconds since the epoch.
+*/
+inline
+std::string
+format_date(std::time_t t)
+{
+    char buf[detail::date_size];
+    detail::format_date(buf, t);
+    return std::string(buf, sizeof(buf));
+}
+
+/** Returns the current time formatted for the Date field.
+
+    Each thread keeps its own copy of the formatted string, which
+    is rendered again only when the time has advanced by at least
+    one second since the previous call on that thread. No
+    synchronization or memory allocation takes place.
+
+    @return A string holding the IMF-fixdate for the current time.
+    The string remains valid until the next call to this function
+    on the same thread.
+*/
+inline
+boost::string_ref
+current_date()
+{
+    static thread_local detail::date_cache cache;
+    return cache.get();
+}
+
+} // http
+} // beast
+
+#endif
@@ -0,0 +1,424 @@
+//
+// Copyright (c) 2013-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BEAST_HTTP_DEFLATE_BODY_HPP
+#define BEAST_HTTP_DEFLATE_BODY_HPP
+
+#include <beast/http/body_type.hpp>
+#include <beast/http/content_coding.hpp>
+#include <beast/http/message_v1.hpp>
+#include <beast/http/resume_context.hpp>
+#include <beast/http/rfc7230.hpp>
+#include <beast/http/detail/has_content_length.hpp>
+#include <beast/core/error.hpp>
+#include <beast/core/streambuf.hpp>
+#include <beast/core/detail/ci_char_traits.hpp>
+#include <boost/asio/buffer.hpp>
+#include <boost/logic/tribool.hpp>
+#include <boost/optional.hpp>
+#include <boost/utility/string_ref.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <zlib.h>
+
+namespace beast {
+namespace http {
+
+namespace detail {
+
+template<class Writer>
+boost::optional<std::uint64_t>
+writer_content_length(Writer const& w, std::true_type)
+{
+    return w.content_length();
+}
+
+template<class Writer>
+boost::optional<std::uint64_t>
+writer_content_length(Writer const&, std::false_type)
+{
+    return boost::none;
+}
+
+// Returns a qvalue in thousandths, rfc7231 5.3.1
+inline
+int
+parse_qvalue(boost::string_ref const& s)
+{
+    if(s.empty() || s[0] == '1')
+        return 1000;
+    if(s[0] != '0')
+        return 0;
+    int q = 0;
+    int scale = 100;
+    for(std::size_t i = 2; i < s.size() && scale > 0; ++i)
+    {
+        if(s[i] < '0' || s[i] > '9')
+            break;
+        q += (s[i] - '0') * scale;
+        scale /= 10;
+    }
+    return q;
+}
+
+} // detail
+
+/** A Body adapter which compresses another Body on the fly.
+
+    The wrapped body is produced by its own writer, and the buffers
+    it provides are deflated as they are produced. Since the size of
+    the compressed output is not known in advance, the message is
+    sent chunk-encoded when compression is applied. When the coding
+    is `content_coding::identity` the wrapped body is sent unmodified
+    and with its own Content-Length, if it has one.
+
+    The coding is normally chosen by calling @ref negotiate_encoding
+    with the request before calling @ref prepare on the response.
+
+    Meets the requirements of @b `Body`.
+
+    @note The zlib library must be linked with the program.
+
+    @tparam Body The body to compress. This must meet the
+    requirements of @b `WritableBody`.
+*/
+template<class Body>
+struct deflate_body
+{
+    /// The type of the `message::body` member
+    class value_type
+    {
+        friend struct deflate_body;
+
+        // Holds the wrapped body, so that
+        // its writer can be constructed.
+        message<false, Body,
+            basic_headers<std::allocator<char>>> m_;
+
+    public:
+        /// The content coding applied to the body.
+        content_coding coding = content_coding::identity;
+
+        /// The zlib compression level, from 0 to 9.
+        int level = Z_DEFAULT_COMPRESSION;
+
+        /** Bodies known to be smaller than this are not compressed.
+
+            This is used by @ref negotiate_encoding.
+        */
+        std::uint64_t threshold = 1024;
+
+        /// Returns the wrapped body.
+        typename Body::value_type&
+        body()
+        {
+            return m_.body;
+        }
+
+        /// Returns the wrapped body.
+        typename Body::value_type const&
+        body() const
+        {
+            return m_.body;
+        }
+
+        /** Returns the size of the uncompressed body.
+
+            A writer for the wrapped body is constructed and
+            initialized to obtain the size. If the writer cannot
+            report the size ahead of time, or its initialization
+            fails, an empty optional is returned.
+        */
+        boost::optional<std::uint64_t>
+        size() const
+        {
+            typename Body::writer w(m_);
+            error_code ec;
+            w.init(ec);
+            if(ec)
+                return boost::none;
+            return detail::writer_content_length(w,
+                detail::has_content_length<
+                    typename Body::writer>{});
+        }
+    };
+
+#if GENERATING_DOCS
+private:
+#endif
+
+    class writer
+    {
+        class deflate_lambda
+        {
+            writer& self_;
+            error_code& ec_;
+
+        public:
+            deflate_lambda(writer& self, error_code& ec)
+                : self_(self)
+                , ec_(ec)
+            {
+            }
+
+            template<class ConstBufferSequence>
+            void
+            operator()(ConstBufferSequence const& buffers)
+            {
+                using boost::asio::buffer_cast;
+                using boost::asio::buffer_size;
+                for(auto const& b : buffers)
+                {
+                    self_.compress(buffer_cast<void const*>(b),
+                        buffer_size(b), Z_NO_FLUSH, ec_);
+                    if(ec_)
+                        break;
+                }
+            }
+        };
+
+        // Resumes the write operation when the
+        // wrapped writer resumes.
+        class resume_lambda
+        {
+            writer& self_;
+
+        public:
+            explicit
+            resume_lambda(writer& self)
+                : self_(self)
+            {
+            }
+
+            void
+            operator()()
+            {
+                self_.resume_();
+            }
+        };
+
+        value_type const& body_;
+        typename Body::writer w_;
+        resume_context resume_;
+        z_stream zs_;
+        bool zinit_ = false;
+        bool done_ = false;
+        streambuf sb_;
+
+    public:
+        writer(writer const&) = delete;
+        writer& operator=(writer const&) = delete;
+
+        template<bool isRequest, class Headers>
+        explicit
+        writer(message<isRequest,
+                deflate_body, Headers> const& m)
+            : body_(m.body)
+            , w_(m.body.m_)
+        {
+        }
+
+        ~writer()
+        {
+            if(zinit_)
+                deflateEnd(&zs_);
+        }
+
+        void
+        init(error_code& ec)
+        {
+            w_.init(ec);
+            if(ec || body_.coding == content_coding::identity)
+                return;
+            zs_.zalloc = Z_NULL;
+            zs_.zfree = Z_NULL;
+            zs_.opaque = Z_NULL;
+            zs_.next_in = Z_NULL;
+            zs_.avail_in = 0;
+            // 16 is added to the window bits to get a gzip wrapper
+            auto const windowBits =
+                body_.coding == content_coding::gzip ?
+                    15 + 16 : 15;
+            if(deflateInit2(&zs_, body_.level, Z_DEFLATED,
+                windowBits, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+            {
+                ec = boost::system::errc::make_error_code(
+                    boost::system::errc::not_enough_memory);
+                return;
+            }
+            zinit_ = true;
+        }
+
+        boost::optional<std::uint64_t>
+        content_length() const
+        {
+            if(body_.coding != content_coding::identity)
+                return boost::none;
+            return detail::writer_content_length(w_,
+                detail::has_content_length<
+                    typename Body::writer>{});
+        }
+
+        template<class Write>
+        boost::tribool
+        operator()(resume_context&& resume,
+            error_code& ec, Write&& write)
+        {
+            if(body_.coding == content_coding::identity)
+                return w_(std::move(resume), ec,
+                    std::forward<Write>(write));
+            // The previous output was sent
+            sb_.consume(sb_.size());
+            // Pull from the wrapped body until zlib
+            // produces output or the body is finished.
+            // Each call gets its own resume context,
+            // which resumes the caller's.
+            resume_ = std::move(resume);
+            while(sb_.size() == 0 && ! done_)
+            {
+                auto const result = w_(
+                    resume_context{resume_lambda{*this}},
+                        ec, deflate_lambda{*this, ec});
+                if(ec)
+                    break;
+                if(boost::indeterminate(result))
+                    return result;
+                if(result)
+                {
+                    done_ = true;
+                    compress(nullptr, 0, Z_FINISH, ec);
+                    if(ec)
+                        break;
+                }
+            }
+            // Not suspended, so the caller's
+            // context is no longer needed.
+            resume_ = resume_context{};
+            if(ec)
+                return true;
+            write(sb_.data());
+            return done_;
+        }
+
+    private:
+        void
+        compress(void const* data, std::size_t size,
+            int flush, error_code& ec)
+        {
+            using boost::asio::buffer_cast;
+            using boost::asio::buffer_size;
+            auto p = reinterpret_cast<Bytef const*>(data);
+            do
+            {
+                auto const n = static_cast<uInt>(std::min<std::size_t>(
+                    size, (std::numeric_limits<uInt>::max)()));
+                zs_.next_in = const_cast<Bytef*>(p);
+                zs_.avail_in = n;
+                p += n;
+                size -= n;
+                do
+                {
+                    std::size_t used = 0;
+                    for(auto const& mb : sb_.prepare(4096))
+                    {
+                        auto const avail =
+                            static_cast<uInt>(buffer_size(mb));
+                        zs_.next_out = buffer_cast<Bytef*>(mb);
+                        zs_.avail_out = avail;
+                        auto const result = ::deflate(&zs_,
+                            size > 0 ? Z_NO_FLUSH : flush);
+                        used += avail - zs_.avail_out;
+                        if(result == Z_STREAM_ERROR)
+                        {
+                            ec = boost::system::errc::make_error_code(
+                                boost::system::errc::io_error);
+                            return;
+                        }
+                        if(zs_.avail_out > 0)
+                            break;
+                    }
+                    sb_.commit(used);
+                }
+                while(zs_.avail_out == 0);
+            }
+            while(size > 0);
+        }
+    };
+};
+
+/** Choose the content coding of a response from its request.
+
+    The Accept-Encoding field of the request is inspected, and the
+    coding of the response body is set to the most preferred coding
+    supported by @ref deflate_body, favoring gzip when the client
+    weighs codings equally. If a coding other than identity is chosen,
+    the Content-Encoding field of the response is set. Responses whose
+    body is known to be smaller than the threshold are left unmodified.
+
+    This function must be called before @ref prepare.
+
+    @param req The request to which the response is sent.
+
+    @param resp The response whose body coding is chosen.
+*/
+template<class ReqBody, class ReqHeaders, class Body, class Headers>
+void
+negotiate_encoding(message_v1<true, ReqBody, ReqHeaders> const& req,
+    message_v1<false, deflate_body<Body>, Headers>& resp)
+{
+    resp.body.coding = content_coding::identity;
+    auto const size = resp.body.size();
+    if(size && *size < resp.body.threshold)
+        return;
+    int gzip = -1;
+    int deflate = -1;
+    int any = -1;
+    for(auto const& e : ext_list{req.headers["Accept-Encoding"]})
+    {
+        int q = 1000;
+        for(auto const& param : e.second)
+            if(beast::detail::ci_equal(param.first, "q"))
+                q = detail::parse_qvalue(param.second);
+        if(beast::detail::ci_equal(e.first, "gzip") ||
+                beast::detail::ci_equal(e.first, "x-gzip"))
+            gzip = q;
+        else if(beast::detail::ci_equal(e.first, "deflate"))
+            deflate = q;
+        else if(e.first == "*")
+            any = q;
+    }
+    if(gzip < 0)
+        gzip = any;
+    if(deflate < 0)
+        deflate = any;
+    if(! resp.headers.exists("Vary"))
+        resp.headers.insert("Vary", "Accept-Encoding");
+    else if(! token_list{resp.headers["Vary"]}.exists(
+            "Accept-Encoding"))
+        resp.headers.replace("Vary",
+            resp.headers["Vary"].to_string() + ", Accept-Encoding");
+    if(gzip <= 0 && deflate <= 0)
+        return;
+    if(gzip >= deflate)
+    {
+        resp.body.coding = content_coding::gzip;
+        resp.headers.replace("Content-Encoding", "gzip");
+    }
+    else
+    {
+        resp.body.coding = content_coding::deflate;
+        resp.headers.replace("Content-Encoding", "deflate");
+    }
+}
+
+} // http
+} // beast
+
+#endif
@@ -8,6 +8,7 @@
 #ifndef BEAST_HTTP_DETAIL_HAS_CONTENT_LENGTH_HPP
 #define BEAST_HTTP_DETAIL_HAS_CONTENT_LENGTH_HPP
 
+#include <boost/optional.hpp>
 #include <cstdint>
 #include <type_traits>
 
@@ -20,7 +21,7 @@ class has_content_length_value
 {
     template<class U, class R = typename std::is_convertible<
         decltype(std::declval<U>().content_length()),
-            std::uint64_t>>
+            boost::optional<std::uint64_t>>>
     static R check(int);
     template <class>
     static std::false_type check(...);
@@ -8,6 +8,7 @@
 #ifndef BEAST_HTTP_IMPL_MESSAGE_V1_IPP
 #define BEAST_HTTP_IMPL_MESSAGE_V1_IPP
 
+#include <beast/http/date.hpp>
 #include <beast/http/rfc7230.hpp>
 #include <beast/http/detail/has_content_length.hpp>
 #include <boost/optional.hpp>
@@ -48,6 +49,7 @@ struct prepare_info
 {
     boost::optional<connection> connection_value;
     boost::optional<std::uint64_t> content_length;
+    bool date = false;
 };
 
 template<bool isRequest, class Body, class Headers>
@@ -67,6 +69,15 @@ prepare_option(prepare_info& pi,
     pi.connection_value = value;
 }
 
+template<bool isRequest, class Body, class Headers>
+void
+prepare_option(prepare_info& pi,
+    message_v1<isRequest, Body, Headers>& msg,
+        date value)
+{
+    pi.date = value == date::now;
+}
+
 template<
     bool isRequest, class Body, class Headers,
     class Opt, class... Opts>
@@ -170,6 +181,9 @@ prepare(message_v1<isRequest, Body, Headers>& msg,
         }
     }
 
+    if(pi.date && ! msg.headers.exists("Date"))
+        msg.headers.insert("Date", current_date());
+
     // rfc7230 6.7.
     if(msg.version < 11 && token_list{
             msg.headers["Connection"]}.exists("upgrade"))
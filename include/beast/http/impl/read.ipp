@@ -11,8 +11,10 @@
 #include <beast/http/concepts.hpp>
 #include <beast/http/parser_v1.hpp>
 #include <beast/core/bind_handler.hpp>
-#include <beast/core/handler_alloc.hpp>
+#include <beast/core/handler_ptr.hpp>
+#include <beast/core/stats_stream.hpp>
 #include <beast/core/stream_concepts.hpp>
+#include <beast/core/trace.hpp>
 #include <cassert>
 
 namespace beast {
@@ -24,33 +26,27 @@ template<class Stream,
     class DynamicBuffer, class Parser, class Handler>
 class parse_op
 {
-    using alloc_type =
-        handler_alloc<char, Handler>;
-
     struct data
     {
         Stream& s;
         DynamicBuffer& db;
         Parser& p;
-        Handler h;
         bool started = false;
         bool cont;
         int state = 0;
 
-        template<class DeducedHandler>
-        data(DeducedHandler&& h_, Stream& s_,
+        data(Handler& handler, Stream& s_,
                 DynamicBuffer& sb_, Parser& p_)
             : s(s_)
             , db(sb_)
             , p(p_)
-            , h(std::forward<DeducedHandler>(h_))
             , cont(boost_asio_handler_cont_helpers::
-                is_continuation(h))
+                is_continuation(handler))
         {
         }
     };
 
-    std::shared_ptr<data> d_;
+    handler_ptr<data, Handler> d_;
 
 public:
     parse_op(parse_op&&) = default;
@@ -58,10 +54,11 @@ public:
 
     template<class DeducedHandler, class... Args>
     parse_op(DeducedHandler&& h, Stream& s, Args&&... args)
-        : d_(std::allocate_shared<data>(alloc_type{h},
-            std::forward<DeducedHandler>(h), s,
-                std::forward<Args>(args)...))
+        : d_(std::forward<DeducedHandler>(h), s,
+                std::forward<Args>(args)...)
     {
+        beast::detail::trace(&*d_,
+            "http::parse_op", trace_kind::begin);
         (*this)(error_code{}, 0, false);
     }
 
@@ -74,7 +71,7 @@ public:
         std::size_t size, parse_op* op)
     {
         return boost_asio_handler_alloc_helpers::
-            allocate(size, op->d_->h);
+            allocate(size, op->d_.handler());
     }
 
     friend
@@ -82,7 +79,7 @@ public:
         void* p, std::size_t size, parse_op* op)
     {
         return boost_asio_handler_alloc_helpers::
-            deallocate(p, size, op->d_->h);
+            deallocate(p, size, op->d_.handler());
     }
 
     friend
@@ -96,7 +93,7 @@ public:
     void asio_handler_invoke(Function&& f, parse_op* op)
     {
         return boost_asio_handler_invoke_helpers::
-            invoke(f, op->d_->h);
+            invoke(f, op->d_.handler());
     }
 };
 
@@ -110,6 +107,8 @@ operator()(error_code ec, std::size_t bytes_transferred, bool again)
     d.cont = d.cont || again;
     while(d.state != 99)
     {
+        beast::detail::trace(&d,
+            "http::parse_op", trace_kind::step, d.state);
         switch(d.state)
         {
         case 0:
@@ -173,6 +172,8 @@ operator()(error_code ec, std::size_t bytes_transferred, bool again)
                 break;
             }
             d.db.commit(bytes_transferred);
+            if(auto const p = beast::detail::stats_of(d.s))
+                p->on_read_buffer(d.db.size());
             auto const used = d.p.write(d.db.data(), ec);
             if(ec)
             {
@@ -194,7 +195,12 @@ operator()(error_code ec, std::size_t bytes_transferred, bool again)
         }
         }
     }
-    d.h(ec);
+    if(! ec)
+        if(auto const p = beast::detail::stats_of(d.s))
+            p->on_message_in();
+    beast::detail::trace(&d,
+        "http::parse_op", trace_kind::end, ec.value());
+    d_.invoke(ec);
 }
 
 //------------------------------------------------------------------------------
@@ -204,9 +210,6 @@ template<class Stream, class DynamicBuffer,
         class Handler>
 class read_op
 {
-    using alloc_type =
-        handler_alloc<char, Handler>;
-
     using parser_type =
         parser_v1<isRequest, Body, Headers>;
 
@@ -219,25 +222,22 @@ class read_op
         DynamicBuffer& db;
         message_type& m;
         parser_type p;
-        Handler h;
         bool started = false;
         bool cont;
         int state = 0;
 
-        template<class DeducedHandler>
-        data(DeducedHandler&& h_, Stream& s_,
+        data(Handler& handler, Stream& s_,
                 DynamicBuffer& sb_, message_type& m_)
             : s(s_)
             , db(sb_)
             , m(m_)
-            , h(std::forward<DeducedHandler>(h_))
             , cont(boost_asio_handler_cont_helpers::
-                is_continuation(h))
+                is_continuation(handler))
         {
         }
     };
 
-    std::shared_ptr<data> d_;
+    handler_ptr<data, Handler> d_;
 
 public:
     read_op(read_op&&) = default;
@@ -245,10 +245,11 @@ public:
 
     template<class DeducedHandler, class... Args>
     read_op(DeducedHandler&& h, Stream& s, Args&&... args)
-        : d_(std::allocate_shared<data>(alloc_type{h},
-            std::forward<DeducedHandler>(h), s,
-                std::forward<Args>(args)...))
+        : d_(std::forward<DeducedHandler>(h), s,
+                std::forward<Args>(args)...)
     {
+        beast::detail::trace(&*d_,
+            "http::read_op", trace_kind::begin);
         (*this)(error_code{}, false);
     }
 
@@ -260,7 +261,7 @@ public:
         std::size_t size, read_op* op)
     {
         return boost_asio_handler_alloc_helpers::
-            allocate(size, op->d_->h);
+            allocate(size, op->d_.handler());
     }
 
     friend
@@ -268,7 +269,7 @@ public:
         void* p, std::size_t size, read_op* op)
     {
         return boost_asio_handler_alloc_helpers::
-            deallocate(p, size, op->d_->h);
+            deallocate(p, size, op->d_.handler());
     }
 
     friend
@@ -282,7 +283,7 @@ public:
     void asio_handler_invoke(Function&& f, read_op* op)
     {
         return boost_asio_handler_invoke_helpers::
-            invoke(f, op->d_->h);
+            invoke(f, op->d_.handler());
     }
 };
 
@@ -297,6 +298,8 @@ operator()(error_code ec, bool again)
     d.cont = d.cont || again;
     while(! ec && d.state != 99)
     {
+        beast::detail::trace(&d,
+            "http::read_op", trace_kind::step, d.state);
         switch(d.state)
         {
         case 0:
@@ -311,7 +314,9 @@ operator()(error_code ec, bool again)
             break;
         }
     }
-    d.h(ec);
+    beast::detail::trace(&d,
+        "http::read_op", trace_kind::end, ec.value());
+    d_.invoke(ec);
 }
 
 } // detail
@@ -361,6 +366,8 @@ parse(SyncReadStream& stream, DynamicBuffer& dynabuf,
         dynabuf.commit(stream.read_some(
             dynabuf.prepare(read_size_helper(
                 dynabuf, 65536)), ec));
+        if(auto const p = beast::detail::stats_of(stream))
+            p->on_read_buffer(dynabuf.size());
         if(ec && ec != boost::asio::error::eof)
             return;
         if(ec == boost::asio::error::eof)
@@ -376,6 +383,8 @@ parse(SyncReadStream& stream, DynamicBuffer& dynabuf,
             break;
         }
     }
+    if(auto const p = beast::detail::stats_of(stream))
+        p->on_message_in();
 }
 
 template<class AsyncReadStream,
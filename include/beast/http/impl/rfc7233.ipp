@@ -0,0 +1,140 @@
+//
+// Copyright (c) 2013-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BEAST_HTTP_IMPL_RFC7233_IPP
+#define BEAST_HTTP_IMPL_RFC7233_IPP
+
+#include <beast/core/detail/ci_char_traits.hpp>
+#include <beast/http/detail/rfc7230.hpp>
+#include <limits>
+
+namespace beast {
+namespace http {
+
+namespace detail {
+
+// Parse 1*DIGIT, saturating on overflow
+inline
+bool
+parse_range_pos(boost::string_ref::const_iterator& it,
+    boost::string_ref::const_iterator end, std::uint64_t& v)
+{
+    auto const max = (std::numeric_limits<std::uint64_t>::max)();
+    if(it == end || ! is_digit(*it))
+        return false;
+    v = 0;
+    for(;it != end && is_digit(*it); ++it)
+    {
+        std::uint64_t const d = *it - '0';
+        if(v > (max - d) / 10)
+            v = max;
+        else
+            v = 10 * v + d;
+    }
+    return true;
+}
+
+inline
+void
+skip_ows(boost::string_ref::const_iterator& it,
+    boost::string_ref::const_iterator end)
+{
+    while(it != end && (*it == ' ' || *it == '\t'))
+        ++it;
+}
+
+inline
+bool
+parse_ranges(boost::string_ref const& s,
+    std::uint64_t size, std::vector<byte_range>& ranges)
+{
+    auto it = s.begin();
+    auto const end = s.end();
+    skip_ows(it, end);
+    if(end - it < 6 || ! beast::detail::ci_equal(
+            boost::string_ref(&*it, 5), "bytes") || it[5] != '=')
+        return false;
+    it += 6;
+    bool empty = true;
+    for(;;)
+    {
+        skip_ows(it, end);
+        if(it == end)
+            break;
+        if(*it == ',')
+        {
+            // empty list element, rfc7230 section 7
+            ++it;
+            continue;
+        }
+        std::uint64_t first;
+        std::uint64_t last;
+        if(*it == '-')
+        {
+            ++it;
+            std::uint64_t n;
+            if(! parse_range_pos(it, end, n))
+                return false;
+            if(n > 0 && size > 0)
+            {
+                first = n < size ? size - n : 0;
+                last = size - 1;
+                ranges.push_back({first, last});
+            }
+        }
+        else
+        {
+            if(! parse_range_pos(it, end, first))
+                return false;
+            if(it == end || *it != '-')
+                return false;
+            ++it;
+            if(parse_range_pos(it, end, last))
+            {
+                if(last < first)
+                    return false;
+            }
+            else
+            {
+                last = (std::numeric_limits<std::uint64_t>::max)();
+            }
+            if(first < size)
+            {
+                if(last >= size)
+                    last = size - 1;
+                ranges.push_back({first, last});
+            }
+        }
+        empty = false;
+        skip_ows(it, end);
+        if(it == end)
+            break;
+        if(*it != ',')
+            return false;
+        ++it;
+    }
+    return ! empty;
+}
+
+} // detail
+
+inline
+bool
+parse_ranges(boost::string_ref const& s,
+    std::uint64_t size, std::vector<byte_range>& ranges)
+{
+    ranges.clear();
+    if(detail::parse_ranges(s, size, ranges))
+        return true;
+    ranges.clear();
+    return false;
+}
+
+} // http
+} // beast
+
+#endif
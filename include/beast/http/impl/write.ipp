@@ -15,9 +15,11 @@
 #include <beast/core/buffer_cat.hpp>
 #include <beast/core/bind_handler.hpp>
 #include <beast/core/buffer_concepts.hpp>
-#include <beast/core/handler_alloc.hpp>
+#include <beast/core/handler_ptr.hpp>
+#include <beast/core/stats_stream.hpp>
 #include <beast/core/stream_concepts.hpp>
 #include <beast/core/streambuf.hpp>
+#include <beast/core/trace.hpp>
 #include <beast/core/write_dynabuf.hpp>
 #include <boost/asio/write.hpp>
 #include <boost/logic/tribool.hpp>
@@ -122,29 +124,21 @@ template<class Stream, class Handler,
     bool isRequest, class Body, class Headers>
 class write_op
 {
-    using alloc_type =
-        handler_alloc<char, Handler>;
-
     struct data
     {
         Stream& s;
         // VFALCO How do we use handler_alloc in write_preparation?
         write_preparation<
             isRequest, Body, Headers> wp;
-        Handler h;
-        resume_context resume;
-        resume_context copy;
         bool cont;
         int state = 0;
 
-        template<class DeducedHandler>
-        data(DeducedHandler&& h_, Stream& s_,
+        data(Handler& handler, Stream& s_,
                 message_v1<isRequest, Body, Headers> const& m_)
             : s(s_)
             , wp(m_)
-            , h(std::forward<DeducedHandler>(h_))
             , cont(boost_asio_handler_cont_helpers::
-                is_continuation(h))
+                is_continuation(handler))
         {
         }
     };
@@ -203,7 +197,85 @@ class write_op
         }
     };
 
-    std::shared_ptr<data> d_;
+    // Continues the operation on its io_service
+    class resume_op
+    {
+        handler_ptr<data, Handler> d_;
+
+    public:
+        resume_op(resume_op&&) = default;
+        resume_op(resume_op const&) = default;
+
+        explicit
+        resume_op(handler_ptr<data, Handler>&& d)
+            : d_(std::move(d))
+        {
+        }
+
+        void operator()()
+        {
+            write_op self(std::move(d_));
+            self.d_->cont = false;
+            auto& ios = self.d_->s.get_io_service();
+            ios.dispatch(bind_handler(std::move(self),
+                error_code{}, 0, false));
+        }
+
+        friend
+        void* asio_handler_allocate(
+            std::size_t size, resume_op* op)
+        {
+            return boost_asio_handler_alloc_helpers::
+                allocate(size, op->d_.handler());
+        }
+
+        friend
+        void asio_handler_deallocate(
+            void* p, std::size_t size, resume_op* op)
+        {
+            return boost_asio_handler_alloc_helpers::
+                deallocate(p, size, op->d_.handler());
+        }
+
+        friend
+        bool asio_handler_is_continuation(resume_op* op)
+        {
+            return boost_asio_handler_cont_helpers::
+                is_continuation(op->d_.handler());
+        }
+
+        template <class Function>
+        friend
+        void asio_handler_invoke(Function&& f, resume_op* op)
+        {
+            return boost_asio_handler_invoke_helpers::
+                invoke(f, op->d_.handler());
+        }
+    };
+
+    class resume_lambda
+    {
+        handler_ptr<data, Handler> d_;
+
+    public:
+        explicit
+        resume_lambda(handler_ptr<data, Handler> const& d)
+            : d_(d)
+        {
+        }
+
+        void operator()()
+        {
+            // The writer may resume from any thread, for example
+            // a file I/O pool. Only moves of the state are made
+            // here; the operation continues on its io_service,
+            // through the handler's invocation hook.
+            auto& ios = d_->s.get_io_service();
+            ios.post(resume_op{std::move(d_)});
+        }
+    };
+
+    handler_ptr<data, Handler> d_;
 
 public:
     write_op(write_op&&) = default;
@@ -211,27 +283,16 @@ public:
 
     template<class DeducedHandler, class... Args>
     write_op(DeducedHandler&& h, Stream& s, Args&&... args)
-        : d_(std::allocate_shared<data>(alloc_type{h},
-            std::forward<DeducedHandler>(h), s,
-                std::forward<Args>(args)...))
+        : d_(std::forward<DeducedHandler>(h), s,
+                std::forward<Args>(args)...)
     {
-        auto& d = *d_;
-        auto sp = d_;
-        d.resume = {
-            [sp]() mutable
-            {
-                write_op self(std::move(sp));
-                self.d_->cont = false;
-                auto& ios = self.d_->s.get_io_service();
-                ios.dispatch(bind_handler(std::move(self),
-                    error_code{}, 0, false));
-            }};
-        d.copy = d.resume;
+        beast::detail::trace(&*d_,
+            "http::write_op", trace_kind::begin);
         (*this)(error_code{}, 0, false);
     }
 
     explicit
-    write_op(std::shared_ptr<data> d)
+    write_op(handler_ptr<data, Handler> d)
         : d_(std::move(d))
     {
     }
@@ -245,7 +306,7 @@ public:
         std::size_t size, write_op* op)
     {
         return boost_asio_handler_alloc_helpers::
-            allocate(size, op->d_->h);
+            allocate(size, op->d_.handler());
     }
 
     friend
@@ -253,7 +314,7 @@ public:
         void* p, std::size_t size, write_op* op)
     {
         return boost_asio_handler_alloc_helpers::
-            deallocate(p, size, op->d_->h);
+            deallocate(p, size, op->d_.handler());
     }
 
     friend
@@ -267,7 +328,7 @@ public:
     void asio_handler_invoke(Function&& f, write_op* op)
     {
         return boost_asio_handler_invoke_helpers::
-            invoke(f, op->d_->h);
+            invoke(f, op->d_.handler());
     }
 };
 
@@ -281,6 +342,8 @@ operator()(error_code ec, std::size_t, bool again)
     d.cont = d.cont || again;
     while(! ec && d.state != 99)
     {
+        beast::detail::trace(&d,
+            "http::write_op", trace_kind::step, d.state);
         switch(d.state)
         {
         case 0:
@@ -294,14 +357,19 @@ operator()(error_code ec, std::size_t, bool again)
                     std::move(*this), ec, 0, false));
                 return;
             }
+            if(auto const p = beast::detail::stats_of(d.s))
+                p->on_write_buffer(d.wp.sb.size());
             d.state = 1;
             break;
         }
 
         case 1:
         {
+            // The resume context holds a copy of d_, so
+            // the operation stays alive while suspended.
             auto const result = d.wp.w(
-                std::move(d.copy), ec, writef0_lambda{*this});
+                resume_context{resume_lambda{d_}},
+                    ec, writef0_lambda{*this});
             if(ec)
             {
                 // call handler
@@ -313,7 +381,8 @@ operator()(error_code ec, std::size_t, bool again)
             if(boost::indeterminate(result))
             {
                 // suspend
-                d.copy = d.resume;
+                beast::detail::trace(&d,
+                    "http::write_op", trace_kind::wait, 1);
                 return;
             }
             if(result)
@@ -332,7 +401,8 @@ operator()(error_code ec, std::size_t, bool again)
         case 3:
         {
             auto const result = d.wp.w(
-                std::move(d.copy), ec, writef_lambda{*this});
+                resume_context{resume_lambda{d_}},
+                    ec, writef_lambda{*this});
             if(ec)
             {
                 // call handler
@@ -342,7 +412,8 @@ operator()(error_code ec, std::size_t, bool again)
             if(boost::indeterminate(result))
             {
                 // suspend
-                d.copy = d.resume;
+                beast::detail::trace(&d,
+                    "http::write_op", trace_kind::wait, 3);
                 return;
             }
             if(result)
@@ -364,6 +435,8 @@ operator()(error_code ec, std::size_t, bool again)
             return;
 
         case 5:
+            if(auto const p = beast::detail::stats_of(d.s))
+                p->on_message_out();
             if(d.wp.close)
             {
                 // VFALCO TODO Decide on an error code
@@ -373,9 +446,9 @@ operator()(error_code ec, std::size_t, bool again)
             break;
         }
     }
-    d.h(ec);
-    d.resume = {};
-    d.copy = {};
+    beast::detail::trace(&d,
+        "http::write_op", trace_kind::end, ec.value());
+    d_.invoke(ec);
 }
 
 template<class SyncWriteStream, class DynamicBuffer>
@@ -437,6 +510,35 @@ public:
     }
 };
 
+// Blocks a synchronous write while the writer is suspended
+class sync_resume
+{
+    std::mutex m_;
+    std::condition_variable cv_;
+    bool ready_ = false;
+
+public:
+    resume_context
+    get()
+    {
+        return resume_context{
+            [this]
+            {
+                std::lock_guard<std::mutex> lock(m_);
+                ready_ = true;
+                cv_.notify_one();
+            }};
+    }
+
+    void
+    wait()
+    {
+        std::unique_lock<std::mutex> lock(m_);
+        cv_.wait(lock, [&]{ return ready_; });
+        ready_ = false;
+    }
+};
+
 } // detail
 
 //------------------------------------------------------------------------------
@@ -472,30 +574,17 @@ write(SyncWriteStream& stream,
     wp.init(ec);
     if(ec)
         return;
-    std::mutex m;
-    std::condition_variable cv;
-    bool ready = false;
-    resume_context resume{
-        [&]
-        {
-            std::lock_guard<std::mutex> lock(m);
-            ready = true;
-            cv.notify_one();
-        }};
-    auto copy = resume;
-    boost::tribool result = wp.w(std::move(copy),
+    if(auto const p = beast::detail::stats_of(stream))
+        p->on_write_buffer(wp.sb.size());
+    detail::sync_resume resume;
+    boost::tribool result = wp.w(resume.get(),
         ec, detail::writef0_lambda<SyncWriteStream,
             decltype(wp.sb)>{stream, wp.sb, wp.chunked, ec});
     if(ec)
         return;
     if(boost::indeterminate(result))
     {
-        copy = resume;
-        {
-            std::unique_lock<std::mutex> lock(m);
-            cv.wait(lock, [&]{ return ready; });
-            ready = false;
-        }
+        resume.wait();
         boost::asio::write(stream, wp.sb.data(), ec);
         if(ec)
             return;
@@ -506,7 +595,7 @@ write(SyncWriteStream& stream,
     {
         for(;;)
         {
-            result = wp.w(std::move(copy), ec,
+            result = wp.w(resume.get(), ec,
                 detail::writef_lambda<SyncWriteStream>{
                     stream, wp.chunked, ec});
             if(ec)
@@ -515,10 +604,7 @@ write(SyncWriteStream& stream,
                 break;
             if(! result)
                 continue;
-            copy = resume;
-            std::unique_lock<std::mutex> lock(m);
-            cv.wait(lock, [&]{ return ready; });
-            ready = false;
+            resume.wait();
         }
     }
     if(wp.chunked)
@@ -532,6 +618,8 @@ write(SyncWriteStream& stream,
         if(ec)
             return;
     }
+    if(auto const p = beast::detail::stats_of(stream))
+        p->on_message_out();
     if(wp.close)
     {
         // VFALCO TODO Decide on an error code
@@ -0,0 +1,266 @@
+//
+// Copyright (c) 2013-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BEAST_HTTP_INFLATE_BODY_HPP
+#define BEAST_HTTP_INFLATE_BODY_HPP
+
+#include <beast/http/body_type.hpp>
+#include <beast/http/content_coding.hpp>
+#include <beast/http/parse_error.hpp>
+#include <beast/core/error.hpp>
+#include <beast/core/detail/ci_char_traits.hpp>
+#include <boost/utility/string_ref.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <zlib.h>
+
+namespace beast {
+namespace http {
+
+/** A Body adapter which decompresses into another Body on the fly.
+
+    The Content-Encoding field of the message being parsed is
+    inspected when the first octets of the body arrive. If the
+    body is gzip or deflate encoded, it is inflated incrementally
+    as it is received, and the decompressed octets are passed to
+    the reader of the wrapped body. Only one window of decompressed
+    output is held at a time. Otherwise the body is passed through
+    unmodified.
+
+    Bodies with an unsupported Content-Encoding, corrupt compressed
+    data, compressed data which ends before the end of the stream,
+    or which decompress to more than the configured maximum size,
+    fail with an error.
+
+    Meets the requirements of @b `Body`.
+
+    @note The zlib library must be linked with the program.
+
+    @tparam Body The body which receives the decompressed octets.
+    This must meet the requirements of @b `ReadableBody`.
+*/
+template<class Body>
+struct inflate_body
+{
+    /// The type of the `message::body` member
+    class value_type
+    {
+        friend struct inflate_body;
+
+        // Holds the wrapped body, so that
+        // its reader can be constructed.
+        message<false, Body,
+            basic_headers<std::allocator<char>>> m_;
+
+    public:
+        /** The content coding of the received body.
+
+            This is set when the first octets of the body are received.
+        */
+        content_coding coding = content_coding::identity;
+
+        /** The largest permitted size of the decompressed body.
+
+            This limit protects against compression bombs. The
+            default is 16 megabytes.
+        */
+        std::uint64_t max_size = 16 * 1024 * 1024;
+
+        /// Returns the wrapped body.
+        typename Body::value_type&
+        body()
+        {
+            return m_.body;
+        }
+
+        /// Returns the wrapped body.
+        typename Body::value_type const&
+        body() const
+        {
+            return m_.body;
+        }
+    };
+
+#if GENERATING_DOCS
+private:
+#endif
+
+    class reader
+    {
+        using detect_fn = bool(*)(void const*, content_coding&);
+
+        value_type& body_;
+        typename Body::reader r_;
+        detect_fn detect_;
+        void const* headers_;
+        z_stream zs_;
+        std::uint64_t size_ = 0;
+        bool started_ = false;
+        bool zinit_ = false;
+        bool done_ = false;
+
+        // The headers are not yet parsed when the reader is
+        // constructed, so the lookup is deferred to the body.
+        template<class Headers>
+        static
+        bool
+        detect(void const* p, content_coding& coding)
+        {
+            using beast::detail::ci_equal;
+            auto const& h = *static_cast<Headers const*>(p);
+            auto const s = h["Content-Encoding"];
+            if(s.empty() || ci_equal(s, "identity"))
+                coding = content_coding::identity;
+            else if(ci_equal(s, "gzip") || ci_equal(s, "x-gzip"))
+                coding = content_coding::gzip;
+            else if(ci_equal(s, "deflate"))
+                coding = content_coding::deflate;
+            else
+                return false;
+            return true;
+        }
+
+    public:
+        reader(reader const&) = delete;
+        reader& operator=(reader const&) = delete;
+
+        template<bool isRequest, class Headers>
+        explicit
+        reader(message<isRequest,
+                inflate_body, Headers>& m) noexcept
+            : body_(m.body)
+            , r_(m.body.m_)
+            , detect_(&detect<Headers>)
+            , headers_(&m.headers)
+        {
+        }
+
+        ~reader()
+        {
+            if(zinit_)
+                inflateEnd(&zs_);
+        }
+
+        void
+        write(void const* data,
+            std::size_t size, error_code& ec)
+        {
+            if(! started_)
+            {
+                started_ = true;
+                start(ec);
+                if(ec)
+                    return;
+            }
+            if(body_.coding == content_coding::identity)
+                return r_.write(data, size, ec);
+            if(done_)
+            {
+                // data after the end of the compressed stream
+                ec = parse_error::bad_content_encoding;
+                return;
+            }
+            auto p = static_cast<Bytef const*>(data);
+            while(size > 0)
+            {
+                auto const n = static_cast<uInt>(std::min<std::size_t>(
+                    size, (std::numeric_limits<uInt>::max)()));
+                zs_.next_in = const_cast<Bytef*>(p);
+                zs_.avail_in = n;
+                p += n;
+                size -= n;
+                inflate(ec);
+                if(ec)
+                    return;
+            }
+        }
+
+        void
+        finish(error_code& ec)
+        {
+            // A body which ends before the compressed
+            // stream does was truncated.
+            if(started_ && body_.coding !=
+                    content_coding::identity && ! done_)
+                ec = parse_error::bad_content_encoding;
+        }
+
+    private:
+        void
+        start(error_code& ec)
+        {
+            if(! detect_(headers_, body_.coding))
+            {
+                ec = parse_error::bad_content_encoding;
+                return;
+            }
+            if(body_.coding == content_coding::identity)
+                return;
+            zs_.zalloc = Z_NULL;
+            zs_.zfree = Z_NULL;
+            zs_.opaque = Z_NULL;
+            zs_.next_in = Z_NULL;
+            zs_.avail_in = 0;
+            // 32 is added to the window bits to
+            // detect the zlib or gzip wrapper.
+            if(inflateInit2(&zs_, 15 + 32) != Z_OK)
+            {
+                ec = boost::system::errc::make_error_code(
+                    boost::system::errc::not_enough_memory);
+                return;
+            }
+            zinit_ = true;
+        }
+
+        void
+        inflate(error_code& ec)
+        {
+            char buf[4096];
+            for(;;)
+            {
+                zs_.next_out = reinterpret_cast<Bytef*>(buf);
+                zs_.avail_out = sizeof(buf);
+                auto const result = ::inflate(&zs_, Z_NO_FLUSH);
+                if(result != Z_OK && result != Z_STREAM_END &&
+                    result != Z_BUF_ERROR)
+                {
+                    ec = parse_error::bad_content_encoding;
+                    return;
+                }
+                auto const n = sizeof(buf) - zs_.avail_out;
+                size_ += n;
+                if(size_ > body_.max_size)
+                {
+                    ec = parse_error::body_too_big;
+                    return;
+                }
+                if(n > 0)
+                {
+                    r_.write(buf, n, ec);
+                    if(ec)
+                        return;
+                }
+                if(result == Z_STREAM_END)
+                {
+                    done_ = true;
+                    if(zs_.avail_in > 0)
+                        ec = parse_error::bad_content_encoding;
+                    return;
+                }
+                if(zs_.avail_in == 0 && zs_.avail_out > 0)
+                    return;
+            }
+        }
+    };
+};
+
+} // http
+} // beast
+
+#endif
@@ -110,11 +110,26 @@ enum class connection
     upgrade
 };
 
+/** HTTP/1 Date prepare options.
+
+    @note These values are used with @ref prepare.
+*/
+enum class date
+{
+    /** Specify a Date field holding the current time.
+
+        The field is only added if the message does not have one.
+        The value comes from @ref current_date, so it is formatted
+        at most once per second on each thread.
+    */
+    now
+};
+
 /** Prepare a HTTP/1 message.
 
     This function will adjust the Content-Length, Transfer-Encoding,
-    and Connection headers of the message based on the properties of
-    the body and the options passed in.
+    Connection, and Date headers of the message based on the
+    properties of the body and the options passed in.
 
     @param msg The message to prepare. The headers may be modified.
 
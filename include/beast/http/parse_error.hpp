@@ -39,6 +39,7 @@ enum class parse_error
     headers_too_big,
     body_too_big,
     short_read,
+    bad_content_encoding,
 
     general
 };
@@ -114,6 +115,9 @@ public:
         case parse_error::short_read:
             return "unexpected end of data";
 
+        case parse_error::bad_content_encoding:
+            return "bad Content-Encoding";
+
         default:
             return "parse error";
         }
@@ -33,6 +33,20 @@ struct parser_response
     std::string reason_;
 };
 
+// Determine if a reader has finish(error_code&)
+template<class T>
+class has_finish
+{
+    template<class U, class R = decltype(
+        std::declval<U>().finish(std::declval<error_code&>()),
+            std::true_type{})>
+    static R check(int);
+    template<class>
+    static std::false_type check(...);
+public:
+    using type = decltype(check<T>(0));
+};
+
 } // detail
 
 /** A parser for producing HTTP/1 messages.
@@ -196,7 +210,18 @@ private:
         r_.write(s.data(), s.size(), ec);
     }
 
-    void on_complete(error_code&)
+    void on_complete(error_code& ec)
+    {
+        finish(ec, typename detail::has_finish<
+            typename message_type::body_type::reader>::type{});
+    }
+
+    void finish(error_code& ec, std::true_type)
+    {
+        r_.finish(ec);
+    }
+
+    void finish(error_code&, std::false_type)
     {
     }
 };
@@ -8,7 +8,9 @@
 #ifndef BEAST_HTTP_RESUME_CONTEXT_HPP
 #define BEAST_HTTP_RESUME_CONTEXT_HPP
 
-#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
 
 namespace beast {
 namespace http {
@@ -24,9 +26,168 @@ namespace http {
     the resume context using a move. Then, it returns `boost::indeterminate`
     to indicate that the write operation should suspend. Later, the calling
     code invokes the resume function and the write operation continues
-    from where it left off.
+    from where it left off. The resume context may be invoked from
+    any thread; the write operation continues on the `io_service`
+    associated with its stream.
+
+    The resume context is move-only. The function it holds is stored
+    inside the object, which has room for a few pointers, so neither
+    constructing a resume context nor suspending a write operation
+    allocates memory.
 */
-using resume_context = std::function<void(void)>;
+class resume_context
+{
+    struct base
+    {
+        base() = default;
+        base(base&&) = default;
+        virtual ~base() = default;
+        virtual void move(void* p) = 0;
+        virtual void operator()() = 0;
+    };
+
+    template<class F>
+    struct holder : base
+    {
+        F f;
+
+        holder(holder&&) = default;
+
+        template<class U>
+        explicit
+        holder(U&& u)
+            : f(std::forward<U>(u))
+        {
+        }
+
+        void
+        move(void* p) override
+        {
+            ::new(p) holder(std::move(*this));
+        }
+
+        void
+        operator()() override
+        {
+            F f_(std::move(f));
+            this->~holder();
+            // invocation of f_() can
+            // assign a new resume context.
+            f_();
+        }
+    };
+
+    struct exemplar
+    {
+        void* _[2];
+        void operator()(){}
+    };
+
+    using buf_type = char[sizeof(holder<exemplar>)];
+
+    base* base_ = nullptr;
+    alignas(holder<exemplar>) buf_type buf_;
+
+public:
+    /// Destructor.
+    ~resume_context()
+    {
+        if(base_)
+            base_->~base();
+    }
+
+    /// Default constructor. The resume context will be empty.
+    resume_context() = default;
+
+    /** Move constructor.
+
+        After the move, `other` will be empty.
+    */
+    resume_context(resume_context&& other)
+    {
+        if(other.base_)
+        {
+            base_ = reinterpret_cast<base*>(&buf_[0]);
+            other.base_->move(buf_);
+            other.base_->~base();
+            other.base_ = nullptr;
+        }
+    }
+
+    /** Move assignment.
+
+        Any function held by this object is destroyed without
+        being called. After the move, `other` will be empty.
+    */
+    resume_context&
+    operator=(resume_context&& other)
+    {
+        if(this == &other)
+            return *this;
+        if(base_)
+        {
+            base_->~base();
+            base_ = nullptr;
+        }
+        if(other.base_)
+        {
+            base_ = reinterpret_cast<base*>(&buf_[0]);
+            other.base_->move(buf_);
+            other.base_->~base();
+            other.base_ = nullptr;
+        }
+        return *this;
+    }
+
+    /** Construct a resume context holding a function.
+
+        The function must be invocable with no arguments, and
+        small enough to fit in the storage of the resume context,
+        which holds at least two pointers.
+
+        @param f The function to store.
+    */
+#if GENERATING_DOCS
+    template<class F>
+#else
+    template<class F, class = typename std::enable_if<
+        ! std::is_same<typename std::decay<F>::type,
+            resume_context>::value>::type>
+#endif
+    explicit
+    resume_context(F&& f)
+    {
+        using type = holder<typename std::decay<F>::type>;
+        static_assert(sizeof(buf_type) >= sizeof(type),
+            "function too large for resume_context");
+        ::new(buf_) type(std::forward<F>(f));
+        base_ = reinterpret_cast<base*>(&buf_[0]);
+    }
+
+    /// Returns `true` if the resume context holds a function.
+    explicit
+    operator bool() const
+    {
+        return base_ != nullptr;
+    }
+
+    /** Resume the write operation.
+
+        The stored function is removed from this object before it is
+        called, leaving the resume context empty. If the resume
+        context is empty, the call has no effect.
+    */
+    void
+    operator()()
+    {
+        if(base_)
+        {
+            auto const basep = base_;
+            base_ = nullptr;
+            (*basep)();
+        }
+    }
+};
 
 } // http
 } // beast
@@ -0,0 +1,78 @@
+//
+// Copyright (c) 2013-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BEAST_HTTP_RFC7233_HPP
+#define BEAST_HTTP_RFC7233_HPP
+
+#include <boost/utility/string_ref.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace beast {
+namespace http {
+
+/** A range of octets in a representation.
+
+    Both positions are inclusive, as they appear in the
+    Range and Content-Range fields.
+*/
+struct byte_range
+{
+    /// The offset of the first octet in the range.
+    std::uint64_t first;
+
+    /// The offset of the last octet in the range.
+    std::uint64_t last;
+
+    /// Returns the number of octets in the range.
+    std::uint64_t
+    size() const
+    {
+        return last - first + 1;
+    }
+};
+
+/** Parse the value of a Range field.
+
+    The value is parsed as a byte-ranges-specifier, and each
+    satisfiable range is resolved against the size of the selected
+    representation and appended to `ranges`, in the order they
+    appear in the field. Suffix ranges are converted to absolute
+    positions, and last positions past the end of the representation
+    are clamped. Ranges which are not satisfiable are dropped.
+
+    BNF:
+    @code
+        byte-ranges-specifier = bytes-unit "=" byte-range-set
+        byte-range-set  = 1#( byte-range-spec / suffix-byte-range-spec )
+        byte-range-spec = first-byte-pos "-" [ last-byte-pos ]
+        suffix-byte-range-spec = "-" suffix-length
+    @endcode
+
+    @param s The value of the Range field.
+
+    @param size The size of the selected representation.
+
+    @param ranges The container which receives the ranges.
+    It is cleared before parsing.
+
+    @return `false` if the value is not a valid byte-ranges-specifier,
+    in which case the field should be ignored and the whole
+    representation sent. When `true` is returned and `ranges` is empty,
+    none of the ranges is satisfiable and the response should be
+    416 (Range Not Satisfiable).
+*/
+bool
+parse_ranges(boost::string_ref const& s,
+    std::uint64_t size, std::vector<byte_range>& ranges);
+
+} // http
+} // beast
+
+#include <beast/http/impl/rfc7233.ipp>
+
+#endif
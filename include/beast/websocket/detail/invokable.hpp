@@ -10,7 +10,6 @@
 
 #include <array>
 #include <cassert>
-#include <memory>
 #include <new>
 #include <utility>
 
@@ -62,9 +61,11 @@ class invokable
         }
     };
 
+    // Composed operations keep their state in
+    // a handler_ptr, so one pointer is enough.
     struct exemplar
     {
-        std::shared_ptr<int> _;
+        void* _;
         void operator()(){}
     };
 
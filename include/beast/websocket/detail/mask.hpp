@@ -69,6 +69,17 @@ maskgen_t<_>::rekey()
 
 using maskgen = maskgen_t<std::mt19937>;
 
+// Returns the calling thread's mask key generator.
+// One generator is shared by all streams on a thread,
+// since its state is large compared to a connection.
+template<class = void>
+maskgen&
+thread_maskgen()
+{
+    static thread_local maskgen g;
+    return g;
+}
+
 //------------------------------------------------------------------------------
 
 using prepared_key_type =
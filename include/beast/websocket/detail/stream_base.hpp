@@ -18,6 +18,8 @@
 #include <beast/http/empty_body.hpp>
 #include <beast/http/message.hpp>
 #include <beast/http/string_body.hpp>
+#include <beast/core/stream_stats.hpp>
+#include <beast/core/detail/empty_base_optimization.hpp>
 #include <boost/asio/error.hpp>
 #include <cassert>
 #include <cstdint>
@@ -54,48 +56,74 @@ using pong_cb = std::function<void(ping_data const&)>;
 //------------------------------------------------------------------------------
 
 struct stream_base
+    : private beast::detail::empty_base_optimization<
+        beast::detail::default_stats_recorder>
 {
 protected:
     struct op {};
 
-    detail::maskgen maskgen_;           // source of mask keys
-    decorator_type d_;                  // adorns http messages
-    bool keep_alive_ = false;           // close on failed upgrade
+    // Members are grouped by size to avoid padding.
+
+    decorator_type d_;                  // adorns http messages, or null
+    std::unique_ptr<pong_cb> pong_cb_;  // pong callback, or null
     std::size_t rd_msg_max_ =
         16 * 1024 * 1024;               // max message size
     std::size_t
         wr_frag_size_ = 16 * 1024;      // size of auto-fragments
     std::size_t mask_buf_size_ = 4096;  // mask buffer size
-    opcode wr_opcode_ = opcode::text;   // outgoing message type
-    pong_cb pong_cb_;                   // pong callback
-    role_type role_;                    // server or client
-    bool failed_;                       // the connection failed
 
     detail::frame_header rd_fh_;        // current frame header
     detail::prepared_key_type rd_key_;  // prepared masking key
     detail::utf8_checker rd_utf8_check_;// for current text msg
     std::uint64_t rd_size_;             // size of the current message so far
     std::uint64_t rd_need_ = 0;         // bytes left in msg frame payload
-    opcode rd_opcode_;                  // opcode of current msg
-    bool rd_cont_;                      // expecting a continuation frame
 
-    bool wr_close_;                     // sent close frame
-    bool wr_cont_;                      // next write is continuation frame
     op* wr_block_;                      // op currenly writing
-
     ping_data* pong_data_;              // where to put pong payload
     invokable rd_op_;                   // invoked after write completes
     invokable wr_op_;                   // invoked after read completes
     close_reason cr_;                   // set from received close frame
 
+    opcode wr_opcode_ = opcode::text;   // outgoing message type
+    opcode rd_opcode_;                  // opcode of current msg
+    role_type role_;                    // server or client
+    bool keep_alive_ = false;           // close on failed upgrade
+    bool failed_;                       // the connection failed
+    bool rd_cont_;                      // expecting a continuation frame
+    bool wr_close_;                     // sent close frame
+    bool wr_cont_;                      // next write is continuation frame
+
     stream_base(stream_base&&) = default;
     stream_base(stream_base const&) = delete;
     stream_base& operator=(stream_base&&) = default;
     stream_base& operator=(stream_base const&) = delete;
 
-    stream_base()
-        : d_(new decorator<default_decorator>{})
+    stream_base() = default;
+
+    // The statistics recorder. When statistics are
+    // disabled it is empty, and takes no space.
+    beast::detail::default_stats_recorder&
+    recorder()
+    {
+        return this->member();
+    }
+
+    beast::detail::default_stats_recorder const&
+    recorder() const
+    {
+        return this->member();
+    }
+
+    // Apply the decorator, or the default
+    // decorator if none was set.
+    template<class Message>
+    void
+    apply_decorator(Message& m)
     {
+        if(d_)
+            (*d_)(m);
+        else
+            default_decorator{}(m);
     }
 
     template<class = void>
@@ -12,8 +12,9 @@
 #include <beast/http/message_v1.hpp>
 #include <beast/http/parser_v1.hpp>
 #include <beast/http/read.hpp>
-#include <beast/core/handler_alloc.hpp>
+#include <beast/core/handler_ptr.hpp>
 #include <beast/core/prepare_buffers.hpp>
+#include <beast/core/trace.hpp>
 #include <cassert>
 #include <memory>
 #include <type_traits>
@@ -27,24 +28,19 @@ template<class NextLayer>
 template<class Handler>
 class stream<NextLayer>::accept_op
 {
-    using alloc_type =
-        handler_alloc<char, Handler>;
-
     struct data
     {
         stream<NextLayer>& ws;
         http::request_v1<http::string_body> req;
-        Handler h;
         bool cont;
         int state = 0;
 
-        template<class DeducedHandler, class Buffers>
-        data(DeducedHandler&& h_, stream<NextLayer>& ws_,
+        template<class Buffers>
+        data(Handler& handler, stream<NextLayer>& ws_,
                 Buffers const& buffers)
             : ws(ws_)
-            , h(std::forward<DeducedHandler>(h_))
             , cont(boost_asio_handler_cont_helpers::
-                is_continuation(h))
+                is_continuation(handler))
         {
             using boost::asio::buffer_copy;
             using boost::asio::buffer_size;
@@ -55,7 +51,7 @@ class stream<NextLayer>::accept_op
         }
     };
 
-    std::shared_ptr<data> d_;
+    handler_ptr<data, Handler> d_;
 
 public:
     accept_op(accept_op&&) = default;
@@ -64,10 +60,11 @@ public:
     template<class DeducedHandler, class... Args>
     accept_op(DeducedHandler&& h,
             stream<NextLayer>& ws, Args&&... args)
-        : d_(std::allocate_shared<data>(alloc_type{h},
-            std::forward<DeducedHandler>(h), ws,
-                std::forward<Args>(args)...))
+        : d_(std::forward<DeducedHandler>(h), ws,
+                std::forward<Args>(args)...)
     {
+        beast::detail::trace(&*d_,
+            "websocket::accept_op", trace_kind::begin);
         (*this)(error_code{}, 0, false);
     }
 
@@ -84,7 +81,7 @@ public:
         std::size_t size, accept_op* op)
     {
         return boost_asio_handler_alloc_helpers::
-            allocate(size, op->d_->h);
+            allocate(size, op->d_.handler());
     }
 
     friend
@@ -92,7 +89,7 @@ public:
         void* p, std::size_t size, accept_op* op)
     {
         return boost_asio_handler_alloc_helpers::
-            deallocate(p, size, op->d_->h);
+            deallocate(p, size, op->d_.handler());
     }
 
     friend
@@ -106,7 +103,7 @@ public:
     void asio_handler_invoke(Function&& f, accept_op* op)
     {
         return boost_asio_handler_invoke_helpers::
-            invoke(f, op->d_->h);
+            invoke(f, op->d_.handler());
     }
 };
 
@@ -121,6 +118,8 @@ operator()(error_code const& ec,
     d.cont = d.cont || again;
     while(! ec && d.state != 99)
     {
+        beast::detail::trace(&d,
+            "websocket::accept_op", trace_kind::step, d.state);
         switch(d.state)
         {
         case 0:
@@ -145,7 +144,9 @@ operator()(error_code const& ec,
             return;
         }
     }
-    d.h(ec);
+    beast::detail::trace(&d,
+        "websocket::accept_op", trace_kind::end, ec.value());
+    d_.invoke(ec);
 }
 
 } // websocket
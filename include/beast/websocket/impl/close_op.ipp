@@ -8,8 +8,9 @@
 #ifndef BEAST_WEBSOCKET_IMPL_CLOSE_OP_HPP
 #define BEAST_WEBSOCKET_IMPL_CLOSE_OP_HPP
 
-#include <beast/core/handler_alloc.hpp>
+#include <beast/core/handler_ptr.hpp>
 #include <beast/core/static_streambuf.hpp>
+#include <beast/core/trace.hpp>
 #include <memory>
 
 namespace beast {
@@ -21,34 +22,29 @@ template<class NextLayer>
 template<class Handler>
 class stream<NextLayer>::close_op
 {
-    using alloc_type = handler_alloc<char, Handler>;
-
     using fb_type = detail::frame_streambuf;
 
     struct data : op
     {
         stream<NextLayer>& ws;
         close_reason cr;
-        Handler h;
         fb_type fb;
         bool cont;
         int state = 0;
 
-        template<class DeducedHandler>
-        data(DeducedHandler&& h_, stream<NextLayer>& ws_,
+        data(Handler& handler, stream<NextLayer>& ws_,
                 close_reason const& cr_)
             : ws(ws_)
             , cr(cr_)
-            , h(std::forward<DeducedHandler>(h_))
             , cont(boost_asio_handler_cont_helpers::
-                is_continuation(h))
+                is_continuation(handler))
         {
             ws.template write_close<
                 static_streambuf>(fb, cr);
         }
     };
 
-    std::shared_ptr<data> d_;
+    handler_ptr<data, Handler> d_;
 
 public:
     close_op(close_op&&) = default;
@@ -57,10 +53,11 @@ public:
     template<class DeducedHandler, class... Args>
     close_op(DeducedHandler&& h,
             stream<NextLayer>& ws, Args&&... args)
-        : d_(std::allocate_shared<data>(alloc_type{h},
-            std::forward<DeducedHandler>(h), ws,
-                std::forward<Args>(args)...))
+        : d_(std::forward<DeducedHandler>(h), ws,
+                std::forward<Args>(args)...)
     {
+        beast::detail::trace(&*d_,
+            "websocket::close_op", trace_kind::begin);
         (*this)(error_code{}, false);
     }
 
@@ -80,7 +77,7 @@ public:
         std::size_t size, close_op* op)
     {
         return boost_asio_handler_alloc_helpers::
-            allocate(size, op->d_->h);
+            allocate(size, op->d_.handler());
     }
 
     friend
@@ -88,7 +85,7 @@ public:
         void* p, std::size_t size, close_op* op)
     {
         return boost_asio_handler_alloc_helpers::
-            deallocate(p, size, op->d_->h);
+            deallocate(p, size, op->d_.handler());
     }
 
     friend
@@ -102,7 +99,7 @@ public:
     void asio_handler_invoke(Function&& f, close_op* op)
     {
         return boost_asio_handler_invoke_helpers::
-            invoke(f, op->d_->h);
+            invoke(f, op->d_.handler());
     }
 };
 
@@ -130,6 +127,8 @@ operator()(error_code ec, bool again)
         goto upcall;
     for(;;)
     {
+        beast::detail::trace(&d,
+            "websocket::close_op", trace_kind::step, d.state);
         switch(d.state)
         {
         case 0:
@@ -137,6 +136,8 @@ operator()(error_code ec, bool again)
             {
                 // suspend
                 d.state = 2;
+                beast::detail::trace(&d,
+                    "websocket::close_op", trace_kind::wait, d.state);
                 d.ws.wr_op_.template emplace<
                     close_op>(std::move(*this));
                 return;
@@ -185,7 +186,9 @@ upcall:
     if(d.ws.wr_block_ == &d)
         d.ws.wr_block_ = nullptr;
     d.ws.rd_op_.maybe_invoke();
-    d.h(ec);
+    beast::detail::trace(&d,
+        "websocket::close_op", trace_kind::end, ec.value());
+    d_.invoke(ec);
 }
 
 } // websocket
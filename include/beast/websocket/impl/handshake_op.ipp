@@ -12,7 +12,8 @@
 #include <beast/http/message_v1.hpp>
 #include <beast/http/read.hpp>
 #include <beast/http/write.hpp>
-#include <beast/core/handler_alloc.hpp>
+#include <beast/core/handler_ptr.hpp>
+#include <beast/core/trace.hpp>
 #include <cassert>
 #include <memory>
 
@@ -25,34 +26,28 @@ template<class NextLayer>
 template<class Handler>
 class stream<NextLayer>::handshake_op
 {
-    using alloc_type =
-        handler_alloc<char, Handler>;
-
     struct data
     {
         stream<NextLayer>& ws;
-        Handler h;
         std::string key;
         http::request_v1<http::empty_body> req;
         http::response_v1<http::string_body> resp;
         bool cont;
         int state = 0;
 
-        template<class DeducedHandler>
-        data(DeducedHandler&& h_, stream<NextLayer>& ws_,
+        data(Handler& handler, stream<NextLayer>& ws_,
             boost::string_ref const& host,
                 boost::string_ref const& resource)
             : ws(ws_)
-            , h(std::forward<DeducedHandler>(h_))
             , req(ws.build_request(host, resource, key))
             , cont(boost_asio_handler_cont_helpers::
-                is_continuation(h))
+                is_continuation(handler))
         {
             ws.reset();
         }
     };
 
-    std::shared_ptr<data> d_;
+    handler_ptr<data, Handler> d_;
 
 public:
     handshake_op(handshake_op&&) = default;
@@ -61,10 +56,11 @@ public:
     template<class DeducedHandler, class... Args>
     handshake_op(DeducedHandler&& h,
             stream<NextLayer>& ws, Args&&... args)
-        : d_(std::allocate_shared<data>(alloc_type{h},
-            std::forward<DeducedHandler>(h), ws,
-                std::forward<Args>(args)...))
+        : d_(std::forward<DeducedHandler>(h), ws,
+                std::forward<Args>(args)...)
     {
+        beast::detail::trace(&*d_,
+            "websocket::handshake_op", trace_kind::begin);
         (*this)(error_code{}, false);
     }
 
@@ -76,7 +72,7 @@ public:
         std::size_t size, handshake_op* op)
     {
         return boost_asio_handler_alloc_helpers::
-            allocate(size, op->d_->h);
+            allocate(size, op->d_.handler());
     }
 
     friend
@@ -84,7 +80,7 @@ public:
         void* p, std::size_t size, handshake_op* op)
     {
         return boost_asio_handler_alloc_helpers::
-            deallocate(p, size, op->d_->h);
+            deallocate(p, size, op->d_.handler());
     }
 
     friend
@@ -98,7 +94,7 @@ public:
     void asio_handler_invoke(Function&& f, handshake_op* op)
     {
         return boost_asio_handler_invoke_helpers::
-            invoke(f, op->d_->h);
+            invoke(f, op->d_.handler());
     }
 };
 
@@ -112,6 +108,8 @@ operator()(error_code ec, bool again)
     d.cont = d.cont || again;
     while(! ec && d.state != 99)
     {
+        beast::detail::trace(&d,
+            "websocket::handshake_op", trace_kind::step, d.state);
         switch(d.state)
         {
         case 0:
@@ -144,7 +142,9 @@ operator()(error_code ec, bool again)
         }
         }
     }
-    d.h(ec);
+    beast::detail::trace(&d,
+        "websocket::handshake_op", trace_kind::end, ec.value());
+    d_.invoke(ec);
 }
 
 } // websocket
@@ -9,7 +9,8 @@
 #define BEAST_WEBSOCKET_IMPL_PING_OP_HPP
 
 #include <beast/core/bind_handler.hpp>
-#include <beast/core/handler_alloc.hpp>
+#include <beast/core/handler_ptr.hpp>
+#include <beast/core/trace.hpp>
 #include <beast/websocket/detail/frame.hpp>
 #include <memory>
 
@@ -22,24 +23,18 @@ template<class NextLayer>
 template<class Handler>
 class stream<NextLayer>::ping_op
 {
-    using alloc_type =
-        handler_alloc<char, Handler>;
-
     struct data : op
     {
         stream<NextLayer>& ws;
-        Handler h;
         detail::frame_streambuf fb;
         bool cont;
         int state = 0;
 
-        template<class DeducedHandler>
-        data(DeducedHandler&& h_, stream<NextLayer>& ws_,
+        data(Handler& handler, stream<NextLayer>& ws_,
                 ping_data const& payload)
             : ws(ws_)
-            , h(std::forward<DeducedHandler>(h_))
             , cont(boost_asio_handler_cont_helpers::
-                is_continuation(h))
+                is_continuation(handler))
         {
             using boost::asio::buffer;
             using boost::asio::buffer_copy;
@@ -48,7 +43,7 @@ class stream<NextLayer>::ping_op
         }
     };
 
-    std::shared_ptr<data> d_;
+    handler_ptr<data, Handler> d_;
 
 public:
     ping_op(ping_op&&) = default;
@@ -57,10 +52,11 @@ public:
     template<class DeducedHandler, class... Args>
     ping_op(DeducedHandler&& h,
             stream<NextLayer>& ws, Args&&... args)
-        : d_(std::make_shared<data>(
-            std::forward<DeducedHandler>(h), ws,
-                std::forward<Args>(args)...))
+        : d_(std::forward<DeducedHandler>(h), ws,
+                std::forward<Args>(args)...)
     {
+        beast::detail::trace(&*d_,
+            "websocket::ping_op", trace_kind::begin);
         (*this)(error_code{}, false);
     }
 
@@ -78,7 +74,7 @@ public:
         std::size_t size, ping_op* op)
     {
         return boost_asio_handler_alloc_helpers::
-            allocate(size, op->d_->h);
+            allocate(size, op->d_.handler());
     }
 
     friend
@@ -86,7 +82,7 @@ public:
         void* p, std::size_t size, ping_op* op)
     {
         return boost_asio_handler_alloc_helpers::
-            deallocate(p, size, op->d_->h);
+            deallocate(p, size, op->d_.handler());
     }
 
     friend
@@ -100,7 +96,7 @@ public:
     void asio_handler_invoke(Function&& f, ping_op* op)
     {
         return boost_asio_handler_invoke_helpers::
-            invoke(f, op->d_->h);
+            invoke(f, op->d_.handler());
     }
 };
 
@@ -129,6 +125,8 @@ operator()(error_code ec, bool again)
         goto upcall;
     for(;;)
     {
+        beast::detail::trace(&d,
+            "websocket::ping_op", trace_kind::step, d.state);
         switch(d.state)
         {
         case 0:
@@ -136,6 +134,8 @@ operator()(error_code ec, bool again)
             {
                 // suspend
                 d.state = 2;
+                beast::detail::trace(&d,
+                    "websocket::ping_op", trace_kind::wait, d.state);
                 d.ws.wr_op_.template emplace<
                     ping_op>(std::move(*this));
                 return;
@@ -184,7 +184,9 @@ upcall:
     if(d.ws.wr_block_ == &d)
         d.ws.wr_block_ = nullptr;
     d.ws.rd_op_.maybe_invoke();
-    d.h(ec);
+    beast::detail::trace(&d,
+        "websocket::ping_op", trace_kind::end, ec.value());
+    d_.invoke(ec);
 }
 
 } // websocket
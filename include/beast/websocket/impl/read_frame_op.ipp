@@ -9,9 +9,10 @@
 #define BEAST_WEBSOCKET_IMPL_READ_FRAME_OP_HPP
 
 #include <beast/websocket/teardown.hpp>
-#include <beast/core/handler_alloc.hpp>
+#include <beast/core/handler_ptr.hpp>
 #include <beast/core/prepare_buffers.hpp>
 #include <beast/core/static_streambuf.hpp>
+#include <beast/core/trace.hpp>
 #include <boost/optional.hpp>
 #include <cassert>
 #include <memory>
@@ -26,9 +27,6 @@ template<class NextLayer>
 template<class DynamicBuffer, class Handler>
 class stream<NextLayer>::read_frame_op
 {
-    using alloc_type =
-        handler_alloc<char, Handler>;
-
     using fb_type =
         detail::frame_streambuf;
 
@@ -43,27 +41,24 @@ class stream<NextLayer>::read_frame_op
         stream<NextLayer>& ws;
         frame_info& fi;
         DynamicBuffer& db;
-        Handler h;
         fb_type fb;
         boost::optional<dmb_type> dmb;
         boost::optional<fmb_type> fmb;
         bool cont;
         int state = 0;
 
-        template<class DeducedHandler>
-        data(DeducedHandler&& h_, stream<NextLayer>& ws_,
+        data(Handler& handler, stream<NextLayer>& ws_,
                 frame_info& fi_, DynamicBuffer& sb_)
             : ws(ws_)
             , fi(fi_)
             , db(sb_)
-            , h(std::forward<DeducedHandler>(h_))
             , cont(boost_asio_handler_cont_helpers::
-                is_continuation(h))
+                is_continuation(handler))
         {
         }
     };
 
-    std::shared_ptr<data> d_;
+    handler_ptr<data, Handler> d_;
 
 public:
     read_frame_op(read_frame_op&&) = default;
@@ -72,10 +67,11 @@ public:
     template<class DeducedHandler, class... Args>
     read_frame_op(DeducedHandler&& h,
             stream<NextLayer>& ws, Args&&... args)
-        : d_(std::allocate_shared<data>(alloc_type{h},
-            std::forward<DeducedHandler>(h), ws,
-                std::forward<Args>(args)...))
+        : d_(std::forward<DeducedHandler>(h), ws,
+                std::forward<Args>(args)...)
     {
+        beast::detail::trace(&*d_,
+            "websocket::read_frame_op", trace_kind::begin);
         (*this)(error_code{}, 0, false);
     }
 
@@ -100,7 +96,7 @@ public:
         std::size_t size, read_frame_op* op)
     {
         return boost_asio_handler_alloc_helpers::
-            allocate(size, op->d_->h);
+            allocate(size, op->d_.handler());
     }
 
     friend
@@ -108,7 +104,7 @@ public:
         void* p, std::size_t size, read_frame_op* op)
     {
         return boost_asio_handler_alloc_helpers::
-            deallocate(p, size, op->d_->h);
+            deallocate(p, size, op->d_.handler());
     }
 
     friend
@@ -122,7 +118,7 @@ public:
     void asio_handler_invoke(Function&& f, read_frame_op* op)
     {
         return boost_asio_handler_invoke_helpers::
-            invoke(f, op->d_->h);
+            invoke(f, op->d_.handler());
     }
 };
 
@@ -168,6 +164,8 @@ operator()(error_code ec,std::size_t bytes_transferred, bool again)
         close_code::value code = close_code::none;
         do
         {
+            beast::detail::trace(&d,
+                "websocket::read_frame_op", trace_kind::step, d.state);
             switch(d.state)
             {
             case do_start:
@@ -200,9 +198,13 @@ operator()(error_code ec,std::size_t bytes_transferred, bool again)
                 auto const pb = prepare_buffers(
                     bytes_transferred, *d.dmb);
                 if(d.ws.rd_fh_.mask)
+                {
+                    auto const t = d.ws.recorder().time_mask();
                     detail::mask_inplace(pb, d.ws.rd_key_);
+                }
                 if(d.ws.rd_opcode_ == opcode::text)
                 {
+                    auto const t = d.ws.recorder().time_utf8();
                     if(! d.ws.rd_utf8_check_.write(pb) ||
                         (d.ws.rd_need_ == 0 && d.ws.rd_fh_.fin &&
                             ! d.ws.rd_utf8_check_.finish()))
@@ -214,6 +216,7 @@ operator()(error_code ec,std::size_t bytes_transferred, bool again)
                     }
                 }
                 d.db.commit(bytes_transferred);
+                d.ws.recorder().on_read_buffer(d.db.size());
                 if(d.ws.rd_need_ > 0)
                 {
                     d.state = do_read_payload;
@@ -304,8 +307,11 @@ operator()(error_code ec,std::size_t bytes_transferred, bool again)
 
             case do_control_payload:
                 if(d.ws.rd_fh_.mask)
+                {
+                    auto const t = d.ws.recorder().time_mask();
                     detail::mask_inplace(
                         *d.fmb, d.ws.rd_key_);
+                }
                 d.fb.commit(bytes_transferred);
                 d.state = do_control; // VFALCO fall through?
                 break;
@@ -331,6 +337,8 @@ operator()(error_code ec,std::size_t bytes_transferred, bool again)
                         // suspend
                         d.state = do_pong_resume;
                         assert(d.ws.wr_block_ != &d);
+                        beast::detail::trace(&d,
+                            "websocket::read_frame_op", trace_kind::wait, d.state);
                         d.ws.rd_op_.template emplace<
                             read_frame_op>(std::move(*this));
                         return;
@@ -344,7 +352,7 @@ operator()(error_code ec,std::size_t bytes_transferred, bool again)
                     ping_data payload;
                     detail::read(payload, d.fb.data());
                     if(d.ws.pong_cb_)
-                        d.ws.pong_cb_(payload);
+                        (*d.ws.pong_cb_)(payload);
                     d.fb.reset();
                     d.state = do_read_fh;
                     break;
@@ -371,6 +379,8 @@ operator()(error_code ec,std::size_t bytes_transferred, bool again)
                         {
                             // suspend
                             d.state = do_close_resume;
+                            beast::detail::trace(&d,
+                                "websocket::read_frame_op", trace_kind::wait, d.state);
                             d.ws.rd_op_.template emplace<
                                 read_frame_op>(std::move(*this));
                             return;
@@ -487,6 +497,8 @@ operator()(error_code ec,std::size_t bytes_transferred, bool again)
                 {
                     // suspend
                     d.state = do_fail + 2;
+                    beast::detail::trace(&d,
+                        "websocket::read_frame_op", trace_kind::wait, d.state);
                     d.ws.rd_op_.template emplace<
                         read_frame_op>(std::move(*this));
                     return;
@@ -542,7 +554,9 @@ upcall:
     if(d.ws.wr_block_ == &d)
         d.ws.wr_block_ = nullptr;
     d.ws.wr_op_.maybe_invoke();
-    d.h(ec);
+    beast::detail::trace(&d,
+        "websocket::read_frame_op", trace_kind::end, ec.value());
+    d_.invoke(ec);
 }
 
 } // websocket
@@ -8,7 +8,8 @@
 #ifndef BEAST_WEBSOCKET_IMPL_READ_OP_HPP
 #define BEAST_WEBSOCKET_IMPL_READ_OP_HPP
 
-#include <beast/core/handler_alloc.hpp>
+#include <beast/core/handler_ptr.hpp>
+#include <beast/core/trace.hpp>
 #include <memory>
 
 namespace beast {
@@ -20,34 +21,28 @@ template<class NextLayer>
 template<class DynamicBuffer, class Handler>
 class stream<NextLayer>::read_op
 {
-    using alloc_type =
-        handler_alloc<char, Handler>;
-
     struct data
     {
         stream<NextLayer>& ws;
         opcode& op;
         DynamicBuffer& db;
-        Handler h;
         frame_info fi;
         bool cont;
         int state = 0;
 
-        template<class DeducedHandler>
-        data(DeducedHandler&& h_,
+        data(Handler& handler,
             stream<NextLayer>& ws_, opcode& op_,
                 DynamicBuffer& sb_)
             : ws(ws_)
             , op(op_)
             , db(sb_)
-            , h(std::forward<DeducedHandler>(h_))
             , cont(boost_asio_handler_cont_helpers::
-                is_continuation(h))
+                is_continuation(handler))
         {
         }
     };
 
-    std::shared_ptr<data> d_;
+    handler_ptr<data, Handler> d_;
 
 public:
     read_op(read_op&&) = default;
@@ -56,10 +51,11 @@ public:
     template<class DeducedHandler, class... Args>
     read_op(DeducedHandler&& h,
             stream<NextLayer>& ws, Args&&... args)
-        : d_(std::allocate_shared<data>(alloc_type{h},
-            std::forward<DeducedHandler>(h), ws,
-                std::forward<Args>(args)...))
+        : d_(std::forward<DeducedHandler>(h), ws,
+                std::forward<Args>(args)...)
     {
+        beast::detail::trace(&*d_,
+            "websocket::read_op", trace_kind::begin);
         (*this)(error_code{}, false);
     }
 
@@ -71,7 +67,7 @@ public:
         std::size_t size, read_op* op)
     {
         return boost_asio_handler_alloc_helpers::
-            allocate(size, op->d_->h);
+            allocate(size, op->d_.handler());
     }
 
     friend
@@ -79,7 +75,7 @@ public:
         void* p, std::size_t size, read_op* op)
     {
         return boost_asio_handler_alloc_helpers::
-            deallocate(p, size, op->d_->h);
+            deallocate(p, size, op->d_.handler());
     }
 
     friend
@@ -93,7 +89,7 @@ public:
     void asio_handler_invoke(Function&& f, read_op* op)
     {
         return boost_asio_handler_invoke_helpers::
-            invoke(f, op->d_->h);
+            invoke(f, op->d_.handler());
     }
 };
 
@@ -107,6 +103,8 @@ operator()(error_code const& ec, bool again)
     d.cont = d.cont || again;
     while(! ec)
     {
+        beast::detail::trace(&d,
+            "websocket::read_op", trace_kind::step, d.state);
         switch(d.state)
         {
         case 0:
@@ -133,7 +131,9 @@ operator()(error_code const& ec, bool again)
         }
     }
 upcall:
-    d.h(ec);
+    beast::detail::trace(&d,
+        "websocket::read_op", trace_kind::end, ec.value());
+    d_.invoke(ec);
 }
 
 } // websocket
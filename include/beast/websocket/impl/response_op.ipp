@@ -11,7 +11,8 @@
 #include <beast/http/message_v1.hpp>
 #include <beast/http/string_body.hpp>
 #include <beast/http/write.hpp>
-#include <beast/core/handler_alloc.hpp>
+#include <beast/core/handler_ptr.hpp>
+#include <beast/core/trace.hpp>
 #include <memory>
 
 namespace beast {
@@ -22,26 +23,20 @@ template<class NextLayer>
 template<class Handler>
 class stream<NextLayer>::response_op
 {
-    using alloc_type =
-        handler_alloc<char, Handler>;
-
     struct data
     {
         stream<NextLayer>& ws;
         http::response_v1<http::string_body> resp;
-        Handler h;
         error_code final_ec;
         bool cont;
         int state = 0;
 
-        template<class DeducedHandler,
-            class Body, class Headers>
-        data(DeducedHandler&& h_, stream<NextLayer>& ws_,
+        template<class Body, class Headers>
+        data(Handler&, stream<NextLayer>& ws_,
             http::request_v1<Body, Headers> const& req,
                 bool cont_)
             : ws(ws_)
             , resp(ws_.build_response(req))
-            , h(std::forward<DeducedHandler>(h_))
             , cont(cont_)
         {
             // can't call stream::reset() here
@@ -52,7 +47,7 @@ class stream<NextLayer>::response_op
         }
     };
 
-    std::shared_ptr<data> d_;
+    handler_ptr<data, Handler> d_;
 
 public:
     response_op(response_op&&) = default;
@@ -61,10 +56,11 @@ public:
     template<class DeducedHandler, class... Args>
     response_op(DeducedHandler&& h,
             stream<NextLayer>& ws, Args&&... args)
-        : d_(std::allocate_shared<data>(alloc_type{h},
-            std::forward<DeducedHandler>(h), ws,
-                std::forward<Args>(args)...))
+        : d_(std::forward<DeducedHandler>(h), ws,
+                std::forward<Args>(args)...)
     {
+        beast::detail::trace(&*d_,
+            "websocket::response_op", trace_kind::begin);
         (*this)(error_code{}, false);
     }
 
@@ -76,7 +72,7 @@ public:
         std::size_t size, response_op* op)
     {
         return boost_asio_handler_alloc_helpers::
-            allocate(size, op->d_->h);
+            allocate(size, op->d_.handler());
     }
 
     friend
@@ -84,7 +80,7 @@ public:
         void* p, std::size_t size, response_op* op)
     {
         return boost_asio_handler_alloc_helpers::
-            deallocate(p, size, op->d_->h);
+            deallocate(p, size, op->d_.handler());
     }
 
     friend
@@ -98,7 +94,7 @@ public:
     void asio_handler_invoke(Function&& f, response_op* op)
     {
         return boost_asio_handler_invoke_helpers::
-            invoke(f, op->d_->h);
+            invoke(f, op->d_.handler());
     }
 };
 
@@ -112,6 +108,8 @@ operator()(error_code ec, bool again)
     d.cont = d.cont || again;
     while(! ec && d.state != 99)
     {
+        beast::detail::trace(&d,
+            "websocket::response_op", trace_kind::step, d.state);
         switch(d.state)
         {
         case 0:
@@ -130,7 +128,9 @@ operator()(error_code ec, bool again)
             break;
         }
     }
-    d.h(ec);
+    beast::detail::trace(&d,
+        "websocket::response_op", trace_kind::end, ec.value());
+    d_.invoke(ec);
 }
 
 } // websocket
@@ -10,6 +10,7 @@
 
 #include <beast/core/async_completion.hpp>
 #include <beast/core/handler_concepts.hpp>
+#include <beast/core/trace.hpp>
 
 namespace beast {
 namespace websocket {
@@ -39,31 +40,29 @@ class teardown_ssl_op
     struct data
     {
         stream_type& stream;
-        Handler h;
         bool cont;
         int state = 0;
 
-        template<class DeducedHandler>
-        data(DeducedHandler&& h_,
+        data(Handler& handler,
                 stream_type& stream_)
             : stream(stream_)
-            , h(std::forward<DeducedHandler>(h_))
             , cont(boost_asio_handler_cont_helpers::
-                is_continuation(h))
+                is_continuation(handler))
         {
         }
     };
 
-    std::shared_ptr<data> d_;
+    handler_ptr<data, Handler> d_;
 
 public:
     template<class DeducedHandler>
     explicit
     teardown_ssl_op(
             DeducedHandler&& h, stream_type& stream)
-        : d_(std::make_shared<data>(
-            std::forward<DeducedHandler>(h), stream))
+        : d_(std::forward<DeducedHandler>(h), stream)
     {
+        beast::detail::trace(&*d_,
+            "websocket::teardown_ssl_op", trace_kind::begin);
         (*this)(error_code{}, false);
     }
 
@@ -75,7 +74,7 @@ public:
         teardown_ssl_op* op)
     {
         return boost_asio_handler_alloc_helpers::
-            allocate(size, op->d_->h);
+            allocate(size, op->d_.handler());
     }
 
     friend
@@ -83,7 +82,7 @@ public:
         std::size_t size, teardown_ssl_op* op)
     {
         return boost_asio_handler_alloc_helpers::
-            deallocate(p, size, op->d_->h);
+            deallocate(p, size, op->d_.handler());
     }
 
     friend
@@ -99,7 +98,7 @@ public:
         teardown_ssl_op* op)
     {
         return boost_asio_handler_invoke_helpers::
-            invoke(f, op->d_->h);
+            invoke(f, op->d_.handler());
     }
 };
 
@@ -112,6 +111,8 @@ operator()(error_code ec, bool again)
     d.cont = d.cont || again;
     while(!ec && d.state != 99)
     {
+        beast::detail::trace(&d,
+            "websocket::teardown_ssl_op", trace_kind::step, d.state);
         switch(d.state)
         {
         case 0:
@@ -120,7 +121,9 @@ operator()(error_code ec, bool again)
             return;
         }
     }
-    d.h(ec);
+    beast::detail::trace(&d,
+        "websocket::teardown_ssl_op", trace_kind::end, ec.value());
+    d_.invoke(ec);
 }
 
 } // detail
@@ -91,6 +91,7 @@ stream_base::prepare_fh(close_code::value& code)
         rd_need_ = rd_fh_.len;
         rd_cont_ = ! rd_fh_.fin;
     }
+    recorder().on_frame_in(is_control(rd_fh_.op), rd_fh_.fin);
 }
 
 template<class DynamicBuffer>
@@ -109,8 +110,9 @@ stream_base::write_close(
         0 : 2 + cr.reason.size();
     fh.mask = role_ == detail::role_type::client;
     if(fh.mask)
-        fh.key = maskgen_();
+        fh.key = detail::thread_maskgen()();
     detail::write(db, fh);
+    recorder().on_frame_out(true, true);
     if(cr.code != close_code::none)
     {
         detail::prepared_key_type key;
@@ -154,8 +156,9 @@ stream_base::write_ping(DynamicBuffer& db,
     fh.len = data.size();
     fh.mask = role_ == role_type::client;
     if(fh.mask)
-        fh.key = maskgen_();
+        fh.key = detail::thread_maskgen()();
     detail::write(db, fh);
+    recorder().on_frame_out(true, true);
     if(data.empty())
         return;
     detail::prepared_key_type key;
@@ -584,7 +587,10 @@ read_frame(frame_info& fi, DynamicBuffer& dynabuf, error_code& ec)
                     if(failed_)
                         return;
                     if(rd_fh_.mask)
+                    {
+                        auto const t = recorder().time_mask();
                         detail::mask_inplace(mb, rd_key_);
+                    }
                     fb.commit(static_cast<std::size_t>(rd_fh_.len));
                 }
                 if(rd_fh_.op == opcode::ping)
@@ -605,7 +611,7 @@ read_frame(frame_info& fi, DynamicBuffer& dynabuf, error_code& ec)
                     ping_data payload;
                     detail::read(payload, fb.data());
                     if(pong_cb_)
-                        pong_cb_(payload);
+                        (*pong_cb_)(payload);
                     continue;
                 }
                 assert(rd_fh_.op == opcode::close);
@@ -648,9 +654,13 @@ read_frame(frame_info& fi, DynamicBuffer& dynabuf, error_code& ec)
         auto const pb = prepare_buffers(
             bytes_transferred, smb);
         if(rd_fh_.mask)
+        {
+            auto const t = recorder().time_mask();
             detail::mask_inplace(pb, rd_key_);
+        }
         if(rd_opcode_ == opcode::text)
         {
+            auto const t = recorder().time_utf8();
             if(! rd_utf8_check_.write(pb) ||
                 (rd_need_ == 0 && rd_fh_.fin &&
                     ! rd_utf8_check_.finish()))
@@ -660,6 +670,7 @@ read_frame(frame_info& fi, DynamicBuffer& dynabuf, error_code& ec)
             }
         }
         dynabuf.commit(bytes_transferred);
+        recorder().on_read_buffer(dynabuf.size());
         fi.op = rd_opcode_;
         fi.fin = rd_fh_.fin && rd_need_ == 0;
         return;
@@ -817,9 +828,10 @@ write_frame(bool fin, ConstBufferSequence const& bs, error_code& ec)
     fh.len = buffer_size(bs);
     fh.mask = role_ == detail::role_type::client;
     if(fh.mask)
-        fh.key = maskgen_();
+        fh.key = detail::thread_maskgen()();
     detail::fh_streambuf fh_buf;
     detail::write<static_streambuf>(fh_buf, fh);
+    recorder().on_frame_out(false, fin);
     if(! fh.mask)
     {
         // send header and payload
@@ -834,6 +846,7 @@ write_frame(bool fin, ConstBufferSequence const& bs, error_code& ec)
         detail::clamp(fh.len, mask_buf_size_);
     std::unique_ptr<std::uint8_t[]> up(
         new std::uint8_t[tmp_size]);
+    recorder().on_write_buffer(tmp_size);
     std::uint64_t remain = fh.len;
     consuming_buffers<ConstBufferSequence> cb(bs);
     {
@@ -843,7 +856,10 @@ write_frame(bool fin, ConstBufferSequence const& bs, error_code& ec)
         buffer_copy(mb, cb);
         cb.consume(n);
         remain -= n;
-        detail::mask_inplace(mb, key);
+        {
+            auto const t = recorder().time_mask();
+            detail::mask_inplace(mb, key);
+        }
         // send header and payload
         boost::asio::write(stream_,
             buffer_cat(fh_buf.data(), mb), ec);
@@ -861,7 +877,10 @@ write_frame(bool fin, ConstBufferSequence const& bs, error_code& ec)
         buffer_copy(mb, cb);
         cb.consume(n);
         remain -= n;
-        detail::mask_inplace(mb, key);
+        {
+            auto const t = recorder().time_mask();
+            detail::mask_inplace(mb, key);
+        }
         // send payload
         boost::asio::write(stream_, mb, ec);
         if(ec)
@@ -925,10 +944,10 @@ build_request(boost::string_ref const& host,
     req.method = "GET";
     req.headers.insert("Host", host);
     req.headers.insert("Upgrade", "websocket");
-    key = detail::make_sec_ws_key(maskgen_);
+    key = detail::make_sec_ws_key(detail::thread_maskgen());
     req.headers.insert("Sec-WebSocket-Key", key);
     req.headers.insert("Sec-WebSocket-Version", "13");
-    (*d_)(req);
+    apply_decorator(req);
     http::prepare(req, http::connection::upgrade);
     return req;
 }
@@ -947,7 +966,7 @@ build_response(http::request_v1<Body, Headers> const& req)
             res.reason = http::reason_string(res.status);
             res.version = req.version;
             res.body = text;
-            (*d_)(res);
+            apply_decorator(res);
             prepare(res,
                 (is_keep_alive(req) && keep_alive_) ?
                     http::connection::keep_alive :
@@ -997,7 +1016,7 @@ build_response(http::request_v1<Body, Headers> const& req)
             detail::make_sec_ws_accept(key));
     }
     res.headers.replace("Server", "Beast.WSProto");
-    (*d_)(res);
+    apply_decorator(res);
     http::prepare(res, http::connection::upgrade);
     return res;
 }
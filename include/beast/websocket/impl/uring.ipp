@@ -0,0 +1,173 @@
+//
+// Copyright (c) 2013-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BEAST_WEBSOCKET_IMPL_URING_IPP
+#define BEAST_WEBSOCKET_IMPL_URING_IPP
+
+#include <beast/core/async_completion.hpp>
+#include <beast/core/bind_handler.hpp>
+#include <beast/core/handler_concepts.hpp>
+#include <beast/core/handler_ptr.hpp>
+#include <beast/core/trace.hpp>
+
+namespace beast {
+namespace websocket {
+namespace detail {
+
+template<class Handler>
+class teardown_uring_op
+{
+    struct data
+    {
+        uring_stream& stream;
+        char buf[8192];
+        bool cont;
+        int state = 0;
+
+        data(Handler& handler, uring_stream& stream_)
+            : stream(stream_)
+            , cont(boost_asio_handler_cont_helpers::
+                is_continuation(handler))
+        {
+        }
+    };
+
+    handler_ptr<data, Handler> d_;
+
+public:
+    template<class DeducedHandler>
+    teardown_uring_op(
+        DeducedHandler&& h,
+            uring_stream& stream)
+        : d_(std::forward<DeducedHandler>(h),
+                stream)
+    {
+        beast::detail::trace(&*d_,
+            "websocket::teardown_uring_op", trace_kind::begin);
+        (*this)(error_code{}, 0, false);
+    }
+
+    void
+    operator()(error_code ec, std::size_t, bool again = true);
+
+    friend
+    void* asio_handler_allocate(std::size_t size,
+        teardown_uring_op* op)
+    {
+        return boost_asio_handler_alloc_helpers::
+            allocate(size, op->d_.handler());
+    }
+
+    friend
+    void asio_handler_deallocate(void* p,
+        std::size_t size, teardown_uring_op* op)
+    {
+        return boost_asio_handler_alloc_helpers::
+            deallocate(p, size, op->d_.handler());
+    }
+
+    friend
+    bool asio_handler_is_continuation(teardown_uring_op* op)
+    {
+        return op->d_->cont;
+    }
+
+    template <class Function>
+    friend
+    void asio_handler_invoke(Function&& f,
+        teardown_uring_op* op)
+    {
+        return boost_asio_handler_invoke_helpers::
+            invoke(f, op->d_.handler());
+    }
+};
+
+template<class Handler>
+void
+teardown_uring_op<Handler>::
+operator()(error_code ec, std::size_t, bool again)
+{
+    using boost::asio::buffer;
+    auto& d = *d_;
+    d.cont = d.cont || again;
+    while(! ec)
+    {
+        beast::detail::trace(&d,
+            "websocket::teardown_uring_op", trace_kind::step, d.state);
+        switch(d.state)
+        {
+        case 0:
+            d.state = 1;
+            d.stream.shutdown(
+                boost::asio::socket_base::shutdown_send, ec);
+            if(ec)
+            {
+                // The handler must not be
+                // invoked from this function.
+                d.stream.get_io_service().post(
+                    bind_handler(std::move(*this), ec, 0));
+                return;
+            }
+            break;
+
+        case 1:
+            d.stream.async_read_some(
+                buffer(d.buf), std::move(*this));
+            return;
+        }
+    }
+    if(ec == boost::asio::error::eof)
+    {
+        d.stream.close();
+        ec = error_code{};
+    }
+    beast::detail::trace(&d,
+        "websocket::teardown_uring_op", trace_kind::end, ec.value());
+    d_.invoke(ec);
+}
+
+} // detail
+} // websocket
+
+//------------------------------------------------------------------------------
+
+inline
+void
+teardown(uring_stream& stream, error_code& ec)
+{
+    using boost::asio::buffer;
+    stream.shutdown(
+        boost::asio::socket_base::shutdown_send, ec);
+    while(! ec)
+    {
+        char buf[8192];
+        auto const n = stream.read_some(
+            buffer(buf), ec);
+        if(! n)
+            break;
+    }
+    if(ec == boost::asio::error::eof)
+        ec = error_code{};
+    stream.close();
+}
+
+template<class TeardownHandler>
+inline
+void
+async_teardown(uring_stream& stream, TeardownHandler&& handler)
+{
+    static_assert(beast::is_CompletionHandler<
+        TeardownHandler, void(error_code)>::value,
+            "TeardownHandler requirements not met");
+    websocket::detail::teardown_uring_op<typename std::decay<
+        TeardownHandler>::type>{std::forward<
+            TeardownHandler>(handler), stream};
+}
+
+} // beast
+
+#endif
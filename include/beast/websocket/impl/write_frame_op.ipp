@@ -11,8 +11,9 @@
 #include <beast/core/buffer_cat.hpp>
 #include <beast/core/bind_handler.hpp>
 #include <beast/core/consuming_buffers.hpp>
-#include <beast/core/handler_alloc.hpp>
+#include <beast/core/handler_ptr.hpp>
 #include <beast/core/static_streambuf.hpp>
+#include <beast/core/trace.hpp>
 #include <beast/websocket/detail/frame.hpp>
 #include <algorithm>
 #include <cassert>
@@ -27,14 +28,11 @@ template<class NextLayer>
 template<class Buffers, class Handler>
 class stream<NextLayer>::write_frame_op
 {
-    using alloc_type =
-        handler_alloc<char, Handler>;
-
     struct data : op
     {
         stream<NextLayer>& ws;
         consuming_buffers<Buffers> cb;
-        Handler h;
+        Handler& h;
         detail::frame_header fh;
         detail::fh_streambuf fh_buf;
         detail::prepared_key_type key;
@@ -44,14 +42,13 @@ class stream<NextLayer>::write_frame_op
         bool cont;
         int state = 0;
 
-        template<class DeducedHandler>
-        data(DeducedHandler&& h_, stream<NextLayer>& ws_,
+        data(Handler& handler, stream<NextLayer>& ws_,
                 bool fin, Buffers const& bs)
             : ws(ws_)
             , cb(bs)
-            , h(std::forward<DeducedHandler>(h_))
+            , h(handler)
             , cont(boost_asio_handler_cont_helpers::
-                is_continuation(h))
+                is_continuation(handler))
         {
             fh.op = ws.wr_cont_ ?
                 opcode::cont : ws.wr_opcode_;
@@ -64,19 +61,21 @@ class stream<NextLayer>::write_frame_op
             fh.mask = ws.role_ == detail::role_type::client;
             if(fh.mask)
             {
-                fh.key = ws.maskgen_();
+                fh.key = detail::thread_maskgen()();
                 detail::prepare_key(key, fh.key);
                 tmp_size = detail::clamp(
                     fh.len, ws.mask_buf_size_);
                 tmp = boost_asio_handler_alloc_helpers::
                     allocate(tmp_size, h);
                 remain = fh.len;
+                ws.recorder().on_write_buffer(tmp_size);
             }
             else
             {
                 tmp = nullptr;
             }
             detail::write<static_streambuf>(fh_buf, fh);
+            ws.recorder().on_frame_out(false, fin);
         }
 
         ~data()
@@ -87,7 +86,7 @@ class stream<NextLayer>::write_frame_op
         }
     };
 
-    std::shared_ptr<data> d_;
+    handler_ptr<data, Handler> d_;
 
 public:
     write_frame_op(write_frame_op&&) = default;
@@ -96,10 +95,11 @@ public:
     template<class DeducedHandler, class... Args>
     write_frame_op(DeducedHandler&& h,
             stream<NextLayer>& ws, Args&&... args)
-        : d_(std::make_shared<data>(
-            std::forward<DeducedHandler>(h), ws,
-                std::forward<Args>(args)...))
+        : d_(std::forward<DeducedHandler>(h), ws,
+                std::forward<Args>(args)...)
     {
+        beast::detail::trace(&*d_,
+            "websocket::write_frame_op", trace_kind::begin);
         (*this)(error_code{}, false);
     }
 
@@ -117,7 +117,7 @@ public:
         std::size_t size, write_frame_op* op)
     {
         return boost_asio_handler_alloc_helpers::
-            allocate(size, op->d_->h);
+            allocate(size, op->d_.handler());
     }
 
     friend
@@ -125,7 +125,7 @@ public:
         void* p, std::size_t size, write_frame_op* op)
     {
         return boost_asio_handler_alloc_helpers::
-            deallocate(p, size, op->d_->h);
+            deallocate(p, size, op->d_.handler());
     }
 
     friend
@@ -139,7 +139,7 @@ public:
     void asio_handler_invoke(Function&& f, write_frame_op* op)
     {
         return boost_asio_handler_invoke_helpers::
-            invoke(f, op->d_->h);
+            invoke(f, op->d_.handler());
     }
 };
 
@@ -171,6 +171,8 @@ operator()(error_code ec, bool again)
         goto upcall;
     for(;;)
     {
+        beast::detail::trace(&d,
+            "websocket::write_frame_op", trace_kind::step, d.state);
         switch(d.state)
         {
         case 0:
@@ -178,6 +180,8 @@ operator()(error_code ec, bool again)
             {
                 // suspend
                 d.state = 3;
+                beast::detail::trace(&d,
+                    "websocket::write_frame_op", trace_kind::wait, d.state);
                 d.ws.wr_op_.template emplace<
                     write_frame_op>(std::move(*this));
                 return;
@@ -212,7 +216,10 @@ operator()(error_code ec, bool again)
             buffer_copy(mb, d.cb);
             d.cb.consume(n);
             d.remain -= n;
-            detail::mask_inplace(mb, d.key);
+            {
+                auto const t = d.ws.recorder().time_mask();
+                detail::mask_inplace(mb, d.key);
+            }
             // send header and payload
             d.state = d.remain > 0 ? 2 : 99;
             assert(! d.ws.wr_block_);
@@ -233,7 +240,10 @@ operator()(error_code ec, bool again)
             buffer_copy(mb, d.cb);
             d.cb.consume(n);
             d.remain -= n;
-            detail::mask_inplace(mb, d.key);
+            {
+                auto const t = d.ws.recorder().time_mask();
+                detail::mask_inplace(mb, d.key);
+            }
             // send payload
             if(d.remain == 0)
                 d.state = 99;
@@ -273,7 +283,9 @@ upcall:
     if(d.ws.wr_block_ == &d)
         d.ws.wr_block_ = nullptr;
     d.ws.rd_op_.maybe_invoke();
-    d.h(ec);
+    beast::detail::trace(&d,
+        "websocket::write_frame_op", trace_kind::end, ec.value());
+    d_.invoke(ec);
 }
 
 } // websocket
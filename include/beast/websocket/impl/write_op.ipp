@@ -10,7 +10,8 @@
 
 #include <beast/core/consuming_buffers.hpp>
 #include <beast/core/prepare_buffers.hpp>
-#include <beast/core/handler_alloc.hpp>
+#include <beast/core/handler_ptr.hpp>
+#include <beast/core/trace.hpp>
 #include <beast/websocket/detail/frame.hpp>
 #include <algorithm>
 #include <cassert>
@@ -25,32 +26,26 @@ template<class NextLayer>
 template<class Buffers, class Handler>
 class stream<NextLayer>::write_op
 {
-    using alloc_type =
-        handler_alloc<char, Handler>;
-
     struct data : op
     {
         stream<NextLayer>& ws;
         consuming_buffers<Buffers> cb;
-        Handler h;
         std::size_t remain;
         bool cont;
         int state = 0;
 
-        template<class DeducedHandler>
-        data(DeducedHandler&& h_,
+        data(Handler& handler,
             stream<NextLayer>& ws_, Buffers const& bs)
             : ws(ws_)
             , cb(bs)
-            , h(std::forward<DeducedHandler>(h_))
             , remain(boost::asio::buffer_size(cb))
             , cont(boost_asio_handler_cont_helpers::
-                is_continuation(h))
+                is_continuation(handler))
         {
         }
     };
 
-    std::shared_ptr<data> d_;
+    handler_ptr<data, Handler> d_;
 
 public:
     write_op(write_op&&) = default;
@@ -60,10 +55,11 @@ public:
     explicit
     write_op(DeducedHandler&& h,
             stream<NextLayer>& ws, Args&&... args)
-        : d_(std::allocate_shared<data>(alloc_type{h},
-            std::forward<DeducedHandler>(h), ws,
-                std::forward<Args>(args)...))
+        : d_(std::forward<DeducedHandler>(h), ws,
+                std::forward<Args>(args)...)
     {
+        beast::detail::trace(&*d_,
+            "websocket::write_op", trace_kind::begin);
         (*this)(error_code{}, false);
     }
 
@@ -74,7 +70,7 @@ public:
         std::size_t size, write_op* op)
     {
         return boost_asio_handler_alloc_helpers::
-            allocate(size, op->d_->h);
+            allocate(size, op->d_.handler());
     }
 
     friend
@@ -82,7 +78,7 @@ public:
         void* p, std::size_t size, write_op* op)
     {
         return boost_asio_handler_alloc_helpers::
-            deallocate(p, size, op->d_->h);
+            deallocate(p, size, op->d_.handler());
     }
 
     friend
@@ -96,7 +92,7 @@ public:
     void asio_handler_invoke(Function&& f, write_op* op)
     {
         return boost_asio_handler_invoke_helpers::
-            invoke(f, op->d_->h);
+            invoke(f, op->d_.handler());
     }
 };
 
@@ -111,6 +107,8 @@ operator()(error_code ec, bool again)
     d.cont = d.cont || again;
     if(! ec)
     {
+        beast::detail::trace(&d,
+            "websocket::write_op", trace_kind::step, d.state);
         switch(d.state)
         {
         case 0:
@@ -131,7 +129,9 @@ operator()(error_code ec, bool again)
             break;
         }
     }
-    d.h(ec);
+    beast::detail::trace(&d,
+        "websocket::write_op", trace_kind::end, ec.value());
+    d_.invoke(ec);
 }
 
 } // websocket
@@ -337,6 +337,48 @@ struct read_message_max
 };
 #endif
 
+/** Release-when-idle option.
+
+    When enabled, the stream frees the memory of its internal read
+    buffer whenever the buffer is empty, including the memory left
+    over from reading the handshake. A server holding a large number
+    of mostly idle connections then keeps no buffer memory for them.
+    When the next layer is a socket and a read buffer size is set,
+    buffered reads wait for the socket to become readable before
+    acquiring a buffer.
+
+    The read buffer is a @ref pooled_streambuf, so the memory freed
+    by an idle connection is kept in the @ref streambuf_pool of the
+    thread, and reused by the next connection on that thread which
+    receives data.
+
+    The default is `false`.
+
+    @note Objects of this type are passed to @ref stream::set_option.
+
+    @par Example
+    Releasing the read buffer of idle connections.
+    @code
+    ...
+    websocket::stream<ip::tcp::socket> ws(ios);
+    ws.set_option(release_when_idle{true});
+    @endcode
+*/
+#if GENERATING_DOCS
+using release_when_idle = implementation_defined;
+#else
+struct release_when_idle
+{
+    bool value;
+
+    explicit
+    release_when_idle(bool v)
+        : value(v)
+    {
+    }
+};
+#endif
+
 } // websocket
 } // beast
 
@@ -14,6 +14,7 @@
 #include <beast/http/string_body.hpp>
 #include <beast/core/dynabuf_readstream.hpp>
 #include <beast/core/async_completion.hpp>
+#include <beast/core/streambuf_pool.hpp>
 #include <beast/core/detail/get_lowest_layer.hpp>
 #include <boost/asio.hpp>
 #include <boost/utility/string_ref.hpp>
@@ -84,9 +85,11 @@ struct frame_info
 template<class NextLayer>
 class stream : public detail::stream_base
 {
+    friend class alloc_budget_test;
+    friend class footprint_test;
     friend class stream_test;
 
-    dynabuf_readstream<NextLayer, streambuf> stream_;
+    dynabuf_readstream<NextLayer, pooled_streambuf> stream_;
 
 public:
     /// The type of the next layer.
@@ -202,7 +205,11 @@ public:
     void
     set_option(pong_callback o)
     {
-        pong_cb_ = std::move(o.value);
+        if(o.value)
+            pong_cb_.reset(new detail::pong_cb(
+                std::move(o.value)));
+        else
+            pong_cb_.reset();
     }
 
     /// Set the read buffer size
@@ -219,6 +226,13 @@ public:
         rd_msg_max_ = o.value;
     }
 
+    /// Set whether the read buffer is released while idle
+    void
+    set_option(release_when_idle const& o)
+    {
+        stream_.release_when_idle(o.value);
+    }
+
     /// Set the size of the mask buffer
     void
     set_option(mask_buffer_size const& o)
@@ -309,6 +323,23 @@ public:
         return cr_;
     }
 
+    /** Returns the statistics recorded for the stream.
+
+        The counts include the frames and messages sent and received,
+        the control frames among them, the largest payload buffers,
+        and the time spent masking and validating UTF-8. Transport
+        operations are counted by using a @ref stats_stream as the
+        next layer.
+
+        All counts are zero unless the macro `BEAST_STREAM_STATS`
+        is defined to 1.
+    */
+    stream_stats const&
+    stats() const
+    {
+        return recorder().get();
+    }
+
     /** Read and respond to a WebSocket HTTP Upgrade request.
 
         This function is used to synchronously read a HTTP WebSocket
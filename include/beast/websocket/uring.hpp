@@ -0,0 +1,63 @@
+//
+// Copyright (c) 2013-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BEAST_WEBSOCKET_URING_HPP
+#define BEAST_WEBSOCKET_URING_HPP
+
+#if defined(__linux__)
+
+#include <beast/websocket/teardown.hpp>
+#include <beast/core/uring_stream.hpp>
+
+namespace beast {
+
+// These overloads are found by argument dependent lookup from
+// the websocket_helpers namespace, so they are declared in the
+// namespace of uring_stream rather than in websocket.
+
+/** Tear down a @ref uring_stream.
+
+    This shuts down the sending side of the socket, reads until
+    the remote end closes its side, and closes the socket.
+
+    @param stream The stream to tear down.
+
+    @param ec Set to the error if any occurred.
+*/
+void
+teardown(uring_stream& stream, error_code& ec);
+
+/** Start tearing down a @ref uring_stream.
+
+    This begins tearing down a connection asynchronously, by
+    shutting down the sending side of the socket, reading until
+    the remote end closes its side, and closing the socket.
+
+    @param stream The stream to tear down.
+
+    @param handler The handler to be called when the request completes.
+    Copies will be made of the handler as required. The equivalent
+    function signature of the handler must be:
+    @code void handler(
+        error_code const& error // result of operation
+    ); @endcode
+    Regardless of whether the asynchronous operation completes
+    immediately or not, the handler will not be invoked from within
+    this function. Invocation of the handler will be performed in a
+    manner equivalent to using boost::asio::io_service::post().
+*/
+template<class TeardownHandler>
+void
+async_teardown(uring_stream& stream, TeardownHandler&& handler);
+
+} // beast
+
+#include <beast/websocket/impl/uring.ipp>
+
+#endif
+
+#endif
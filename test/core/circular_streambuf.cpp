@@ -0,0 +1,119 @@
+//
+// Copyright (c) 2013-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Test that header file is self-contained.
+#include <beast/core/circular_streambuf.hpp>
+
+#if ! defined(_WIN32)
+
+#include <beast/core/buffer_concepts.hpp>
+#include <beast/core/dynabuf_readstream.hpp>
+#include <beast/core/to_string.hpp>
+#include <beast/test/string_stream.hpp>
+#include <beast/unit_test/suite.hpp>
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/read.hpp>
+#include <stdexcept>
+#include <string>
+
+namespace beast {
+
+static_assert(is_DynamicBuffer<circular_streambuf>::value, "");
+
+class circular_streambuf_test : public beast::unit_test::suite
+{
+public:
+    static
+    void
+    put(circular_streambuf& sb, std::string const& s)
+    {
+        using boost::asio::buffer;
+        using boost::asio::buffer_copy;
+        sb.commit(buffer_copy(sb.prepare(s.size()), buffer(s)));
+    }
+
+    void
+    testWrap()
+    {
+        circular_streambuf sb(1);
+        auto const cap = sb.capacity();
+        expect(cap > 0);
+        expect(sb.max_size() == cap);
+        std::string const a(cap - 10, 'a');
+        put(sb, a);
+        // keep the input at the end of the ring
+        sb.prepare(0);
+        sb.consume(cap - 20);
+        expect(sb.size() == 10);
+        // The output sequence wraps around
+        std::string const b(cap - 30, 'b');
+        put(sb, b);
+        expect(sb.size() == cap - 20);
+        auto const cb = sb.data();
+        expect(std::distance(cb.begin(), cb.end()) == 1);
+        expect(to_string(sb.data()) ==
+            std::string(10, 'a') + b);
+        sb.consume(15);
+        expect(to_string(sb.data()) == b.substr(5));
+        expect(read_size_helper(sb, 65536) == 35);
+        try
+        {
+            sb.prepare(36);
+            fail();
+        }
+        catch(std::length_error const&)
+        {
+            pass();
+        }
+        sb.consume(sb.size());
+        expect(sb.size() == 0);
+        expect(read_size_helper(sb, 65536) == cap);
+    }
+
+    void
+    testMove()
+    {
+        circular_streambuf sb(100);
+        put(sb, "abc");
+        circular_streambuf sb2(std::move(sb));
+        expect(sb.capacity() == 0);
+        expect(to_string(sb2.data()) == "abc");
+        sb = std::move(sb2);
+        expect(to_string(sb.data()) == "abc");
+        expect(sb2.capacity() == 0);
+    }
+
+    void
+    testReadStream()
+    {
+        boost::asio::io_service ios;
+        std::string s;
+        for(int i = 0; i < 2000; ++i)
+            s += std::to_string(i) + ",";
+        dynabuf_readstream<test::string_stream,
+            circular_streambuf> srs(ios, s);
+        srs.buffer() = circular_streambuf(1);
+        srs.capacity(1000);
+        std::string got;
+        got.resize(s.size());
+        boost::asio::read(srs, boost::asio::buffer(&got[0], got.size()));
+        expect(got == s);
+    }
+
+    void run() override
+    {
+        testWrap();
+        testMove();
+        testReadStream();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(circular_streambuf,core,beast);
+
+} // beast
+
+#endif
@@ -0,0 +1,348 @@
+//
+// Copyright (c) 2013-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Measures the buffer sequence adapters and stream buffers across
+// element counts and element sizes: iteration, buffer_size,
+// buffer_copy, and cycles of prepare, commit and consume. Each line
+// reports the time per operation and the bytes per second it covers.
+//
+// usage: core-bench [seconds per case] [name filter]
+
+#include <beast/core/buffer_cat.hpp>
+#include <beast/core/buffers_adapter.hpp>
+#include <beast/core/circular_streambuf.hpp>
+#include <beast/core/consuming_buffers.hpp>
+#include <beast/core/flat_streambuf.hpp>
+#include <beast/core/prepare_buffers.hpp>
+#include <beast/core/static_streambuf.hpp>
+#include <beast/core/streambuf.hpp>
+#include <boost/asio/buffer.hpp>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace beast {
+
+// A buffer sequence referring to a range of buffers stored
+// elsewhere, so that copying the sequence is cheap as it
+// is for the sequences used on real hot paths.
+template<class Buffer>
+class buffer_range
+{
+    Buffer const* begin_;
+    Buffer const* end_;
+
+public:
+    using value_type = Buffer;
+    using const_iterator = Buffer const*;
+
+    explicit
+    buffer_range(std::vector<Buffer> const& v)
+        : begin_(v.data())
+        , end_(v.data() + v.size())
+    {
+    }
+
+    const_iterator
+    begin() const
+    {
+        return begin_;
+    }
+
+    const_iterator
+    end() const
+    {
+        return end_;
+    }
+};
+
+// Keeps results alive so the work is not optimized away
+std::size_t volatile sink;
+
+template<class ConstBufferSequence>
+std::size_t
+iterate(ConstBufferSequence const& buffers)
+{
+    using boost::asio::buffer_cast;
+    using boost::asio::buffer_size;
+    std::size_t n = 0;
+    for(auto it = buffers.begin(); it != buffers.end(); ++it)
+    {
+        typename ConstBufferSequence::value_type b(*it);
+        n += buffer_size(b) +
+            *buffer_cast<char const*>(b);
+    }
+    return n;
+}
+
+template<class DynamicBuffer>
+void
+rewind(DynamicBuffer&)
+{
+}
+
+// A static stream buffer does not reuse consumed space
+template<std::size_t N>
+void
+rewind(static_streambuf_n<N>& sb)
+{
+    sb.reset();
+}
+
+class bench
+{
+    using clock_type = std::chrono::steady_clock;
+
+    double seconds_;
+    std::string filter_;
+    std::size_t elements_ = 0;
+    std::size_t size_ = 0;
+
+public:
+    bench(double seconds, std::string filter)
+        : seconds_(seconds)
+        , filter_(std::move(filter))
+    {
+    }
+
+    void
+    run()
+    {
+        std::cout <<
+            std::left << std::setw(30) << "case" <<
+            std::right << std::setw(9) << "elements" <<
+            std::setw(8) << "size" <<
+            std::setw(12) << "ns/op" <<
+            std::setw(12) << "MB/s" << std::endl;
+        for(auto elements : {1, 4, 16, 64})
+        {
+            for(auto size : {64, 1500, 16384})
+            {
+                elements_ = elements;
+                size_ = size;
+                sequences();
+                dynabufs();
+            }
+        }
+    }
+
+private:
+    // Call f repeatedly for the configured time, f
+    // returns a value which must not be optimized away.
+    void
+    measure(std::string const& name,
+        std::size_t bytes, std::function<std::size_t()> const& f)
+    {
+        if(! filter_.empty() &&
+                name.find(filter_) == std::string::npos)
+            return;
+        std::size_t n = 0;
+        std::size_t ops = 0;
+        auto const t0 = clock_type::now();
+        double elapsed;
+        do
+        {
+            for(int i = 0; i < 64; ++i)
+                n += f();
+            ops += 64;
+            elapsed = std::chrono::duration<double>(
+                clock_type::now() - t0).count();
+        }
+        while(elapsed < seconds_);
+        sink = n;
+        std::cout << std::fixed <<
+            std::left << std::setw(30) << name <<
+            std::right << std::setw(9) << elements_ <<
+            std::setw(8) << size_ <<
+            std::setprecision(1) <<
+            std::setw(12) << elapsed * 1e9 / ops <<
+            std::setprecision(0) <<
+            std::setw(12) << bytes * ops / elapsed / (1024 * 1024) <<
+            std::endl;
+    }
+
+    void
+    sequences()
+    {
+        using boost::asio::buffer_copy;
+        using boost::asio::buffer_size;
+        using boost::asio::const_buffer;
+        using boost::asio::const_buffers_1;
+        using boost::asio::mutable_buffer;
+        using boost::asio::mutable_buffers_1;
+        auto const total = elements_ * size_;
+        std::vector<char> storage(total, 'x');
+        std::vector<char> dest(total + 64);
+        std::vector<const_buffer> cv;
+        std::vector<mutable_buffer> mv;
+        for(std::size_t i = 0; i < elements_; ++i)
+        {
+            cv.emplace_back(&storage[i * size_], size_);
+            mv.emplace_back(&storage[i * size_], size_);
+        }
+        buffer_range<const_buffer> const cb(cv);
+        buffer_range<mutable_buffer> const mb(mv);
+        // A small header in front of a body, in
+        // the way HTTP and WebSocket writers use it.
+        char const header[16] = {};
+        const_buffers_1 const hb(header, sizeof(header));
+
+        measure("range iterate", total,
+            [&]
+            {
+                return iterate(cb);
+            });
+        measure("range buffer_size", total,
+            [&]
+            {
+                return buffer_size(cb);
+            });
+        measure("range buffer_copy", total,
+            [&]
+            {
+                return buffer_copy(
+                    mutable_buffers_1(dest.data(), dest.size()), cb);
+            });
+        measure("buffer_cat iterate", total + 16,
+            [&]
+            {
+                return iterate(buffer_cat(hb, cb));
+            });
+        measure("buffer_cat buffer_size", total + 16,
+            [&]
+            {
+                return buffer_size(buffer_cat(hb, cb));
+            });
+        measure("buffer_cat buffer_copy", total + 16,
+            [&]
+            {
+                return buffer_copy(
+                    mutable_buffers_1(dest.data(), dest.size()),
+                        buffer_cat(hb, cb));
+            });
+        measure("prepare_buffers iterate", total / 2,
+            [&]
+            {
+                return iterate(prepare_buffers(total / 2, cb));
+            });
+        measure("prepare_buffers buffer_size", total / 2,
+            [&]
+            {
+                return buffer_size(prepare_buffers(total / 2, cb));
+            });
+        // Eight partial writes, each followed by a size check
+        // as a composed write operation does.
+        measure("consuming_buffers consume", total,
+            [&]
+            {
+                consuming_buffers<buffer_range<const_buffer>> b(cb);
+                auto const step = (total + 7) / 8;
+                std::size_t n = 0;
+                while(buffer_size(b) > 0)
+                {
+                    b.consume(step);
+                    ++n;
+                }
+                return n;
+            });
+        measure("consuming_buffers iterate", total - total / 3,
+            [&]
+            {
+                consuming_buffers<buffer_range<const_buffer>> b(cb);
+                b.consume(total / 3);
+                return iterate(b);
+            });
+        // Fill the whole sequence an element at a time, then read it
+        measure("buffers_adapter cycle", total,
+            [&]
+            {
+                buffers_adapter<buffer_range<mutable_buffer>> b(mb);
+                for(std::size_t i = 0; i < elements_; ++i)
+                {
+                    sink = buffer_size(b.prepare(size_));
+                    b.commit(size_);
+                }
+                auto const n = iterate(b.data());
+                b.consume(total);
+                return n;
+            });
+    }
+
+    // One cycle prepares and commits `elements_` blocks of `size_`
+    // bytes, iterates the input sequence, then consumes it all.
+    template<class DynamicBuffer>
+    void
+    cycle(std::string const& name, DynamicBuffer& db)
+    {
+        using boost::asio::buffer_size;
+        measure(name + " cycle", elements_ * size_,
+            [&]
+            {
+                for(std::size_t i = 0; i < elements_; ++i)
+                {
+                    auto const mb = db.prepare(size_);
+                    for(auto it = mb.begin(); it != mb.end(); ++it)
+                    {
+                        boost::asio::mutable_buffer b(*it);
+                        if(buffer_size(b) > 0)
+                            *boost::asio::buffer_cast<char*>(b) = 'x';
+                    }
+                    db.commit(size_);
+                }
+                auto const n = iterate(db.data());
+                db.consume(db.size());
+                rewind(db);
+                return n;
+            });
+    }
+
+    void
+    dynabufs()
+    {
+        {
+            // Each block holds one element, so the input
+            // sequence spans `elements_` buffers.
+            streambuf sb(size_);
+            cycle("streambuf", sb);
+        }
+        {
+            flat_streambuf sb;
+            cycle("flat_streambuf", sb);
+        }
+        {
+            std::unique_ptr<static_streambuf_n<1024 * 1024>> sb(
+                new static_streambuf_n<1024 * 1024>);
+            cycle("static_streambuf", *sb);
+        }
+    #if ! defined(_WIN32)
+        {
+            circular_streambuf sb(elements_ * size_);
+            cycle("circular_streambuf", sb);
+        }
+    #endif
+    }
+};
+
+} // beast
+
+int
+main(int argc, char** argv)
+{
+    double seconds = 0.1;
+    std::string filter;
+    if(argc > 1)
+        seconds = std::atof(argv[1]);
+    if(argc > 2)
+        filter = argv[2];
+    beast::bench b(seconds, filter);
+    b.run();
+}
@@ -0,0 +1,85 @@
+//
+// Copyright (c) 2013-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Test that header file is self-contained.
+#include <beast/core/detail/thread_local_instance.hpp>
+
+#include <beast/unit_test/suite.hpp>
+#include <thread>
+
+namespace beast {
+namespace detail {
+
+class thread_local_instance_test
+    : public beast::unit_test::suite
+{
+public:
+    struct T
+    {
+        int v = 0;
+    };
+
+    using instance = thread_local_instance<T>;
+
+    // Destroyed after the instance, as it is constructed first
+    struct late
+    {
+        bool* seen_null;
+
+        ~late()
+        {
+            *seen_null = instance::get() == nullptr;
+        }
+    };
+
+    void
+    testPerThread()
+    {
+        auto const p = instance::get();
+        expect(p != nullptr);
+        expect(instance::get() == p);
+        p->v = 1;
+        T* other = nullptr;
+        int v = -1;
+        std::thread t(
+            [&]
+            {
+                other = instance::get();
+                v = other->v;
+            });
+        t.join();
+        expect(other != p);
+        expect(v == 0);
+    }
+
+    void
+    testThreadExit()
+    {
+        bool seen_null = false;
+        std::thread t(
+            [&]
+            {
+                static thread_local late l{&seen_null};
+                (void)l;
+                instance::get();
+            });
+        t.join();
+        expect(seen_null);
+    }
+
+    void
+    run() override
+    {
+        testPerThread();
+        testThreadExit();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(thread_local_instance,core,beast);
+
+} // detail
+} // beast
@@ -9,11 +9,13 @@
 #include <beast/core/dynabuf_readstream.hpp>
 
 #include <beast/core/streambuf.hpp>
+#include <beast/core/streambuf_pool.hpp>
 #include <beast/test/fail_stream.hpp>
 #include <beast/test/string_stream.hpp>
 #include <beast/test/yield_to.hpp>
 #include <beast/unit_test/suite.hpp>
 #include <boost/asio.hpp>
+#include <vector>
 
 namespace beast {
 
@@ -128,9 +130,191 @@ public:
         expect(n < limit);
     }
 
+    void testReleaseWhenIdle(yield_context do_yield)
+    {
+        using boost::asio::buffer;
+        std::string s;
+        s.resize(13);
+
+        {
+            streambuf_pool::shrink();
+            test::string_stream ss(ios_, "Hello, world!");
+            dynabuf_readstream<
+                test::string_stream&, pooled_streambuf> srs(ss);
+            srs.capacity(64);
+            srs.release_when_idle(true);
+            boost::system::error_code ec;
+            boost::asio::read(srs, buffer(&s[0], s.size()), ec);
+            expect(! ec, ec.message());
+            expect(s == "Hello, world!");
+            expect(srs.buffer().size() == 0);
+            // the buffer memory went back to the pool
+            expect(streambuf_pool::get_stats().blocks_held > 0);
+        }
+        {
+            streambuf_pool::shrink();
+            test::string_stream ss(ios_, "Hello, world!");
+            dynabuf_readstream<
+                test::string_stream&, pooled_streambuf> srs(ss);
+            srs.capacity(5);
+            srs.release_when_idle(true);
+            boost::system::error_code ec;
+            boost::asio::async_read(
+                srs, buffer(&s[0], s.size()), do_yield[ec]);
+            expect(! ec, ec.message());
+            expect(s == "Hello, world!");
+            expect(streambuf_pool::get_stats().blocks_held > 0);
+        }
+        {
+            // the released buffer keeps its allocation size
+            test::string_stream ss(ios_, "");
+            dynabuf_readstream<
+                test::string_stream&, streambuf> srs(ss);
+            srs.buffer() = streambuf{64};
+            srs.buffer().prepare(1);
+            srs.release_when_idle(true);
+            expect(srs.buffer().capacity() == 0);
+            srs.buffer().prepare(1);
+            expect(srs.buffer().capacity() == 64);
+        }
+        {
+            // buffered input is not released
+            test::string_stream ss(ios_, "");
+            dynabuf_readstream<
+                test::string_stream&, streambuf> srs(ss);
+            srs.release_when_idle(true);
+            srs.buffer().commit(boost::asio::buffer_copy(
+                srs.buffer().prepare(5), buffer("Hello", 5)));
+            char c[2];
+            expect(srs.read_some(buffer(c, 2)) == 2);
+            expect(srs.buffer().size() == 3);
+        }
+        {
+            // waits for readability on sockets
+            using socket_type = boost::asio::ip::tcp::socket;
+            boost::asio::io_service ios;
+            boost::asio::ip::tcp::acceptor a(ios,
+                boost::asio::ip::tcp::endpoint{
+                    boost::asio::ip::address_v4::loopback(), 0});
+            socket_type out(ios);
+            out.connect(a.local_endpoint());
+            dynabuf_readstream<socket_type, streambuf> srs(ios);
+            a.accept(srs.next_layer());
+            srs.capacity(64);
+            srs.release_when_idle(true);
+            boost::asio::write(out, buffer("Hello, world!", 13));
+            boost::system::error_code ec;
+            boost::asio::read(srs, buffer(&s[0], s.size()), ec);
+            expect(! ec, ec.message());
+            expect(s == "Hello, world!");
+        }
+    }
+
+    // Records the size of each read, and
+    // returns up to the next chunk size
+    class chunk_stream
+    {
+        boost::asio::io_service& ios_;
+        std::vector<std::size_t> chunks_;
+
+    public:
+        std::vector<std::size_t> sizes;
+
+        chunk_stream(boost::asio::io_service& ios,
+                std::vector<std::size_t> chunks)
+            : ios_(ios)
+            , chunks_(std::move(chunks))
+        {
+        }
+
+        boost::asio::io_service&
+        get_io_service()
+        {
+            return ios_;
+        }
+
+        template<class MutableBufferSequence>
+        std::size_t
+        read_some(MutableBufferSequence const& buffers)
+        {
+            error_code ec;
+            auto const n = read_some(buffers, ec);
+            if(ec)
+                throw system_error{ec};
+            return n;
+        }
+
+        template<class MutableBufferSequence>
+        std::size_t
+        read_some(MutableBufferSequence const& buffers,
+            error_code& ec)
+        {
+            auto const size =
+                boost::asio::buffer_size(buffers);
+            sizes.push_back(size);
+            if(chunks_.empty())
+            {
+                ec = boost::asio::error::eof;
+                return 0;
+            }
+            auto const n = (std::min)(size, chunks_.front());
+            chunks_.erase(chunks_.begin());
+            return n;
+        }
+    };
+
+    void testReadSizeLimit()
+    {
+        using boost::asio::buffer;
+        char buf[1024];
+        auto const read_all =
+            [&](dynabuf_readstream<chunk_stream, streambuf>& srs)
+            {
+                error_code ec;
+                while(! ec)
+                    srs.read_some(buffer(buf), ec);
+            };
+        {
+            // grows while reads fill the buffer,
+            // shrinks when they use less than a quarter
+            dynabuf_readstream<chunk_stream, streambuf> srs(
+                ios_, std::vector<std::size_t>{
+                    999, 999, 999, 999, 999, 999, 10, 999});
+            srs.capacity(16);
+            srs.read_size_limit(256);
+            read_all(srs);
+            expect(srs.next_layer().sizes ==
+                std::vector<std::size_t>{
+                    16, 32, 64, 128, 256, 256, 256, 128, 256});
+        }
+        {
+            // no limit means a fixed read size
+            dynabuf_readstream<chunk_stream, streambuf> srs(
+                ios_, std::vector<std::size_t>{999, 999});
+            srs.capacity(16);
+            read_all(srs);
+            expect(srs.next_layer().sizes ==
+                std::vector<std::size_t>{16, 16, 16});
+        }
+        {
+            // never smaller than the capacity
+            dynabuf_readstream<chunk_stream, streambuf> srs(
+                ios_, std::vector<std::size_t>{1, 1});
+            srs.capacity(16);
+            srs.read_size_limit(256);
+            read_all(srs);
+            expect(srs.next_layer().sizes ==
+                std::vector<std::size_t>{16, 16, 16});
+        }
+    }
+
     void run() override
     {
         testSpecialMembers();
+        testReadSizeLimit();
+
+        yield_to(std::bind(&self::testReleaseWhenIdle,
+            this, std::placeholders::_1));
 
         yield_to(std::bind(&self::testRead,
             this, std::placeholders::_1));
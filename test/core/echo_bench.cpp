@@ -0,0 +1,218 @@
+//
+// Copyright (c) 2013-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Measures TCP echo throughput over loopback with and
+// without recycle_handler wrapping the completion handlers.
+//
+// usage: echo-bench [threads] [connections] [seconds] [message size]
+
+#include <beast/core/recycle_handler.hpp>
+#include <boost/asio.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace beast {
+
+struct plain_wrap
+{
+    template<class Handler>
+    Handler
+    operator()(Handler&& h) const
+    {
+        return std::forward<Handler>(h);
+    }
+};
+
+struct recycle_wrap
+{
+    template<class Handler>
+    detail::recycled_handler<typename std::decay<Handler>::type>
+    operator()(Handler&& h) const
+    {
+        return recycle_handler(std::forward<Handler>(h));
+    }
+};
+
+// One end of an echo connection. The client sends a message and
+// waits for it to come back, the server writes back what it reads.
+template<class Wrap>
+class echo_peer
+    : public std::enable_shared_from_this<echo_peer<Wrap>>
+{
+    using socket_type = boost::asio::ip::tcp::socket;
+    using error_code = boost::system::error_code;
+
+    socket_type sock_;
+    std::vector<char> buf_;
+    std::atomic<std::size_t>& count_;
+    std::atomic<bool>& stop_;
+    bool client_;
+    Wrap wrap_;
+
+public:
+    echo_peer(socket_type&& sock, std::size_t size,
+            std::atomic<std::size_t>& count,
+                std::atomic<bool>& stop, bool client)
+        : sock_(std::move(sock))
+        , buf_(size, 'x')
+        , count_(count)
+        , stop_(stop)
+        , client_(client)
+    {
+    }
+
+    void
+    run()
+    {
+        if(client_)
+            do_write(buf_.size());
+        else
+            do_read();
+    }
+
+private:
+    void
+    do_read()
+    {
+        auto self = this->shared_from_this();
+        if(client_)
+            boost::asio::async_read(sock_,
+                boost::asio::buffer(buf_), wrap_(
+                    [self](error_code ec, std::size_t n)
+                    {
+                        self->on_read(ec, n);
+                    }));
+        else
+            sock_.async_read_some(
+                boost::asio::buffer(buf_), wrap_(
+                    [self](error_code ec, std::size_t n)
+                    {
+                        self->on_read(ec, n);
+                    }));
+    }
+
+    void
+    on_read(error_code ec, std::size_t n)
+    {
+        if(ec || stop_)
+            return close();
+        if(client_)
+            ++count_;
+        do_write(n);
+    }
+
+    void
+    do_write(std::size_t n)
+    {
+        auto self = this->shared_from_this();
+        boost::asio::async_write(sock_,
+            boost::asio::buffer(buf_.data(), n), wrap_(
+                [self](error_code ec, std::size_t)
+                {
+                    self->on_write(ec);
+                }));
+    }
+
+    void
+    on_write(error_code ec)
+    {
+        if(ec || stop_)
+            return close();
+        do_read();
+    }
+
+    void
+    close()
+    {
+        error_code ec;
+        sock_.shutdown(socket_type::shutdown_both, ec);
+        sock_.close(ec);
+    }
+};
+
+struct options
+{
+    std::size_t threads = 4;
+    std::size_t connections = 64;
+    std::size_t seconds = 5;
+    std::size_t size = 64;
+};
+
+// Returns the number of round trips per second
+template<class Wrap>
+double
+bench(options const& opt)
+{
+    using namespace boost::asio;
+    io_service ios;
+    std::atomic<std::size_t> count{0};
+    std::atomic<bool> stop{false};
+    ip::tcp::acceptor acceptor(ios, ip::tcp::endpoint{
+        ip::address_v4::loopback(), 0});
+    for(std::size_t i = 0; i < opt.connections; ++i)
+    {
+        ip::tcp::socket client(ios);
+        ip::tcp::socket server(ios);
+        client.connect(acceptor.local_endpoint());
+        acceptor.accept(server);
+        client.set_option(ip::tcp::no_delay{true});
+        server.set_option(ip::tcp::no_delay{true});
+        std::make_shared<echo_peer<Wrap>>(std::move(server),
+            opt.size, count, stop, false)->run();
+        std::make_shared<echo_peer<Wrap>>(std::move(client),
+            opt.size, count, stop, true)->run();
+    }
+    std::vector<std::thread> v;
+    v.reserve(opt.threads);
+    for(std::size_t i = 0; i < opt.threads; ++i)
+        v.emplace_back([&]{ ios.run(); });
+    // Let the connections reach a steady state
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+    auto const n0 = count.load();
+    auto const t0 = std::chrono::steady_clock::now();
+    std::this_thread::sleep_for(std::chrono::seconds(opt.seconds));
+    auto const n1 = count.load();
+    auto const t1 = std::chrono::steady_clock::now();
+    stop = true;
+    for(auto& t : v)
+        t.join();
+    return (n1 - n0) / std::chrono::duration<
+        double>(t1 - t0).count();
+}
+
+} // beast
+
+int
+main(int argc, char** argv)
+{
+    beast::options opt;
+    if(argc > 1)
+        opt.threads = std::strtoul(argv[1], nullptr, 10);
+    if(argc > 2)
+        opt.connections = std::strtoul(argv[2], nullptr, 10);
+    if(argc > 3)
+        opt.seconds = std::strtoul(argv[3], nullptr, 10);
+    if(argc > 4)
+        opt.size = std::strtoul(argv[4], nullptr, 10);
+    std::cout <<
+        "threads=" << opt.threads <<
+        " connections=" << opt.connections <<
+        " seconds=" << opt.seconds <<
+        " size=" << opt.size << std::endl;
+    auto const plain = beast::bench<beast::plain_wrap>(opt);
+    std::cout << "default:         " <<
+        static_cast<std::size_t>(plain) << " round trips/s" << std::endl;
+    auto const recycled = beast::bench<beast::recycle_wrap>(opt);
+    std::cout << "recycle_handler: " <<
+        static_cast<std::size_t>(recycled) << " round trips/s" << std::endl;
+    std::cout << "ratio: " << recycled / plain << std::endl;
+}
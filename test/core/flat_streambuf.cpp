@@ -0,0 +1,161 @@
+//
+// Copyright (c) 2013-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Test that header file is self-contained.
+#include <beast/core/flat_streambuf.hpp>
+
+#include <beast/core/to_string.hpp>
+#include <beast/core/buffer_concepts.hpp>
+#include <beast/unit_test/suite.hpp>
+#include <boost/asio/buffer.hpp>
+#include <stdexcept>
+#include <string>
+
+namespace beast {
+
+static_assert(is_DynamicBuffer<flat_streambuf>::value, "");
+
+class flat_streambuf_test : public beast::unit_test::suite
+{
+public:
+    template<class ConstBufferSequence>
+    static
+    std::size_t
+    count(ConstBufferSequence const& buffers)
+    {
+        return std::distance(buffers.begin(), buffers.end());
+    }
+
+    static
+    void
+    put(flat_streambuf& sb, std::string const& s)
+    {
+        using boost::asio::buffer;
+        using boost::asio::buffer_copy;
+        sb.commit(buffer_copy(sb.prepare(s.size()), buffer(s)));
+    }
+
+    void
+    testPrepareCommit()
+    {
+        flat_streambuf sb;
+        expect(sb.size() == 0);
+        expect(sb.capacity() == 0);
+        put(sb, "Hello, ");
+        put(sb, "world!");
+        expect(count(sb.data()) == 1);
+        expect(to_string(sb.data()) == "Hello, world!");
+        expect(sb.capacity() >= 512);
+        // commit is clamped to the output sequence
+        sb.prepare(3);
+        sb.commit(100);
+        expect(sb.size() == 16);
+        sb.consume(13);
+        expect(sb.size() == 3);
+        sb.consume(100);
+        expect(sb.size() == 0);
+    }
+
+    void
+    testCompact()
+    {
+        flat_streambuf sb;
+        std::string const s(400, '*');
+        put(sb, s);
+        auto const cap = sb.capacity();
+        sb.consume(300);
+        // 100 bytes left, moved to the front
+        put(sb, s);
+        expect(sb.capacity() == cap);
+        expect(sb.size() == 500);
+        expect(to_string(sb.data()) == std::string(500, '*'));
+    }
+
+    void
+    testGrow()
+    {
+        flat_streambuf sb;
+        std::string s;
+        for(int i = 0; i < 1000; ++i)
+        {
+            auto const t = std::to_string(i);
+            put(sb, t);
+            s += t;
+        }
+        expect(count(sb.data()) == 1);
+        expect(to_string(sb.data()) == s);
+        expect(sb.capacity() < 2 * s.size() + 512);
+        sb.shrink_to_fit();
+        expect(sb.capacity() == s.size());
+        expect(to_string(sb.data()) == s);
+        sb.consume(sb.size());
+        sb.shrink_to_fit();
+        expect(sb.capacity() == 0);
+    }
+
+    void
+    testLimit()
+    {
+        flat_streambuf sb(10);
+        expect(sb.max_size() == 10);
+        put(sb, "12345");
+        try
+        {
+            sb.prepare(6);
+            fail();
+        }
+        catch(std::length_error const&)
+        {
+            pass();
+        }
+        put(sb, "67890");
+        expect(sb.capacity() == 10);
+        try
+        {
+            flat_streambuf sb2(0);
+            fail();
+        }
+        catch(std::invalid_argument const&)
+        {
+            pass();
+        }
+    }
+
+    void
+    testSpecial()
+    {
+        flat_streambuf sb;
+        put(sb, "abc");
+        flat_streambuf sb2(sb);
+        expect(to_string(sb2.data()) == "abc");
+        flat_streambuf sb3(std::move(sb));
+        expect(sb.size() == 0);
+        expect(sb.capacity() == 0);
+        expect(to_string(sb3.data()) == "abc");
+        sb = sb3;
+        expect(to_string(sb.data()) == "abc");
+        sb2 = std::move(sb3);
+        expect(to_string(sb2.data()) == "abc");
+        expect(sb3.size() == 0);
+        sb2 << "def" << 1;
+        expect(to_string(sb2.data()) == "abcdef1");
+        expect(read_size_helper(sb2, 1000) > 0);
+    }
+
+    void run() override
+    {
+        testPrepareCommit();
+        testCompact();
+        testGrow();
+        testLimit();
+        testSpecial();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(flat_streambuf,core,beast);
+
+} // beast
@@ -0,0 +1,206 @@
+//
+// Copyright (c) 2013-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Test that header file is self-contained.
+#include <beast/core/handler_ptr.hpp>
+
+#include <beast/unit_test/suite.hpp>
+#include <atomic>
+#include <cstdlib>
+#include <stdexcept>
+#include <thread>
+
+namespace beast {
+
+class handler_ptr_test : public beast::unit_test::suite
+{
+public:
+    struct counts
+    {
+        std::atomic<int> allocs{0};
+        std::atomic<int> frees{0};
+        int calls = 0;
+        int live = 0;   // owned objects alive
+        int freed_at_call = -1;
+    };
+
+    // A handler which counts its allocations
+    struct handler
+    {
+        counts* c;
+
+        explicit
+        handler(counts& c_)
+            : c(&c_)
+        {
+        }
+
+        void
+        operator()(int v)
+        {
+            ++c->calls;
+            c->freed_at_call = c->frees;
+            c->live += v;
+        }
+
+        friend
+        void*
+        asio_handler_allocate(std::size_t size, handler* h)
+        {
+            ++h->c->allocs;
+            return std::malloc(size);
+        }
+
+        friend
+        void
+        asio_handler_deallocate(
+            void* p, std::size_t, handler* h)
+        {
+            ++h->c->frees;
+            std::free(p);
+        }
+    };
+
+    struct data
+    {
+        counts& c;
+        int v;
+
+        data(handler& h, int v_)
+            : c(*h.c)
+            , v(v_)
+        {
+            ++c.live;
+        }
+
+        ~data()
+        {
+            --c.live;
+        }
+    };
+
+    struct throwing
+    {
+        throwing(handler&)
+        {
+            throw std::runtime_error("");
+        }
+    };
+
+    void
+    testInvoke()
+    {
+        counts c;
+        {
+            handler_ptr<data, handler> p(handler{c}, 42);
+            expect(c.allocs == 1);
+            expect(c.live == 1);
+            expect(p->v == 42);
+            expect((*p).v == 42);
+            expect(&p.handler() != nullptr);
+            p.invoke(0);
+            expect(p.get() == nullptr);
+            expect(c.calls == 1);
+            // memory was freed before the upcall
+            expect(c.freed_at_call == 1);
+            expect(c.live == 0);
+        }
+        expect(c.frees == 1);
+    }
+
+    void
+    testDestroy()
+    {
+        counts c;
+        {
+            handler_ptr<data, handler> p1(handler{c}, 1);
+            {
+                auto p2 = p1;
+                expect(p2.get() == p1.get());
+                handler_ptr<data, handler> p3(std::move(p2));
+                expect(p2.get() == nullptr);
+                expect(p3.get() == p1.get());
+            }
+            expect(c.live == 1);
+            expect(c.frees == 0);
+        }
+        expect(c.calls == 0);
+        expect(c.live == 0);
+        expect(c.allocs == 1);
+        expect(c.frees == 1);
+    }
+
+    void
+    testShared()
+    {
+        counts c;
+        {
+            handler_ptr<data, handler> p1(handler{c}, 1);
+            auto p2 = p1;
+            p1.invoke(0);
+            expect(c.calls == 1);
+            expect(c.live == 0);
+            // the other copy still holds the memory
+            expect(c.frees == 0);
+        }
+        expect(c.frees == 1);
+    }
+
+    void
+    testThreads()
+    {
+        // A copy released on another thread while
+        // the operation invokes its handler.
+        counts c;
+        for(int i = 0; i < 1000; ++i)
+        {
+            handler_ptr<data, handler> p1(handler{c}, 1);
+            auto p2 = p1;
+            std::thread t(
+                [&p2]
+                {
+                    auto p3 = std::move(p2);
+                });
+            p1.invoke(0);
+            t.join();
+        }
+        expect(c.calls == 1000);
+        expect(c.live == 0);
+        expect(c.allocs == 1000);
+        expect(c.frees == 1000);
+    }
+
+    void
+    testThrow()
+    {
+        counts c;
+        try
+        {
+            handler_ptr<throwing, handler> p(handler{c});
+            fail();
+        }
+        catch(std::runtime_error const&)
+        {
+            pass();
+        }
+        expect(c.allocs == 1);
+        expect(c.frees == 1);
+    }
+
+    void run() override
+    {
+        testInvoke();
+        testDestroy();
+        testShared();
+        testThreads();
+        testThrow();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(handler_ptr,core,beast);
+
+} // beast
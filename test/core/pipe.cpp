@@ -0,0 +1,331 @@
+//
+// Copyright (c) 2013-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Test that header file is self-contained.
+#include <beast/test/pipe.hpp>
+
+#include <beast/core/streambuf.hpp>
+#include <beast/http/read.hpp>
+#include <beast/http/string_body.hpp>
+#include <beast/http/write.hpp>
+#include <beast/test/ws_echo.hpp>
+#include <beast/unit_test/suite.hpp>
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/error.hpp>
+#include <boost/asio/io_service.hpp>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <thread>
+
+namespace beast {
+namespace test {
+
+class pipe_test : public unit_test::suite
+{
+public:
+    using ms = std::chrono::milliseconds;
+
+    void
+    testReadSize()
+    {
+        using boost::asio::buffer;
+        boost::asio::io_service ios;
+        pipe p(ios);
+        p.server.read_size(4);
+        p.client.write_some(buffer("Hello, world!", 13));
+        std::string s;
+        char buf[16];
+        for(auto const size : {4, 4, 4, 1})
+        {
+            auto const got = p.server.read_some(buffer(buf));
+            expect(got == static_cast<std::size_t>(size));
+            s.append(buf, got);
+        }
+        expect(s == "Hello, world!");
+
+        // Reads into a smaller buffer are limited by the buffer
+        p.client.write_some(buffer("abc", 3));
+        expect(p.server.read_some(buffer(buf, 2)) == 2);
+        expect(p.server.read_some(buffer(buf)) == 1);
+        expect(buf[0] == 'c');
+    }
+
+    void
+    testLatency()
+    {
+        using boost::asio::buffer;
+        boost::asio::io_service ios;
+        pipe p(ios);
+        p.server.latency(ms(20));
+        auto const start = pipe::clock_type::now();
+        p.client.write_some(buffer("abc", 3));
+        char buf[16];
+        std::size_t got = 0;
+        pipe::clock_type::time_point when;
+        p.server.async_read_some(buffer(buf),
+            [&](error_code ec, std::size_t n)
+            {
+                if(! ec)
+                    got = n;
+                when = pipe::clock_type::now();
+            });
+        // Nothing has arrived yet
+        ios.poll();
+        expect(got == 0);
+        // The timer completes the read
+        ios.run();
+        expect(got == 3);
+        expect(when - start >= ms(20));
+
+        // Synchronous reads wait for arrival
+        p.client.write_some(buffer("def", 3));
+        expect(p.server.read_some(buffer(buf)) == 3);
+        expect(pipe::clock_type::now() - start >= ms(40));
+    }
+
+    void
+    testClose()
+    {
+        using boost::asio::buffer;
+        boost::asio::io_service ios;
+        pipe p(ios);
+        char buf[16];
+        error_code ec;
+
+        // Data written before the close is read first
+        p.client.write_some(buffer("data", 4));
+        p.client.close();
+        expect(p.server.read_some(buffer(buf), ec) == 4);
+        expect(! ec, ec.message());
+        p.server.read_some(buffer(buf), ec);
+        expect(ec == boost::asio::error::eof, ec.message());
+
+        // Writes after the close fail
+        p.client.write_some(buffer("x", 1), ec);
+        expect(ec == boost::asio::error::bad_descriptor, ec.message());
+        p.server.write_some(buffer("x", 1), ec);
+        expect(ec == boost::asio::error::broken_pipe, ec.message());
+    }
+
+    void
+    testCloseDelayed()
+    {
+        using boost::asio::buffer;
+        boost::asio::io_service ios;
+        pipe p(ios);
+        p.server.latency(ms(10));
+        p.client.write_some(buffer("data", 4));
+        p.client.close();
+        char buf[16];
+        std::string s;
+        error_code result;
+        std::function<void()> do_read;
+        do_read =
+            [&]
+            {
+                p.server.async_read_some(buffer(buf),
+                    [&](error_code ec, std::size_t n)
+                    {
+                        s.append(buf, n);
+                        if(ec)
+                            result = ec;
+                        else
+                            do_read();
+                    });
+            };
+        do_read();
+        ios.run();
+        // eof only after the delayed data drains
+        expect(s == "data");
+        expect(result == boost::asio::error::eof, result.message());
+    }
+
+    void
+    testCancel()
+    {
+        using boost::asio::buffer;
+        boost::asio::io_service ios;
+        pipe p(ios);
+        char buf[16];
+        error_code result;
+        std::size_t got = 0;
+        auto const read =
+            [&]
+            {
+                p.server.async_read_some(buffer(buf),
+                    [&](error_code ec, std::size_t n)
+                    {
+                        result = ec;
+                        got = n;
+                    });
+            };
+
+        // Cancel a read waiting for data
+        read();
+        error_code ec;
+        p.server.cancel(ec);
+        expect(! ec, ec.message());
+        ios.run();
+        ios.reset();
+        expect(result == boost::asio::error::operation_aborted,
+            result.message());
+
+        // Cancel a read waiting for delayed data
+        p.server.latency(ms(20));
+        p.client.write_some(buffer("abc", 3));
+        read();
+        p.server.cancel(ec);
+        ios.run();
+        ios.reset();
+        expect(result == boost::asio::error::operation_aborted,
+            result.message());
+
+        // The pipe remains usable
+        read();
+        ios.run();
+        ios.reset();
+        expect(! result, result.message());
+        expect(got == 3);
+        expect(std::string(buf, 3) == "abc");
+
+        // Closing the reading end aborts its read
+        read();
+        p.server.close();
+        ios.run();
+        ios.reset();
+        expect(result == boost::asio::error::operation_aborted,
+            result.message());
+    }
+
+    void
+    testThreads()
+    {
+        using boost::asio::buffer;
+        boost::asio::io_service ios;
+        pipe p(ios);
+        p.server.read_size(3);
+        std::string s;
+        error_code result;
+        std::thread t(
+            [&]
+            {
+                char buf[16];
+                for(;;)
+                {
+                    error_code ec;
+                    auto const n =
+                        p.server.read_some(buffer(buf), ec);
+                    if(ec)
+                    {
+                        result = ec;
+                        break;
+                    }
+                    s.append(buf, n);
+                }
+            });
+        for(int i = 0; i < 10; ++i)
+            p.client.write_some(buffer("0123456789", 10));
+        p.client.close();
+        t.join();
+        expect(s.size() == 100);
+        expect(result == boost::asio::error::eof, result.message());
+    }
+
+    void
+    testHttp()
+    {
+        boost::asio::io_service ios;
+        pipe p(ios);
+        p.client.read_size(3);
+        p.server.read_size(3);
+        http::request_v1<http::string_body> req;
+        req.method = "POST";
+        req.url = "/";
+        req.version = 11;
+        req.headers.insert("Host", "localhost");
+        req.body = "Hello, world!";
+        http::prepare(req);
+        streambuf sb1;
+        streambuf sb2;
+        http::request_v1<http::string_body> req2;
+        http::response_v1<http::string_body> res;
+        error_code result;
+        http::async_read(p.server, sb1, req2,
+            [&](error_code ec)
+            {
+                if(ec)
+                {
+                    result = ec;
+                    return;
+                }
+                res.status = 200;
+                res.reason = "OK";
+                res.version = 11;
+                res.body = req2.body;
+                http::prepare(res);
+                http::async_write(p.server, res,
+                    [&](error_code ec)
+                    {
+                        result = ec;
+                    });
+            });
+        http::async_write(p.client, req,
+            [&](error_code ec)
+            {
+                if(ec)
+                {
+                    result = ec;
+                    return;
+                }
+                res = {};
+                http::async_read(p.client, sb2, res,
+                    [&](error_code ec)
+                    {
+                        result = ec;
+                    });
+            });
+        ios.run();
+        expect(! result, result.message());
+        expect(req2.body == "Hello, world!");
+        expect(res.status == 200);
+        expect(res.body == "Hello, world!");
+    }
+
+    void
+    testWebsocket()
+    {
+        boost::asio::io_service ios;
+        pipe p(ios);
+        p.client.latency(ms(1));
+        p.server.read_size(5);
+        websocket::stream<pipe::stream&> server(p.server);
+        websocket::stream<pipe::stream&> client(p.client);
+        auto const r = run_echo(server, client, ios);
+        expect(r.echoed == "Hello");
+        expect(r.server == websocket::error::closed, r.server.message());
+        expect(r.client == websocket::error::closed, r.client.message());
+    }
+
+    void
+    run() override
+    {
+        testReadSize();
+        testLatency();
+        testClose();
+        testCloseDelayed();
+        testCancel();
+        testThreads();
+        testHttp();
+        testWebsocket();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(pipe,core,beast);
+
+} // test
+} // beast
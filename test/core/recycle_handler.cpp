@@ -0,0 +1,149 @@
+//
+// Copyright (c) 2013-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Test that header file is self-contained.
+#include <beast/core/recycle_handler.hpp>
+
+#include <beast/core/handler_ptr.hpp>
+#include <beast/unit_test/suite.hpp>
+#include <boost/asio/detail/handler_alloc_helpers.hpp>
+#include <boost/asio/io_service.hpp>
+#include <thread>
+
+namespace beast {
+
+class recycle_handler_test : public unit_test::suite
+{
+public:
+    struct handler
+    {
+        int* n;
+
+        void
+        operator()(int v)
+        {
+            *n += v;
+        }
+    };
+
+    template<class Handler>
+    static
+    void*
+    allocate(std::size_t size, Handler& h)
+    {
+        return boost_asio_handler_alloc_helpers::allocate(size, h);
+    }
+
+    template<class Handler>
+    static
+    void
+    deallocate(void* p, std::size_t size, Handler& h)
+    {
+        boost_asio_handler_alloc_helpers::deallocate(p, size, h);
+    }
+
+    void
+    testCall()
+    {
+        int n = 0;
+        auto h = recycle_handler(handler{&n});
+        h(3);
+        expect(n == 3);
+    }
+
+    void
+    testRecycle()
+    {
+        int n = 0;
+        auto h = recycle_handler(handler{&n});
+        auto p = allocate(100, h);
+        deallocate(p, 100, h);
+        // Same size class
+        auto p1 = allocate(128, h);
+        expect(p1 == p);
+        // Different size class
+        auto p2 = allocate(200, h);
+        expect(p2 != p1);
+        deallocate(p2, 200, h);
+        deallocate(p1, 128, h);
+        expect(allocate(65, h) == p1);
+        expect(allocate(256, h) == p2);
+        deallocate(p1, 65, h);
+        deallocate(p2, 256, h);
+        // Larger than any size class
+        auto p3 = allocate(100000, h);
+        deallocate(p3, 100000, h);
+    }
+
+    void
+    testHandlerPtr()
+    {
+        struct data
+        {
+            data(detail::recycled_handler<handler>&)
+            {
+            }
+        };
+        int n = 0;
+        void* p;
+        {
+            handler_ptr<data, detail::recycled_handler<
+                handler>> hp(recycle_handler(handler{&n}));
+            p = hp.get();
+            hp.invoke(1);
+        }
+        handler_ptr<data, detail::recycled_handler<
+            handler>> hp(recycle_handler(handler{&n}));
+        expect(hp.get() == p);
+        hp.invoke(1);
+        expect(n == 2);
+    }
+
+    void
+    testThreads()
+    {
+        // Blocks may be freed on any thread
+        int n = 0;
+        auto h = recycle_handler(handler{&n});
+        void* p = allocate(1000, h);
+        std::thread t(
+            [&]
+            {
+                auto h2 = h;
+                deallocate(p, 1000, h2);
+                p = allocate(1000, h2);
+            });
+        t.join();
+        deallocate(p, 1000, h);
+        pass();
+    }
+
+    void
+    testPost()
+    {
+        int n = 0;
+        boost::asio::io_service ios;
+        for(int i = 0; i < 10; ++i)
+            ios.post(recycle_handler(
+                [&n]{ ++n; }));
+        ios.run();
+        expect(n == 10);
+    }
+
+    void run() override
+    {
+        testCall();
+        testRecycle();
+        testHandlerPtr();
+        testThreads();
+        testPost();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(recycle_handler,core,beast);
+
+} // beast
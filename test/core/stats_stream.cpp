@@ -0,0 +1,174 @@
+//
+// Copyright (c) 2013-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Test that header file is self-contained.
+#include <beast/core/stats_stream.hpp>
+
+#include <beast/core/streambuf.hpp>
+#include <beast/http/read.hpp>
+#include <beast/http/string_body.hpp>
+#include <beast/http/write.hpp>
+#include <beast/test/pipe.hpp>
+#include <beast/test/ws_echo.hpp>
+#include <beast/unit_test/suite.hpp>
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/error.hpp>
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <string>
+
+namespace beast {
+
+// The build scripts define BEAST_STREAM_STATS=1
+// for every translation unit of this program.
+class stats_stream_test : public unit_test::suite
+{
+public:
+    void
+    testSpecialMembers()
+    {
+        using socket_type = boost::asio::ip::tcp::socket;
+        boost::asio::io_service ios;
+        {
+            stats_stream<socket_type> ss(ios);
+            stats_stream<socket_type> ss2(std::move(ss));
+            ss = std::move(ss2);
+            expect(&ss.get_io_service() == &ios);
+            expect(&ss.lowest_layer() == &ss.next_layer());
+        }
+        {
+            socket_type sock(ios);
+            stats_stream<socket_type&> ss(sock);
+            expect(&ss.next_layer() == &sock);
+        }
+    }
+
+    void
+    testSync()
+    {
+        using boost::asio::buffer;
+        boost::asio::io_service ios;
+        test::pipe p(ios);
+        p.server.read_size(4);
+        stats_stream<test::pipe::stream&> client(p.client);
+        stats_stream<test::pipe::stream&> server(p.server);
+        client.write_some(buffer("Hello, world!", 13));
+        char buf[16];
+        std::size_t n = 0;
+        while(n < 13)
+            n += server.read_some(buffer(buf + n, sizeof(buf) - n));
+        expect(std::string(buf, n) == "Hello, world!");
+        expect(client.stats().writes == 1);
+        expect(client.stats().bytes_out == 13);
+        expect(client.stats().reads == 0);
+        expect(server.stats().reads == 4);
+        expect(server.stats().bytes_in == 13);
+        server.reset_stats();
+        expect(server.stats().reads == 0);
+        expect(server.stats().bytes_in == 0);
+    }
+
+    void
+    testAsync()
+    {
+        using boost::asio::buffer;
+        boost::asio::io_service ios;
+        test::pipe p(ios);
+        stats_stream<test::pipe::stream&> client(p.client);
+        stats_stream<test::pipe::stream&> server(p.server);
+        char buf[16];
+        std::size_t got = 0;
+        server.async_read_some(buffer(buf),
+            [&](error_code ec, std::size_t n)
+            {
+                if(! ec)
+                    got = n;
+            });
+        client.async_write_some(buffer("Hello", 5),
+            [](error_code, std::size_t)
+            {
+            });
+        ios.run();
+        expect(got == 5);
+        expect(client.stats().writes == 1);
+        expect(client.stats().bytes_out == 5);
+        expect(server.stats().reads == 1);
+        expect(server.stats().bytes_in == 5);
+    }
+
+    void
+    testHttp()
+    {
+        boost::asio::io_service ios;
+        test::pipe p(ios);
+        stats_stream<test::pipe::stream&> client(p.client);
+        stats_stream<test::pipe::stream&> server(p.server);
+        http::request_v1<http::string_body> req;
+        req.method = "POST";
+        req.url = "/";
+        req.version = 11;
+        req.headers.insert("Host", "localhost");
+        req.body = "Hello, world!";
+        http::prepare(req);
+        http::write(client, req);
+        http::write(client, req);
+        streambuf sb;
+        http::request_v1<http::string_body> m;
+        http::read(server, sb, m);
+        expect(m.body == "Hello, world!");
+        http::read(server, sb, m);
+        expect(m.body == "Hello, world!");
+        auto const& cs = client.stats();
+        auto const& ss = server.stats();
+        expect(cs.messages_out == 2);
+        expect(cs.write_buffer_max > 0);
+        expect(ss.messages_in == 2);
+        expect(ss.read_buffer_max > 0);
+        expect(ss.bytes_in == cs.bytes_out);
+
+        stream_stats total;
+        total += cs;
+        total += ss;
+        expect(total.messages_in == 2);
+        expect(total.messages_out == 2);
+    }
+
+    void
+    testWebsocket()
+    {
+        boost::asio::io_service ios;
+        test::pipe p(ios);
+        websocket::stream<stats_stream<
+            test::pipe::stream&>> server(p.server);
+        websocket::stream<test::pipe::stream&> client(p.client);
+        auto const r = test::run_echo(server, client, ios);
+        expect(r.echoed == "Hello");
+        expect(r.server == websocket::error::closed, r.server.message());
+        expect(r.client == websocket::error::closed, r.client.message());
+        expect(server.stats().messages_in == 1);
+        expect(server.next_layer().stats().bytes_in > 0);
+
+        // The teardown closed the pipe
+        error_code ec;
+        p.server.write_some(boost::asio::buffer("x", 1), ec);
+        expect(ec == boost::asio::error::bad_descriptor, ec.message());
+    }
+
+    void
+    run() override
+    {
+        testSpecialMembers();
+        testSync();
+        testAsync();
+        testHttp();
+        testWebsocket();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(stats_stream,core,beast);
+
+} // beast
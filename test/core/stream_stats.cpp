@@ -0,0 +1,117 @@
+//
+// Copyright (c) 2013-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Test that header file is self-contained.
+#include <beast/core/stream_stats.hpp>
+
+#include <beast/unit_test/suite.hpp>
+#include <thread>
+#include <type_traits>
+
+namespace beast {
+
+class stream_stats_test : public unit_test::suite
+{
+public:
+    void
+    testRecorder()
+    {
+        detail::stats_recorder<true> r;
+        r.on_read(100);
+        r.on_read(50);
+        r.on_write(20);
+        r.on_frame_in(false, false);
+        r.on_frame_in(true, true);
+        r.on_frame_in(false, true);
+        r.on_frame_out(true, true);
+        r.on_frame_out(false, true);
+        r.on_message_in();
+        r.on_message_out();
+        r.on_read_buffer(10);
+        r.on_read_buffer(30);
+        r.on_read_buffer(20);
+        r.on_write_buffer(5);
+        {
+            auto const t = r.time_mask();
+            std::this_thread::sleep_for(
+                std::chrono::milliseconds(1));
+        }
+        auto const& s = r.get();
+        expect(s.reads == 2);
+        expect(s.bytes_in == 150);
+        expect(s.writes == 1);
+        expect(s.bytes_out == 20);
+        expect(s.frames_in == 3);
+        expect(s.control_in == 1);
+        expect(s.messages_in == 2);
+        expect(s.frames_out == 2);
+        expect(s.control_out == 1);
+        expect(s.messages_out == 2);
+        expect(s.read_buffer_max == 30);
+        expect(s.write_buffer_max == 5);
+        expect(s.mask_ns >= 1000000);
+        expect(s.utf8_ns == 0);
+        r.reset();
+        expect(r.get().reads == 0);
+        expect(r.get().mask_ns == 0);
+    }
+
+    void
+    testDisabled()
+    {
+        static_assert(std::is_empty<
+            detail::stats_recorder<false>>::value, "");
+        detail::stats_recorder<false> r;
+        r.on_read(100);
+        r.on_write(100);
+        r.on_frame_in(false, true);
+        r.on_read_buffer(100);
+        {
+            auto const t = r.time_utf8();
+        }
+        expect(r.get().reads == 0);
+        expect(r.get().bytes_in == 0);
+        expect(r.get().frames_in == 0);
+        expect(r.get().read_buffer_max == 0);
+    }
+
+    void
+    testAggregate()
+    {
+        stream_stats a;
+        a.bytes_in = 10;
+        a.frames_out = 2;
+        a.read_buffer_max = 100;
+        a.write_buffer_max = 5;
+        stream_stats b;
+        b.bytes_in = 20;
+        b.frames_out = 3;
+        b.read_buffer_max = 50;
+        b.write_buffer_max = 50;
+        b.utf8_ns = 7;
+        stream_stats total;
+        total += a;
+        total += b;
+        expect(total.bytes_in == 30);
+        expect(total.frames_out == 5);
+        expect(total.read_buffer_max == 100);
+        expect(total.write_buffer_max == 50);
+        expect(total.utf8_ns == 7);
+    }
+
+    void
+    run() override
+    {
+        testRecorder();
+        testDisabled();
+        testAggregate();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(stream_stats,core,beast);
+
+} // beast
@@ -0,0 +1,132 @@
+//
+// Copyright (c) 2013-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Test that header file is self-contained.
+#include <beast/core/streambuf_pool.hpp>
+
+#include <beast/core/to_string.hpp>
+#include <beast/unit_test/suite.hpp>
+#include <thread>
+
+namespace beast {
+
+class streambuf_pool_test : public beast::unit_test::suite
+{
+public:
+    void
+    testPool()
+    {
+        streambuf_pool::shrink();
+        auto const s0 = streambuf_pool::get_stats();
+        expect(s0.blocks_held == 0);
+        expect(s0.bytes_held == 0);
+        auto p = streambuf_pool::allocate(100);
+        streambuf_pool::deallocate(p, 100);
+        auto s = streambuf_pool::get_stats();
+        expect(s.misses == s0.misses + 1);
+        expect(s.blocks_held == 1);
+        expect(s.bytes_held == 100);
+        // Same size comes from the pool
+        expect(streambuf_pool::allocate(100) == p);
+        s = streambuf_pool::get_stats();
+        expect(s.hits == s0.hits + 1);
+        expect(s.bytes_held == 0);
+        // Other sizes do not
+        auto p2 = streambuf_pool::allocate(200);
+        s = streambuf_pool::get_stats();
+        expect(s.misses == s0.misses + 2);
+        streambuf_pool::deallocate(p, 100);
+        streambuf_pool::deallocate(p2, 200);
+        s = streambuf_pool::get_stats();
+        expect(s.blocks_held == 2);
+        expect(s.bytes_held == 300);
+        expect(s.hit_rate() > 0);
+        streambuf_pool::shrink();
+        s = streambuf_pool::get_stats();
+        expect(s.blocks_held == 0);
+        expect(s.bytes_held == 0);
+    }
+
+    void
+    testCap()
+    {
+        auto const max = streambuf_pool::max_bytes();
+        expect(max == streambuf_pool::default_max_bytes);
+        streambuf_pool::shrink();
+        streambuf_pool::max_bytes(250);
+        auto p1 = streambuf_pool::allocate(100);
+        auto p2 = streambuf_pool::allocate(100);
+        auto p3 = streambuf_pool::allocate(100);
+        streambuf_pool::deallocate(p1, 100);
+        streambuf_pool::deallocate(p2, 100);
+        streambuf_pool::deallocate(p3, 100);
+        auto s = streambuf_pool::get_stats();
+        expect(s.blocks_held == 2);
+        expect(s.bytes_held == 200);
+        streambuf_pool::max_bytes(150);
+        s = streambuf_pool::get_stats();
+        expect(s.blocks_held == 1);
+        expect(s.bytes_held == 100);
+        streambuf_pool::max_bytes(max);
+        streambuf_pool::shrink();
+    }
+
+    void
+    testStreambuf()
+    {
+        using boost::asio::buffer;
+        using boost::asio::buffer_copy;
+        streambuf_pool::shrink();
+        auto const s0 = streambuf_pool::get_stats();
+        for(int i = 0; i < 10; ++i)
+        {
+            pooled_streambuf sb(64);
+            for(int j = 0; j < 10; ++j)
+            {
+                sb.commit(buffer_copy(sb.prepare(10),
+                    buffer("0123456789", 10)));
+                expect(to_string(sb.data()) == "0123456789");
+                sb.consume(sb.size());
+            }
+        }
+        auto const s = streambuf_pool::get_stats();
+        // Only the first element was newly allocated
+        expect(s.misses == s0.misses + 1);
+        expect(s.hits == s0.hits + 9);
+        expect(s.blocks_held == 1);
+        streambuf_pool::shrink();
+    }
+
+    void
+    testThreads()
+    {
+        pooled_streambuf sb(64);
+        sb.commit(boost::asio::buffer_copy(
+            sb.prepare(10), boost::asio::buffer("*", 1)));
+        std::thread t(
+            [&]
+            {
+                auto sb2 = std::move(sb);
+                sb2.consume(sb2.size());
+                sb2.prepare(1000);
+            });
+        t.join();
+        pass();
+    }
+
+    void run() override
+    {
+        testPool();
+        testCap();
+        testStreambuf();
+        testThreads();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(streambuf_pool,core,beast);
+
+} // beast
@@ -0,0 +1,234 @@
+//
+// Copyright (c) 2013-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Test that header file is self-contained.
+#include <beast/core/timeout_stream.hpp>
+
+#include <beast/core/streambuf.hpp>
+#include <beast/http/read.hpp>
+#include <beast/http/string_body.hpp>
+#include <beast/test/pipe.hpp>
+#include <beast/test/ws_echo.hpp>
+#include <beast/websocket/stream.hpp>
+#include <beast/unit_test/suite.hpp>
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/error.hpp>
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <chrono>
+#include <string>
+
+namespace beast {
+
+class timeout_stream_test : public unit_test::suite
+{
+public:
+    using ms = std::chrono::milliseconds;
+
+    void
+    testSpecialMembers()
+    {
+        using socket_type = boost::asio::ip::tcp::socket;
+        boost::asio::io_service ios;
+        timer_wheel w(ios);
+        {
+            timeout_stream<socket_type> ts(w, ios);
+            ts.idle_timeout(std::chrono::seconds(60));
+            timeout_stream<socket_type> ts2(std::move(ts));
+            expect(&ts2.get_io_service() == &ios);
+            expect(&ts2.lowest_layer() == &ts2.next_layer());
+            expect(w.size() == 1);
+            ts2.idle_timeout(ms(0));
+            expect(w.size() == 0);
+        }
+        {
+            socket_type sock(ios);
+            timeout_stream<socket_type&> ts(w, sock);
+            expect(&ts.next_layer() == &sock);
+        }
+    }
+
+    void
+    testIdle()
+    {
+        using boost::asio::buffer;
+        boost::asio::io_service ios;
+        timer_wheel w(ios, ms(1));
+        test::pipe p(ios);
+        timeout_stream<test::pipe::stream&> ts(w, p.server);
+        ts.idle_timeout(ms(20));
+        char buf[16];
+        error_code ec1;
+        error_code ec2;
+        ts.async_read_some(buffer(buf),
+            [&](error_code ec, std::size_t)
+            {
+                ec1 = ec;
+                ts.async_read_some(buffer(buf),
+                    [&](error_code ec, std::size_t)
+                    {
+                        ec2 = ec;
+                    });
+            });
+        ios.run();
+        expect(ts.expired());
+        expect(ec1 == boost::asio::error::timed_out);
+        expect(ec2 == boost::asio::error::timed_out);
+        expect(w.size() == 0);
+
+        error_code ec;
+        ts.read_some(buffer(buf), ec);
+        expect(ec == boost::asio::error::timed_out);
+    }
+
+    void
+    testActivity()
+    {
+        using boost::asio::buffer;
+        boost::asio::io_service ios;
+        timer_wheel w(ios, ms(1));
+        test::pipe p(ios);
+        timeout_stream<test::pipe::stream&> ts(w, p.server);
+        ts.idle_timeout(std::chrono::seconds(10));
+        char buf[16];
+        std::size_t got = 0;
+        ts.async_read_some(buffer(buf),
+            [&](error_code ec, std::size_t n)
+            {
+                if(! ec)
+                    got = n;
+                ts.idle_timeout(ms(0));
+            });
+        p.client.write_some(buffer("Hello", 5));
+        ios.run();
+        expect(got == 5);
+        expect(! ts.expired());
+        expect(w.size() == 0);
+    }
+
+    void
+    testDeadline()
+    {
+        boost::asio::io_service ios;
+        timer_wheel w(ios, ms(1));
+        test::pipe p(ios);
+        timeout_stream<test::pipe::stream&> ts(w, p.server);
+
+        // The header never finishes arriving
+        p.client.write_some(boost::asio::buffer(
+            "GET / HTTP/1.1\r\nHost: localhost\r\n", 33));
+        ts.expires_after(ms(20));
+        streambuf sb;
+        http::request_v1<http::string_body> m;
+        error_code result;
+        http::async_read(ts, sb, m,
+            [&](error_code ec)
+            {
+                result = ec;
+            });
+        ios.run();
+        expect(ts.expired());
+        expect(result == boost::asio::error::timed_out);
+    }
+
+    void
+    testExpiresNever()
+    {
+        boost::asio::io_service ios;
+        timer_wheel w(ios, ms(1));
+        test::pipe p(ios);
+        timeout_stream<test::pipe::stream&> ts(w, p.server);
+        ts.expires_after(ms(5));
+        ts.expires_never();
+        expect(w.size() == 0);
+        p.client.write_some(boost::asio::buffer(
+            "GET / HTTP/1.1\r\nContent-Length: 0\r\n\r\n", 37));
+        streambuf sb;
+        http::request_v1<http::string_body> m;
+        error_code result = boost::asio::error::timed_out;
+        http::async_read(ts, sb, m,
+            [&](error_code ec)
+            {
+                result = ec;
+            });
+        ios.run();
+        expect(! result, result.message());
+        expect(m.url == "/");
+        expect(! ts.expired());
+    }
+
+    void
+    testWebsocketDeadline()
+    {
+        boost::asio::io_service ios;
+        timer_wheel w(ios, ms(1));
+        test::pipe p(ios);
+        websocket::stream<timeout_stream<
+            test::pipe::stream&>> ws(w, p.server);
+
+        // The upgrade request never finishes arriving
+        p.client.write_some(boost::asio::buffer(
+            "GET / HTTP/1.1\r\nHost: localhost\r\n", 33));
+        ws.next_layer().expires_after(ms(20));
+        error_code result;
+        ws.async_accept(
+            [&](error_code ec)
+            {
+                result = ec;
+            });
+        ios.run();
+        expect(ws.next_layer().expired());
+        expect(result == boost::asio::error::timed_out,
+            result.message());
+        expect(w.size() == 0);
+    }
+
+    void
+    testWebsocketClose()
+    {
+        using boost::asio::buffer;
+        boost::asio::io_service ios;
+        timer_wheel w(ios, ms(1));
+        test::pipe p(ios);
+        websocket::stream<timeout_stream<
+            test::pipe::stream&>> server(w, p.server);
+        websocket::stream<test::pipe::stream&> client(p.client);
+        auto& ts = server.next_layer();
+        ts.idle_timeout(std::chrono::seconds(10));
+        ts.expires_after(std::chrono::seconds(10));
+        test::echo_hooks hooks;
+        hooks.accepted = [&]{ ts.expires_never(); };
+        hooks.server_closed = [&]{ ts.idle_timeout(ms(0)); };
+        auto const r = test::run_echo(server, client, ios, hooks);
+        expect(r.echoed == "Hello");
+        expect(r.server == websocket::error::closed, r.server.message());
+        expect(r.client == websocket::error::closed, r.client.message());
+        expect(! ts.expired());
+        expect(w.size() == 0);
+
+        // The teardown closed the pipe
+        error_code ec;
+        p.server.write_some(buffer("x", 1), ec);
+        expect(ec == boost::asio::error::bad_descriptor, ec.message());
+    }
+
+    void
+    run() override
+    {
+        testSpecialMembers();
+        testIdle();
+        testActivity();
+        testDeadline();
+        testExpiresNever();
+        testWebsocketDeadline();
+        testWebsocketClose();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(timeout_stream,core,beast);
+
+} // beast
@@ -0,0 +1,162 @@
+//
+// Copyright (c) 2013-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Test that header file is self-contained.
+#include <beast/core/timer_wheel.hpp>
+
+#include <beast/unit_test/suite.hpp>
+#include <boost/asio/io_service.hpp>
+#include <chrono>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace beast {
+
+class timer_wheel_test : public unit_test::suite
+{
+public:
+    using ms = std::chrono::milliseconds;
+
+    class test_timer : public timer_wheel::timer
+    {
+    public:
+        std::function<void(test_timer&)> f;
+        int count = 0;
+
+        explicit
+        test_timer(timer_wheel& w)
+            : timer_wheel::timer(w)
+        {
+        }
+
+        test_timer(test_timer&& other)
+            : timer_wheel::timer(std::move(other))
+            , f(std::move(other.f))
+        {
+        }
+
+    protected:
+        void
+        on_expire() override
+        {
+            ++count;
+            if(f)
+                f(*this);
+        }
+    };
+
+    void
+    testExpire()
+    {
+        boost::asio::io_service ios;
+        timer_wheel w(ios, ms(1));
+        std::vector<int> order;
+        test_timer t1(w);
+        test_timer t2(w);
+        test_timer t3(w);
+        t1.f = [&](test_timer&){ order.push_back(1); };
+        t2.f = [&](test_timer&){ order.push_back(2); };
+        t3.f = [&](test_timer&){ order.push_back(3); };
+        t3.expires_after(ms(30));
+        t1.expires_after(ms(10));
+        t2.expires_after(ms(20));
+        expect(w.size() == 3);
+        ios.run();
+        expect(w.size() == 0);
+        expect(order == std::vector<int>({1, 2, 3}));
+    }
+
+    void
+    testRearmCancel()
+    {
+        boost::asio::io_service ios;
+        timer_wheel w(ios, ms(1));
+        auto const start = timer_wheel::clock_type::now();
+        test_timer t1(w);
+        test_timer t2(w);
+        t1.expires_after(ms(5));
+        t1.expires_after(ms(40));
+        t2.expires_after(ms(5));
+        expect(w.size() == 2);
+        t2.cancel();
+        t2.cancel();
+        expect(w.size() == 1);
+        ios.run();
+        expect(t1.count == 1);
+        expect(t2.count == 0);
+        expect(timer_wheel::clock_type::now() - start >= ms(40));
+    }
+
+    void
+    testCascade()
+    {
+        // Long enough to be placed in the second level
+        boost::asio::io_service ios;
+        timer_wheel w(ios, ms(1));
+        auto const start = timer_wheel::clock_type::now();
+        test_timer t(w);
+        t.expires_after(ms(300));
+        ios.run();
+        expect(t.count == 1);
+        expect(timer_wheel::clock_type::now() - start >= ms(300));
+    }
+
+    void
+    testRearmFromExpire()
+    {
+        boost::asio::io_service ios;
+        timer_wheel w(ios, ms(1));
+        test_timer t(w);
+        t.f =
+            [&](test_timer& self)
+            {
+                if(self.count < 3)
+                    self.expires_after(ms(2));
+            };
+        t.expires_after(ms(2));
+        ios.run();
+        expect(t.count == 3);
+        expect(w.size() == 0);
+    }
+
+    void
+    testMoveDestroy()
+    {
+        boost::asio::io_service ios;
+        timer_wheel w(ios, ms(1));
+        {
+            test_timer t(w);
+            t.expires_after(ms(5));
+            expect(w.size() == 1);
+        }
+        expect(w.size() == 0);
+        test_timer t1(w);
+        t1.expires_after(ms(5));
+        test_timer t2(std::move(t1));
+        expect(w.size() == 1);
+        t1.cancel();
+        expect(w.size() == 1);
+        ios.run();
+        expect(t1.count == 0);
+        expect(t2.count == 1);
+    }
+
+    void
+    run() override
+    {
+        testExpire();
+        testRearmCancel();
+        testCascade();
+        testRearmFromExpire();
+        testMoveDestroy();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(timer_wheel,core,beast);
+
+} // beast
@@ -0,0 +1,257 @@
+//
+// Copyright (c) 2013-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Test that header file is self-contained.
+#include <beast/core/trace.hpp>
+
+#include <beast/core/streambuf.hpp>
+#include <beast/http/read.hpp>
+#include <beast/http/string_body.hpp>
+#include <beast/http/write.hpp>
+#include <beast/test/pipe.hpp>
+#include <beast/test/ws_echo.hpp>
+#include <beast/unit_test/suite.hpp>
+#include <boost/asio/io_service.hpp>
+#include <atomic>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace beast {
+
+// The build scripts define BEAST_TRACE=1
+// for every translation unit of this program.
+class trace_test : public unit_test::suite
+{
+public:
+    void
+    testRecord()
+    {
+        trace_buffer b;
+        expect(b.events().empty());
+        int op;
+        b.record(&op, "op", trace_kind::begin, 0);
+        b.record(&op, "op", trace_kind::step, 1);
+        b.record(&op, "op", trace_kind::end, 2);
+        auto const v = b.events();
+        expect(v.size() == 3);
+        expect(v[0].op == &op);
+        expect(v[0].kind == trace_kind::begin);
+        expect(v[1].kind == trace_kind::step);
+        expect(v[1].value == 1);
+        expect(v[2].kind == trace_kind::end);
+        expect(std::string(v[2].name) == "op");
+        expect(v[0].time <= v[1].time);
+        expect(v[1].time <= v[2].time);
+    }
+
+    void
+    testWrap()
+    {
+        trace_buffer b;
+        auto const n = trace_buffer::capacity();
+        for(std::size_t i = 0; i < n + 10; ++i)
+            b.record(nullptr, "op", trace_kind::step,
+                static_cast<int>(i));
+        auto const v = b.events();
+        expect(v.size() == n);
+        expect(v.front().value == 10);
+        expect(v.back().value == static_cast<int>(n + 9));
+    }
+
+    void
+    testConcurrentRead()
+    {
+        // Events read while the owner records stay in order
+        trace_buffer b;
+        std::atomic<bool> stop{false};
+        std::thread t(
+            [&]
+            {
+                int i = 0;
+                while(! stop)
+                    b.record(nullptr, "op", trace_kind::step, i++);
+            });
+        bool ok = true;
+        for(int i = 0; i < 100; ++i)
+        {
+            auto const v = b.events();
+            for(std::size_t j = 1; j < v.size(); ++j)
+                if(v[j].value != v[j - 1].value + 1)
+                    ok = false;
+        }
+        stop = true;
+        t.join();
+        expect(ok);
+    }
+
+    void
+    testDump()
+    {
+        int op;
+        std::thread(
+            [&]
+            {
+                auto& b = trace_buffer::local();
+                expect(&b == &trace_buffer::local());
+                b.record(&op, "thread_op", trace_kind::wait, 7);
+                std::ostringstream os;
+                trace_dump(os);
+                expect(os.str().find(
+                    "thread_op wait 7") != std::string::npos);
+            }).join();
+        // The buffer goes away with its thread
+        std::ostringstream os;
+        trace_dump(os);
+        expect(os.str().find("thread_op") == std::string::npos);
+    }
+
+    // Runs f on a new thread and returns the events it recorded
+    template<class Function>
+    static
+    std::vector<trace_event>
+    events_of(Function&& f)
+    {
+        std::vector<trace_event> v;
+        std::thread(
+            [&]
+            {
+                f();
+                v = trace_buffer::local().events();
+            }).join();
+        return v;
+    }
+
+    // Checks that each run of the named operation records begin,
+    // one or more steps, then end, all with the same op pointer.
+    // Returns the number of runs, or -1 if the sequence is wrong.
+    static
+    int
+    count_runs(std::vector<trace_event> const& v,
+        std::string const& name)
+    {
+        std::map<void const*, int> steps;
+        int runs = 0;
+        for(auto const& e : v)
+        {
+            if(e.name != name)
+                continue;
+            auto const it = steps.find(e.op);
+            switch(e.kind)
+            {
+            case trace_kind::begin:
+                if(it != steps.end())
+                    return -1;
+                steps[e.op] = 0;
+                break;
+            case trace_kind::step:
+            case trace_kind::wait:
+                if(it == steps.end())
+                    return -1;
+                ++it->second;
+                break;
+            case trace_kind::end:
+                if(it == steps.end() || it->second == 0)
+                    return -1;
+                steps.erase(it);
+                ++runs;
+                break;
+            }
+        }
+        if(! steps.empty())
+            return -1;
+        return runs;
+    }
+
+    void
+    testHttp()
+    {
+        auto const v = events_of(
+            [&]
+            {
+                boost::asio::io_service ios;
+                test::pipe p(ios);
+                http::request_v1<http::string_body> req;
+                req.method = "GET";
+                req.url = "/";
+                req.version = 11;
+                req.headers.insert("Host", "localhost");
+                http::prepare(req);
+                http::response_v1<http::string_body> res;
+                res.status = 200;
+                res.reason = "OK";
+                res.version = 11;
+                res.body = "Hello, world!";
+                http::prepare(res);
+                streambuf sb1;
+                streambuf sb2;
+                http::request_v1<http::string_body> req2;
+                http::response_v1<http::string_body> res2;
+                http::async_read(p.server, sb1, req2,
+                    [&](error_code ec)
+                    {
+                        if(! ec)
+                            http::async_write(p.server, res,
+                                [](error_code){});
+                    });
+                http::async_write(p.client, req,
+                    [&](error_code ec)
+                    {
+                        if(! ec)
+                            http::async_read(p.client, sb2, res2,
+                                [](error_code){});
+                    });
+                ios.run();
+                expect(res2.body == "Hello, world!");
+            });
+        expect(count_runs(v, "http::write_op") == 2);
+        expect(count_runs(v, "http::read_op") == 2);
+        expect(count_runs(v, "http::parse_op") == 2);
+        for(auto const& e : v)
+            if(e.kind == trace_kind::end)
+                expect(e.value == 0);
+    }
+
+    void
+    testWebsocket()
+    {
+        auto const v = events_of(
+            [&]
+            {
+                boost::asio::io_service ios;
+                test::pipe p(ios);
+                websocket::stream<test::pipe::stream&> server(p.server);
+                websocket::stream<test::pipe::stream&> client(p.client);
+                auto const r = test::run_echo(server, client, ios);
+                expect(r.echoed == "Hello");
+            });
+        expect(count_runs(v, "websocket::accept_op") == 1);
+        expect(count_runs(v, "websocket::handshake_op") == 1);
+        expect(count_runs(v, "websocket::write_op") == 2);
+        expect(count_runs(v, "websocket::read_op") == 4);
+        expect(count_runs(v, "websocket::close_op") == 1);
+        expect(count_runs(v, "websocket::read_frame_op") >= 4);
+        expect(count_runs(v, "websocket::write_frame_op") >= 2);
+    }
+
+    void
+    run() override
+    {
+        testRecord();
+        testWrap();
+        testConcurrentRead();
+        testDump();
+        testHttp();
+        testWebsocket();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(trace,core,beast);
+
+} // beast
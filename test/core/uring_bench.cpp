@@ -0,0 +1,236 @@
+//
+// Copyright (c) 2013-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Measures TCP echo throughput over loopback on one thread, with
+// the server end of each connection using a boost::asio socket
+// or a uring_stream.
+//
+// usage: uring-bench [connections] [seconds] [message size]
+
+#include <beast/core/uring_stream.hpp>
+#include <boost/asio.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+
+namespace beast {
+
+// One end of an echo connection. The client sends a message and
+// waits for it to come back, the server writes back what it reads.
+template<class Stream>
+class echo_peer
+    : public std::enable_shared_from_this<echo_peer<Stream>>
+{
+    Stream sock_;
+    std::vector<char> buf_;
+    std::size_t& count_;
+    std::atomic<bool>& stop_;
+    bool client_;
+
+public:
+    echo_peer(Stream&& sock, std::size_t size,
+            std::size_t& count, std::atomic<bool>& stop,
+                bool client)
+        : sock_(std::move(sock))
+        , buf_(size, 'x')
+        , count_(count)
+        , stop_(stop)
+        , client_(client)
+    {
+    }
+
+    void
+    run()
+    {
+        if(client_)
+            do_write(buf_.size());
+        else
+            do_read();
+    }
+
+private:
+    void
+    do_read()
+    {
+        auto self = this->shared_from_this();
+        if(client_)
+            boost::asio::async_read(sock_,
+                boost::asio::buffer(buf_),
+                    [self](error_code ec, std::size_t n)
+                    {
+                        self->on_read(ec, n);
+                    });
+        else
+            sock_.async_read_some(
+                boost::asio::buffer(buf_),
+                    [self](error_code ec, std::size_t n)
+                    {
+                        self->on_read(ec, n);
+                    });
+    }
+
+    void
+    on_read(error_code ec, std::size_t n)
+    {
+        if(ec || stop_)
+            return sock_.close();
+        if(client_)
+            ++count_;
+        do_write(n);
+    }
+
+    void
+    do_write(std::size_t n)
+    {
+        auto self = this->shared_from_this();
+        boost::asio::async_write(sock_,
+            boost::asio::buffer(buf_.data(), n),
+                [self](error_code ec, std::size_t)
+                {
+                    self->on_write(ec);
+                });
+    }
+
+    void
+    on_write(error_code ec)
+    {
+        if(ec || stop_)
+            return sock_.close();
+        do_read();
+    }
+};
+
+struct options
+{
+    std::size_t connections = 64;
+    std::size_t seconds = 5;
+    std::size_t size = 64;
+};
+
+using socket_type = boost::asio::ip::tcp::socket;
+
+socket_type
+make_server(socket_type&& sock, uring_service&, socket_type*)
+{
+    return std::move(sock);
+}
+
+// The descriptor is duplicated, since the asio
+// socket cannot give up ownership of its own.
+uring_stream
+make_server(socket_type&& sock, uring_service& svc, uring_stream*)
+{
+    uring_stream s(svc, ::dup(sock.native_handle()));
+    sock.close();
+    return s;
+}
+
+// Returns the number of round trips per second
+template<class Stream>
+double
+bench(options const& opt)
+{
+    using namespace boost::asio;
+    io_service ios;
+    uring_service svc(ios);
+    std::size_t count = 0;
+    std::atomic<std::size_t> snapshot{0};
+    std::atomic<bool> stop{false};
+    ip::tcp::acceptor acceptor(ios, ip::tcp::endpoint{
+        ip::address_v4::loopback(), 0});
+    for(std::size_t i = 0; i < opt.connections; ++i)
+    {
+        socket_type client(ios);
+        socket_type server(ios);
+        client.connect(acceptor.local_endpoint());
+        acceptor.accept(server);
+        client.set_option(ip::tcp::no_delay{true});
+        server.set_option(ip::tcp::no_delay{true});
+        std::make_shared<echo_peer<Stream>>(
+            make_server(std::move(server), svc,
+                static_cast<Stream*>(nullptr)),
+            opt.size, count, stop, false)->run();
+        std::make_shared<echo_peer<socket_type>>(std::move(client),
+            opt.size, count, stop, true)->run();
+    }
+    acceptor.close();
+    // The count is only touched by the thread
+    // running the io_service, a timer samples it.
+    steady_timer timer(ios);
+    std::function<void()> sample =
+        [&]
+        {
+            snapshot = count;
+            if(stop)
+                return;
+            timer.expires_from_now(std::chrono::milliseconds(10));
+            timer.async_wait([&](error_code){ sample(); });
+        };
+    sample();
+    std::thread t([&]{ ios.run(); });
+    // Let the connections reach a steady state
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+    auto const n0 = snapshot.load();
+    auto const t0 = std::chrono::steady_clock::now();
+    std::this_thread::sleep_for(std::chrono::seconds(opt.seconds));
+    auto const n1 = snapshot.load();
+    auto const t1 = std::chrono::steady_clock::now();
+    stop = true;
+    t.join();
+    return (n1 - n0) / std::chrono::duration<
+        double>(t1 - t0).count();
+}
+
+} // beast
+
+int
+main(int argc, char** argv)
+{
+    beast::options opt;
+    if(argc > 1)
+        opt.connections = std::strtoul(argv[1], nullptr, 10);
+    if(argc > 2)
+        opt.seconds = std::strtoul(argv[2], nullptr, 10);
+    if(argc > 3)
+        opt.size = std::strtoul(argv[3], nullptr, 10);
+    std::cout <<
+        "connections=" << opt.connections <<
+        " seconds=" << opt.seconds <<
+        " size=" << opt.size << std::endl;
+    try
+    {
+        auto const plain = beast::bench<beast::socket_type>(opt);
+        std::cout << "tcp::socket:  " <<
+            static_cast<std::size_t>(plain) << " round trips/s" << std::endl;
+        auto const uring = beast::bench<beast::uring_stream>(opt);
+        std::cout << "uring_stream: " <<
+            static_cast<std::size_t>(uring) << " round trips/s" << std::endl;
+        std::cout << "ratio: " << uring / plain << std::endl;
+    }
+    catch(beast::system_error const& e)
+    {
+        std::cerr << "error: " << e.code().message() << std::endl;
+        return EXIT_FAILURE;
+    }
+}
+
+#else
+
+int
+main()
+{
+    std::cerr << "io_uring requires Linux" << std::endl;
+}
+
+#endif
@@ -0,0 +1,21 @@
+//
+// Copyright (c) 2013-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Compiles only when the kernel headers support uring_stream.
+// The build scripts use it to decide whether to build the
+// uring_stream tests and benchmark.
+
+#include <linux/io_uring.h>
+#include <linux/version.h>
+
+#if LINUX_VERSION_CODE < KERNEL_VERSION(6,0,0)
+#error "io_uring support requires Linux kernel headers 6.0 or later"
+#endif
+
+int main()
+{
+}
@@ -0,0 +1,313 @@
+//
+// Copyright (c) 2013-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Test that header file is self-contained.
+#include <beast/core/uring_stream.hpp>
+
+#if defined(__linux__)
+
+#include <beast/core/stream_concepts.hpp>
+#include <beast/test/ws_echo.hpp>
+#include <beast/websocket/stream.hpp>
+#include <beast/websocket/uring.hpp>
+#include <beast/unit_test/suite.hpp>
+#include <boost/asio.hpp>
+#include <array>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include <sys/socket.h>
+
+namespace beast {
+
+static_assert(is_AsyncStream<uring_stream>::value, "");
+static_assert(is_SyncStream<uring_stream>::value, "");
+
+class uring_stream_test : public beast::unit_test::suite
+{
+public:
+    using buffers_type = std::array<boost::asio::mutable_buffer, 2>;
+
+    // Returns a connected pair of sockets
+    static
+    std::array<int, 2>
+    make_pair()
+    {
+        std::array<int, 2> v;
+        ::socketpair(AF_UNIX, SOCK_STREAM, 0, v.data());
+        return v;
+    }
+
+    void
+    testAsync(uring_service& svc)
+    {
+        auto& ios = svc.get_io_service();
+        auto const fd = make_pair();
+        uring_stream a(svc, fd[0]);
+        uring_stream b(svc, fd[1]);
+        std::string s;
+        s.resize(11);
+        error_code wec, rec;
+        std::size_t wn = 0, rn = 0;
+        a.async_write_some(boost::asio::buffer("Hello world", 11),
+            [&](error_code ec, std::size_t n)
+            {
+                wec = ec;
+                wn = n;
+            });
+        b.async_read_some(boost::asio::buffer(&s[0], s.size()),
+            [&](error_code ec, std::size_t n)
+            {
+                rec = ec;
+                rn = n;
+            });
+        ios.run();
+        ios.reset();
+        expect(! wec, wec.message());
+        expect(! rec, rec.message());
+        expect(wn == 11);
+        expect(rn == 11);
+        expect(s == "Hello world");
+
+        // scatter and gather
+        char c1[5], c2[6];
+        std::array<boost::asio::const_buffer, 2> const cb{{
+            boost::asio::buffer("Hello", 5),
+            boost::asio::buffer(", all", 5)}};
+        a.async_write_some(cb,
+            [&](error_code ec, std::size_t n)
+            {
+                wec = ec;
+                wn = n;
+            });
+        ios.run();
+        ios.reset();
+        expect(wn == 10);
+        buffers_type const mb{{
+            boost::asio::buffer(c1), boost::asio::buffer(c2)}};
+        b.async_read_some(mb,
+            [&](error_code ec, std::size_t n)
+            {
+                rec = ec;
+                rn = n;
+            });
+        ios.run();
+        ios.reset();
+        expect(! rec, rec.message());
+        expect(rn == 10);
+        expect(std::string(c1, 5) == "Hello");
+        expect(std::string(c2, 5) == ", all");
+
+        // end of file
+        a.close();
+        b.async_read_some(boost::asio::buffer(c1),
+            [&](error_code ec, std::size_t n)
+            {
+                rec = ec;
+                rn = n;
+            });
+        ios.run();
+        ios.reset();
+        expect(rec == boost::asio::error::eof, rec.message());
+        expect(rn == 0);
+    }
+
+    void
+    testBatch(uring_service& svc)
+    {
+        auto& ios = svc.get_io_service();
+        std::size_t constexpr n = 8;
+        std::vector<std::unique_ptr<uring_stream>> v;
+        for(std::size_t i = 0; i < n; ++i)
+        {
+            auto const fd = make_pair();
+            v.emplace_back(new uring_stream(svc, fd[0]));
+            v.emplace_back(new uring_stream(svc, fd[1]));
+        }
+        // All reads and writes go in
+        // the same submission.
+        std::size_t count = 0;
+        std::array<char, n> buf;
+        for(std::size_t i = 0; i < n; ++i)
+        {
+            v[2 * i]->async_write_some(
+                boost::asio::buffer("*", 1),
+                [&](error_code ec, std::size_t)
+                {
+                    if(! ec)
+                        ++count;
+                });
+            v[2 * i + 1]->async_read_some(
+                boost::asio::buffer(&buf[i], 1),
+                [&](error_code ec, std::size_t)
+                {
+                    if(! ec)
+                        ++count;
+                });
+        }
+        ios.run();
+        ios.reset();
+        expect(count == 2 * n);
+    }
+
+    void
+    testFixed(uring_service& svc)
+    {
+        auto& ios = svc.get_io_service();
+        auto const fd = make_pair();
+        uring_stream a(svc, fd[0]);
+        uring_stream b(svc, fd[1]);
+        std::array<char, 64> buf;
+        svc.register_buffers({boost::asio::buffer(buf)});
+        a.write_some(boost::asio::buffer("fixed", 5));
+        error_code rec;
+        std::size_t rn = 0;
+        b.async_read_some(boost::asio::buffer(&buf[10], 20),
+            [&](error_code ec, std::size_t n)
+            {
+                rec = ec;
+                rn = n;
+            });
+        ios.run();
+        ios.reset();
+        svc.register_buffers({});
+        expect(! rec, rec.message());
+        expect(rn == 5);
+        expect(std::string(&buf[10], 5) == "fixed");
+    }
+
+    void
+    testMultishot(uring_service& svc)
+    {
+        auto& ios = svc.get_io_service();
+        auto const fd = make_pair();
+        uring_stream a(svc, fd[0]);
+        uring_stream b(svc, fd[1]);
+        b.multishot(true);
+        std::string s;
+        error_code rec;
+        std::function<void()> do_read;
+        char c[3];
+        do_read =
+            [&]
+            {
+                b.async_read_some(boost::asio::buffer(c),
+                    [&](error_code ec, std::size_t n)
+                    {
+                        rec = ec;
+                        if(ec)
+                            return;
+                        s.append(c, n);
+                        if(s.size() < 10)
+                            do_read();
+                        else
+                            a.close();
+                    });
+            };
+        do_read();
+        a.write_some(boost::asio::buffer("0123456789", 10));
+        ios.run();
+        ios.reset();
+        expect(! rec, rec.message());
+        expect(s == "0123456789");
+
+        // end of file
+        b.async_read_some(boost::asio::buffer(c),
+            [&](error_code ec, std::size_t)
+            {
+                rec = ec;
+            });
+        ios.run();
+        ios.reset();
+        expect(rec == boost::asio::error::eof, rec.message());
+    }
+
+    void
+    testSync(uring_service& svc)
+    {
+        auto const fd = make_pair();
+        uring_stream a(svc, fd[0]);
+        uring_stream b(svc, fd[1]);
+        char buf[16];
+        expect(a.write_some(boost::asio::buffer("sync", 4)) == 4);
+        expect(b.read_some(boost::asio::buffer(buf)) == 4);
+        expect(std::string(buf, 4) == "sync");
+        a.close();
+        error_code ec;
+        b.read_some(boost::asio::buffer(buf), ec);
+        expect(ec == boost::asio::error::eof, ec.message());
+        a.read_some(boost::asio::buffer(buf), ec);
+        expect(ec == boost::asio::error::bad_descriptor, ec.message());
+    }
+
+    void
+    testTeardown(uring_service& svc)
+    {
+        auto const fd = make_pair();
+        uring_stream a(svc, fd[0]);
+        uring_stream b(svc, fd[1]);
+        a.write_some(boost::asio::buffer("unread", 6));
+        a.close();
+        error_code ec;
+        websocket_helpers::call_teardown(b, ec);
+        expect(! ec, ec.message());
+        expect(! b.is_open());
+    }
+
+    void
+    testWebsocket(uring_service& svc)
+    {
+        auto& ios = svc.get_io_service();
+        auto const fd = make_pair();
+        websocket::stream<uring_stream> server(svc, fd[0]);
+        websocket::stream<uring_stream> client(svc, fd[1]);
+        test::echo_hooks hooks;
+        // The initiating side closes after the peer's
+        // reply, ending the peer's teardown.
+        hooks.client_closed = [&]{ client.next_layer().close(); };
+        auto const r = test::run_echo(server, client, ios, hooks);
+        ios.reset();
+        expect(r.echoed == "Hello");
+        expect(r.server == websocket::error::closed, r.server.message());
+        expect(r.client == websocket::error::closed, r.client.message());
+        expect(! server.next_layer().is_open());
+        expect(! client.next_layer().is_open());
+    }
+
+    void
+    run() override
+    {
+        boost::asio::io_service ios;
+        std::unique_ptr<uring_service> svc;
+        try
+        {
+            svc.reset(new uring_service(ios));
+        }
+        catch(system_error const& e)
+        {
+            log << "io_uring unavailable: " <<
+                e.code().message() << std::endl;
+            pass();
+            return;
+        }
+        testAsync(*svc);
+        testBatch(*svc);
+        testFixed(*svc);
+        svc->provide_buffers(4, 4);
+        testMultishot(*svc);
+        testSync(*svc);
+        testTeardown(*svc);
+        testWebsocket(*svc);
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(uring_stream,core,beast);
+
+} // beast
+
+#endif
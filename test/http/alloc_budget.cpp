@@ -0,0 +1,294 @@
+//
+// Copyright (c) 2013-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#include <beast/http/headers.hpp>
+#include <beast/http/parser_v1.hpp>
+#include <beast/http/string_body.hpp>
+#include <beast/http/write.hpp>
+#include <beast/core/async_completion.hpp>
+#include <beast/core/bind_handler.hpp>
+#include <beast/test/alloc_counter.hpp>
+#include <beast/unit_test/suite.hpp>
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/io_service.hpp>
+#include <string>
+
+namespace beast {
+namespace http {
+
+// Checks that steady state operations stay within
+// their budget of heap allocations.
+class alloc_budget_test : public beast::unit_test::suite
+{
+public:
+    // A stream which discards written data
+    class null_stream
+    {
+        boost::asio::io_service& ios_;
+
+    public:
+        explicit
+        null_stream(boost::asio::io_service& ios)
+            : ios_(ios)
+        {
+        }
+
+        boost::asio::io_service&
+        get_io_service()
+        {
+            return ios_;
+        }
+
+        template<class ConstBufferSequence>
+        std::size_t
+        write_some(ConstBufferSequence const& buffers)
+        {
+            return boost::asio::buffer_size(buffers);
+        }
+
+        template<class ConstBufferSequence>
+        std::size_t
+        write_some(ConstBufferSequence const& buffers, error_code&)
+        {
+            return boost::asio::buffer_size(buffers);
+        }
+
+        template<class ConstBufferSequence, class WriteHandler>
+        typename async_completion<
+            WriteHandler, void(error_code, std::size_t)>::result_type
+        async_write_some(ConstBufferSequence const& buffers,
+            WriteHandler&& handler)
+        {
+            async_completion<WriteHandler,
+                void(error_code, std::size_t)> completion(handler);
+            ios_.post(bind_handler(completion.handler, error_code{},
+                boost::asio::buffer_size(buffers)));
+            return completion.result.get();
+        }
+    };
+
+    // A body whose writer suspends once, resuming
+    // immediately, before writing the body.
+    struct suspend_body
+    {
+        using value_type = std::string;
+
+        class writer
+        {
+            value_type const& body_;
+            bool suspended_ = false;
+
+        public:
+            writer(writer const&) = delete;
+            writer& operator=(writer const&) = delete;
+
+            template<bool isRequest, class Headers>
+            explicit
+            writer(message<isRequest,
+                    suspend_body, Headers> const& msg)
+                : body_(msg.body)
+            {
+            }
+
+            void
+            init(error_code&)
+            {
+            }
+
+            std::uint64_t
+            content_length() const
+            {
+                return body_.size();
+            }
+
+            template<class Write>
+            boost::tribool
+            operator()(resume_context&& resume,
+                error_code&, Write&& write)
+            {
+                if(! suspended_)
+                {
+                    suspended_ = true;
+                    resume_context r(std::move(resume));
+                    r();
+                    return boost::indeterminate;
+                }
+                write(boost::asio::buffer(body_));
+                return true;
+            }
+        };
+    };
+
+    // A handler which counts the memory
+    // allocated through its hooks.
+    struct counted_handler
+    {
+        std::size_t* allocs;
+        std::size_t* completed;
+
+        void
+        operator()(error_code ec)
+        {
+            if(! ec)
+                ++*completed;
+        }
+
+        friend
+        void* asio_handler_allocate(
+            std::size_t size, counted_handler* h)
+        {
+            ++*h->allocs;
+            return ::operator new(size);
+        }
+
+        friend
+        void asio_handler_deallocate(
+            void* p, std::size_t, counted_handler*)
+        {
+            ::operator delete(p);
+        }
+    };
+
+    void
+    testParser()
+    {
+        std::string const s =
+            "POST /api/v2/orders/12345?expand=items HTTP/1.1\r\n"
+            "Host: api.example.com\r\n"
+            "User-Agent: alloc-budget\r\n"
+            "Content-Type: application/json\r\n"
+            "Content-Length: 17\r\n"
+            "\r\n"
+            "{\"item\":\"widget\"}";
+        std::size_t constexpr n = 100;
+        std::string batch;
+        for(std::size_t i = 0; i < n; ++i)
+            batch += s;
+
+        parser_v1<true, string_body, headers> p;
+        auto const parse =
+            [&](std::size_t offset)
+            {
+                p.get().headers.clear();
+                p.get().body.clear();
+                error_code ec;
+                auto const used = p.write(boost::asio::buffer(
+                    batch.data() + offset, s.size()), ec);
+                return ! ec && used == s.size();
+            };
+        // The first messages size the reused strings
+        expect(parse(0));
+        expect(parse(s.size()));
+        test::alloc_counter c;
+        bool ok = true;
+        for(std::size_t i = 2; i < n; ++i)
+            ok = parse(i * s.size()) && ok;
+        auto const count = c.allocations();
+        expect(ok);
+        expect(p.get().body == "{\"item\":\"widget\"}");
+        log << "parser_v1: " << count / (n - 2) <<
+            " allocations per message" << std::endl;
+        // One per field, plus the target which is
+        // moved into the message each time.
+        expect(count <= 5 * (n - 2), "parser_v1 budget");
+    }
+
+    void
+    testAsyncWrite()
+    {
+        boost::asio::io_service ios;
+        null_stream ns(ios);
+        response_v1<string_body> res;
+        res.status = 200;
+        res.reason = "OK";
+        res.version = 11;
+        res.headers.insert("Server", "alloc-budget");
+        res.headers.insert("Content-Type", "text/plain");
+        res.body = "Hello, world!";
+        prepare(res);
+
+        std::size_t constexpr n = 100;
+        std::size_t completed = 0;
+        auto const write =
+            [&]
+            {
+                async_write(ns, res,
+                    [&](error_code ec)
+                    {
+                        if(! ec)
+                            ++completed;
+                    });
+                ios.run();
+                ios.reset();
+            };
+        // Let the io_service create its
+        // per thread state before counting.
+        write();
+        test::alloc_counter c;
+        for(std::size_t i = 1; i < n; ++i)
+            write();
+        auto const count = c.allocations();
+        expect(completed == n);
+        log << "async_write: " << count / (n - 1) <<
+            " allocations per response" << std::endl;
+        // The operation state, and the stream
+        // buffer holding the serialized headers.
+        expect(count <= 3 * (n - 1), "async_write budget");
+    }
+
+    template<class Body>
+    std::size_t
+    handler_allocs()
+    {
+        boost::asio::io_service ios;
+        null_stream ns(ios);
+        response_v1<Body> res;
+        res.status = 200;
+        res.reason = "OK";
+        res.version = 11;
+        res.body = "Hello, world!";
+        prepare(res);
+        std::size_t allocs = 0;
+        std::size_t completed = 0;
+        async_write(ns, res,
+            counted_handler{&allocs, &completed});
+        ios.run();
+        expect(completed == 1);
+        return allocs;
+    }
+
+    void
+    testSuspendedWrite()
+    {
+        // Resuming a suspended write allocates
+        // through the handler, like every other
+        // step of the operation.
+        auto const plain = handler_allocs<string_body>();
+        auto const suspended = handler_allocs<suspend_body>();
+        log << "async_write: " << plain << " handler allocations, " <<
+            suspended << " when suspended" << std::endl;
+        expect(suspended == plain + 1, "suspended write budget");
+    }
+
+    void
+    run() override
+    {
+        if(! test::alloc_counter::installed())
+        {
+            fail("alloc_counter.cpp is not linked");
+            return;
+        }
+        testParser();
+        testAsyncWrite();
+        testSuspendedWrite();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(alloc_budget,http,beast);
+
+} // http
+} // beast
@@ -0,0 +1,54 @@
+//
+// Copyright (c) 2013-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Test that header file is self-contained.
+#include <beast/http/date.hpp>
+
+#include <beast/unit_test/suite.hpp>
+#include <thread>
+
+namespace beast {
+namespace http {
+
+class date_test : public beast::unit_test::suite
+{
+public:
+    void testFormat()
+    {
+        expect(format_date(0) == "Thu, 01 Jan 1970 00:00:00 GMT");
+        expect(format_date(-1) == "Wed, 31 Dec 1969 23:59:59 GMT");
+        expect(format_date(784111777) == "Sun, 06 Nov 1994 08:49:37 GMT");
+        expect(format_date(951782400) == "Tue, 29 Feb 2000 00:00:00 GMT");
+        expect(format_date(1483228799) == "Sat, 31 Dec 2016 23:59:59 GMT");
+        expect(format_date(4107542400) == "Mon, 01 Mar 2100 00:00:00 GMT");
+    }
+
+    void testCurrent()
+    {
+        auto const s1 = current_date();
+        auto const s2 = current_date();
+        expect(s1.size() == 29);
+        // The cached string is reused
+        expect(s1.data() == s2.data());
+        // Each thread has its own cache
+        boost::string_ref s3;
+        std::thread t([&]{ s3 = current_date(); });
+        t.join();
+        expect(s3.data() != s1.data());
+    }
+
+    void run() override
+    {
+        testFormat();
+        testCurrent();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(date,http,beast);
+
+} // http
+} // beast
@@ -0,0 +1,254 @@
+//
+// Copyright (c) 2013-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Test that header file is self-contained.
+#include <beast/http/deflate_body.hpp>
+
+#include <beast/http/headers.hpp>
+#include <beast/http/parser_v1.hpp>
+#include <beast/http/string_body.hpp>
+#include <beast/http/write.hpp>
+#include <beast/unit_test/suite.hpp>
+#include <boost/lexical_cast.hpp>
+#include <algorithm>
+#include <string>
+
+namespace beast {
+namespace http {
+
+// Produces a body in small pieces, suspending
+// before each piece and resuming immediately.
+struct suspend_body
+{
+    struct value_type
+    {
+        std::string text;
+
+        // Incremented when the writer gets an empty resume context
+        int* empty = nullptr;
+    };
+
+    class writer
+    {
+        value_type const& body_;
+        std::size_t pos_ = 0;
+        bool inited_ = false;
+        bool suspend_ = true;
+
+    public:
+        writer(writer const&) = delete;
+        writer& operator=(writer const&) = delete;
+
+        template<bool isRequest, class Headers>
+        explicit
+        writer(message<
+                isRequest, suspend_body, Headers> const& msg)
+            : body_(msg.body)
+        {
+        }
+
+        void
+        init(error_code&)
+        {
+            inited_ = true;
+        }
+
+        std::uint64_t
+        content_length() const
+        {
+            return inited_ ? body_.text.size() : 0;
+        }
+
+        template<class Write>
+        boost::tribool
+        operator()(resume_context&& resume,
+            error_code&, Write&& write)
+        {
+            if(suspend_)
+            {
+                suspend_ = false;
+                if(resume)
+                {
+                    resume_context r(std::move(resume));
+                    r();
+                    return boost::indeterminate;
+                }
+                ++*body_.empty;
+            }
+            suspend_ = true;
+            auto const n = std::min<std::size_t>(
+                7, body_.text.size() - pos_);
+            write(boost::asio::buffer(
+                body_.text.data() + pos_, n));
+            pos_ += n;
+            return pos_ == body_.text.size();
+        }
+    };
+};
+
+class deflate_body_test : public beast::unit_test::suite
+{
+public:
+    using response_type =
+        message_v1<false, deflate_body<string_body>, headers>;
+
+    static
+    std::string
+    inflate(std::string const& in, int windowBits)
+    {
+        std::string out;
+        z_stream zs{};
+        if(inflateInit2(&zs, windowBits) != Z_OK)
+            return out;
+        zs.next_in = reinterpret_cast<Bytef*>(
+            const_cast<char*>(in.data()));
+        zs.avail_in = static_cast<uInt>(in.size());
+        char buf[4096];
+        int result;
+        do
+        {
+            zs.next_out = reinterpret_cast<Bytef*>(buf);
+            zs.avail_out = sizeof(buf);
+            result = ::inflate(&zs, Z_NO_FLUSH);
+            out.append(buf, sizeof(buf) - zs.avail_out);
+        }
+        while(result == Z_OK);
+        inflateEnd(&zs);
+        return out;
+    }
+
+    static
+    message_v1<true, string_body, headers>
+    make_request(std::string const& accept)
+    {
+        message_v1<true, string_body, headers> req;
+        req.method = "GET";
+        req.url = "/";
+        req.version = 11;
+        if(! accept.empty())
+            req.headers.insert("Accept-Encoding", accept);
+        return req;
+    }
+
+    static
+    std::string
+    make_body()
+    {
+        std::string s;
+        for(int i = 0; i < 1000; ++i)
+            s += "{\"id\":" + std::to_string(i) + ",\"ok\":true},";
+        return s;
+    }
+
+    content_coding
+    negotiate(std::string const& accept,
+        std::size_t size = 4096)
+    {
+        response_type resp;
+        resp.version = 11;
+        resp.body.body() = std::string(size, '*');
+        negotiate_encoding(make_request(accept), resp);
+        return resp.body.coding;
+    }
+
+    void testNegotiate()
+    {
+        expect(negotiate("") == content_coding::identity);
+        expect(negotiate("gzip") == content_coding::gzip);
+        expect(negotiate("x-gzip") == content_coding::gzip);
+        expect(negotiate("deflate") == content_coding::deflate);
+        expect(negotiate("gzip, deflate") == content_coding::gzip);
+        expect(negotiate("gzip;q=0.5, deflate") == content_coding::deflate);
+        expect(negotiate("gzip;q=0, deflate;q=0") == content_coding::identity);
+        expect(negotiate("*") == content_coding::gzip);
+        expect(negotiate("*;q=0") == content_coding::identity);
+        expect(negotiate("identity") == content_coding::identity);
+        expect(negotiate("gzip", 10) == content_coding::identity);
+    }
+
+    void testSerialize(std::string const& accept, int windowBits)
+    {
+        auto const body = make_body();
+        response_type resp;
+        resp.status = 200;
+        resp.reason = "OK";
+        resp.version = 11;
+        resp.body.body() = body;
+        negotiate_encoding(make_request(accept), resp);
+        prepare(resp);
+        expect(! resp.headers.exists("Content-Length"));
+        expect(resp.headers["Transfer-Encoding"] == "chunked");
+        auto const s = boost::lexical_cast<std::string>(resp);
+
+        error_code ec;
+        parser_v1<false, string_body, headers> p;
+        p.write(boost::asio::buffer(s), ec);
+        if(! expect(! ec, ec.message()))
+            return;
+        expect(p.complete());
+        auto const m = p.release();
+        expect(m.headers["Content-Encoding"] == accept);
+        expect(m.headers["Vary"] == "Accept-Encoding");
+        expect(m.body.size() < body.size());
+        expect(inflate(m.body, windowBits) == body);
+    }
+
+    void testIdentity()
+    {
+        response_type resp;
+        resp.status = 200;
+        resp.reason = "OK";
+        resp.version = 11;
+        resp.body.body() = "*";
+        negotiate_encoding(make_request("gzip"), resp);
+        prepare(resp);
+        expect(! resp.headers.exists("Content-Encoding"));
+        expect(boost::lexical_cast<std::string>(resp) ==
+            "HTTP/1.1 200 OK\r\nContent-Length: 1\r\n\r\n*");
+    }
+
+    void testSuspend()
+    {
+        auto const body = make_body();
+        int empty = 0;
+        message_v1<false,
+            deflate_body<suspend_body>, headers> resp;
+        resp.status = 200;
+        resp.reason = "OK";
+        resp.version = 11;
+        resp.body.body().text = body;
+        resp.body.body().empty = &empty;
+        expect(resp.body.size() == body.size());
+        negotiate_encoding(make_request("gzip"), resp);
+        expect(resp.body.coding == content_coding::gzip);
+        prepare(resp);
+        auto const s = boost::lexical_cast<std::string>(resp);
+        expect(empty == 0);
+
+        error_code ec;
+        parser_v1<false, string_body, headers> p;
+        p.write(boost::asio::buffer(s), ec);
+        if(! expect(! ec, ec.message()))
+            return;
+        expect(p.complete());
+        expect(inflate(p.release().body, 15 + 16) == body);
+    }
+
+    void run() override
+    {
+        testNegotiate();
+        testSerialize("gzip", 15 + 16);
+        testSerialize("deflate", 15);
+        testIdentity();
+        testSuspend();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(deflate_body,http,beast);
+
+} // http
+} // beast
@@ -0,0 +1,378 @@
+//
+// Copyright (c) 2013-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// An HTTP load generator which measures throughput and latency of a
+// server such as http-server. Each connection keeps up to `depth`
+// requests in flight; a depth above one pipelines the requests. The
+// run lasts for a duration, or until a number of requests complete.
+//
+// Every thread runs its own io_service and owns a share of the
+// connections, so connections need no synchronization.
+//
+// usage: http-bench --port 8080 --connections 64 --depth 4 --duration 10
+
+#include <beast/http.hpp>
+#include <beast/core/streambuf.hpp>
+#include <beast/test/latency_histogram.hpp>
+#include <boost/asio.hpp>
+#include <boost/program_options.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace beast {
+namespace http {
+
+using clock_type = std::chrono::steady_clock;
+
+struct options
+{
+    std::string host = "127.0.0.1";
+    std::uint16_t port = 8080;
+    std::string target = "/";
+    std::size_t connections = 64;
+    std::size_t depth = 1;
+    std::size_t threads = 1;
+    std::size_t seconds = 10;
+    std::size_t requests = 0;   // 0 to run for `seconds`
+    bool json = false;
+};
+
+// State shared by all threads
+struct run_state
+{
+    std::atomic<bool> stop{false};
+    std::atomic<std::size_t> started{0};
+    std::atomic<std::size_t> errors{0};
+    std::size_t limit = 0;
+};
+
+// State owned by one thread
+struct thread_state
+{
+    boost::asio::io_service ios;
+    test::latency_histogram latency;
+    std::uint64_t responses = 0;
+    std::uint64_t body_bytes = 0;
+};
+
+class bench_connection
+    : public std::enable_shared_from_this<bench_connection>
+{
+    using socket_type = boost::asio::ip::tcp::socket;
+    using request_type = request_v1<empty_body>;
+    using response_type = response_v1<string_body>;
+
+    socket_type sock_;
+    request_type const& req_;
+    options const& opt_;
+    run_state& run_;
+    thread_state& ts_;
+    streambuf sb_;
+    response_type res_;
+    std::deque<clock_type::time_point> sent_;
+    bool writing_ = false;
+    bool reading_ = false;
+
+public:
+    bench_connection(socket_type&& sock, request_type const& req,
+            options const& opt, run_state& run, thread_state& ts)
+        : sock_(std::move(sock))
+        , req_(req)
+        , opt_(opt)
+        , run_(run)
+        , ts_(ts)
+    {
+    }
+
+    void
+    run()
+    {
+        do_write();
+    }
+
+private:
+    bool
+    more()
+    {
+        if(run_.stop)
+            return false;
+        if(run_.limit == 0)
+            return true;
+        if(++run_.started <= run_.limit)
+            return true;
+        --run_.started;
+        return false;
+    }
+
+    void
+    do_write()
+    {
+        if(writing_ || sent_.size() >= opt_.depth)
+            return;
+        if(! more())
+            return maybe_close();
+        writing_ = true;
+        sent_.push_back(clock_type::now());
+        auto self = shared_from_this();
+        async_write(sock_, req_,
+            [self](error_code ec)
+            {
+                self->on_write(ec);
+            });
+    }
+
+    void
+    on_write(error_code ec)
+    {
+        writing_ = false;
+        if(ec)
+            return fail();
+        do_read();
+        do_write();
+    }
+
+    void
+    do_read()
+    {
+        if(reading_ || sent_.empty())
+            return;
+        reading_ = true;
+        res_ = response_type{};
+        auto self = shared_from_this();
+        async_read(sock_, sb_, res_,
+            [self](error_code ec)
+            {
+                self->on_read(ec);
+            });
+    }
+
+    void
+    on_read(error_code ec)
+    {
+        reading_ = false;
+        if(ec)
+            return fail();
+        auto const elapsed = clock_type::now() - sent_.front();
+        sent_.pop_front();
+        if(! run_.stop)
+        {
+            ts_.latency.record(static_cast<std::uint64_t>(
+                std::chrono::duration_cast<
+                    std::chrono::nanoseconds>(elapsed).count()));
+            ++ts_.responses;
+            ts_.body_bytes += res_.body.size();
+        }
+        do_read();
+        do_write();
+        maybe_close();
+    }
+
+    void
+    fail()
+    {
+        ++run_.errors;
+        sent_.clear();
+        close();
+    }
+
+    // Close once nothing is in flight and no more will be sent
+    void
+    maybe_close()
+    {
+        if(! writing_ && ! reading_ && sent_.empty())
+            close();
+    }
+
+    void
+    close()
+    {
+        error_code ec;
+        sock_.shutdown(socket_type::shutdown_both, ec);
+        sock_.close(ec);
+    }
+};
+
+std::string
+to_json(options const& opt, double seconds,
+    std::uint64_t responses, std::uint64_t bytes,
+        std::size_t errors, test::latency_histogram const& h)
+{
+    auto const us =
+        [&](double p)
+        {
+            return static_cast<double>(h.percentile(p)) / 1000;
+        };
+    std::ostringstream ss;
+    ss << std::fixed << std::setprecision(1) <<
+        "{\"connections\":" << opt.connections <<
+        ",\"depth\":" << opt.depth <<
+        ",\"threads\":" << opt.threads <<
+        ",\"seconds\":" << seconds <<
+        ",\"responses\":" << responses <<
+        ",\"errors\":" << errors <<
+        ",\"requests_per_second\":" << responses / seconds <<
+        ",\"body_bytes_per_second\":" << bytes / seconds <<
+        ",\"latency_us\":{" <<
+            "\"p50\":" << us(50) <<
+            ",\"p90\":" << us(90) <<
+            ",\"p99\":" << us(99) <<
+            ",\"p99.9\":" << us(99.9) <<
+            ",\"max\":" << static_cast<double>(h.max()) / 1000 <<
+        "}}";
+    return ss.str();
+}
+
+int
+bench(options const& opt)
+{
+    using namespace boost::asio;
+    request_v1<empty_body> req;
+    req.method = "GET";
+    req.url = opt.target;
+    req.version = 11;
+    req.headers.insert("Host", opt.host + ":" +
+        std::to_string(opt.port));
+    req.headers.insert("User-Agent", "http-bench");
+    prepare(req);
+
+    run_state run;
+    run.limit = opt.requests;
+    std::vector<std::unique_ptr<thread_state>> ts;
+    for(std::size_t i = 0; i < opt.threads; ++i)
+        ts.emplace_back(new thread_state);
+    ip::tcp::endpoint const ep{
+        ip::address::from_string(opt.host), opt.port};
+    for(std::size_t i = 0; i < opt.connections; ++i)
+    {
+        auto& t = *ts[i % ts.size()];
+        ip::tcp::socket sock(t.ios);
+        error_code ec;
+        sock.connect(ep, ec);
+        if(ec)
+        {
+            std::cerr << "connect: " << ec.message() << std::endl;
+            return EXIT_FAILURE;
+        }
+        sock.set_option(ip::tcp::no_delay{true});
+        std::make_shared<bench_connection>(
+            std::move(sock), req, opt, run, t)->run();
+    }
+    auto const t0 = clock_type::now();
+    std::vector<std::thread> v;
+    v.reserve(ts.size());
+    for(auto& t : ts)
+    {
+        auto& ios = t->ios;
+        v.emplace_back([&ios]{ ios.run(); });
+    }
+    auto t1 = t0;
+    if(opt.requests == 0)
+    {
+        std::this_thread::sleep_for(
+            std::chrono::seconds(opt.seconds));
+        run.stop = true;
+        t1 = clock_type::now();
+    }
+    for(auto& t : v)
+        t.join();
+    if(opt.requests != 0)
+        t1 = clock_type::now();
+
+    test::latency_histogram h;
+    std::uint64_t responses = 0;
+    std::uint64_t bytes = 0;
+    for(auto const& t : ts)
+    {
+        h.merge(t->latency);
+        responses += t->responses;
+        bytes += t->body_bytes;
+    }
+    auto const seconds =
+        std::chrono::duration<double>(t1 - t0).count();
+    if(opt.json)
+    {
+        std::cout << to_json(opt, seconds,
+            responses, bytes, run.errors, h) << std::endl;
+        return EXIT_SUCCESS;
+    }
+    auto const us =
+        [&](double p)
+        {
+            return static_cast<double>(h.percentile(p)) / 1000;
+        };
+    std::cout << std::fixed << std::setprecision(1) <<
+        "connections=" << opt.connections <<
+        " depth=" << opt.depth <<
+        " threads=" << opt.threads << "\n" <<
+        "responses:   " << responses <<
+            " in " << seconds << "s, " <<
+            run.errors << " errors\n" <<
+        "throughput:  " << responses / seconds << " requests/s, " <<
+            bytes / seconds / (1024 * 1024) << " MB/s of body\n" <<
+        "latency us:  p50=" << us(50) <<
+            " p90=" << us(90) <<
+            " p99=" << us(99) <<
+            " p99.9=" << us(99.9) <<
+            " max=" << static_cast<double>(h.max()) / 1000 <<
+        std::endl;
+    return EXIT_SUCCESS;
+}
+
+} // http
+} // beast
+
+int
+main(int ac, char const* av[])
+{
+    namespace po = boost::program_options;
+    beast::http::options opt;
+    po::options_description desc("Options");
+    desc.add_options()
+        ("help,h",          "Show this message")
+        ("host",            po::value(&opt.host),
+                            "Set the IP address of the server")
+        ("port,p",          po::value(&opt.port),
+                            "Set the port number of the server")
+        ("target",          po::value(&opt.target),
+                            "Set the request target")
+        ("connections,c",   po::value(&opt.connections),
+                            "Set the number of connections")
+        ("depth,d",         po::value(&opt.depth),
+                            "Set the requests in flight per connection, "
+                            "above one pipelines requests")
+        ("threads,t",       po::value(&opt.threads),
+                            "Set the number of threads")
+        ("duration",        po::value(&opt.seconds),
+                            "Run for this many seconds")
+        ("requests,n",      po::value(&opt.requests),
+                            "Run until this many requests complete")
+        ("json",            "Print the results as JSON")
+        ;
+    po::variables_map vm;
+    po::store(po::parse_command_line(ac, av, desc), vm);
+    po::notify(vm);
+    if(vm.count("help"))
+    {
+        std::cout << desc << std::endl;
+        return EXIT_SUCCESS;
+    }
+    opt.json = vm.count("json") > 0;
+    if(opt.depth < 1)
+        opt.depth = 1;
+    if(opt.threads < 1)
+        opt.threads = 1;
+    return beast::http::bench(opt);
+}
@@ -0,0 +1,468 @@
+//
+// Copyright (c) 2013-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Measures HTTP parsers on corpora shaped like real traffic, reporting
+// MB/s, messages/s and heap allocations per message for each pair of
+// corpus and parser. The corpora come from a seeded generator, so runs
+// with the same seed parse exactly the same bytes.
+//
+// usage: http-parser-bench [--seed N] [--messages N] [--seconds N]
+//                          [--corpus name] [--parser name]
+
+#include "nodejs_parser.hpp"
+
+#include <beast/http.hpp>
+#include <beast/core/streambuf.hpp>
+#include <beast/test/alloc_counter.hpp>
+#include <boost/program_options.hpp>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace beast {
+namespace http {
+
+// A set of buffers holding complete messages. A
+// buffer holds more than one when pipelined.
+struct corpus
+{
+    std::string name;
+    bool request;
+    std::vector<std::string> buffers;
+    std::size_t messages = 0;
+    std::size_t bytes = 0;
+
+    corpus(std::string name_, bool request_)
+        : name(std::move(name_))
+        , request(request_)
+    {
+    }
+
+    void
+    add(std::string s, std::size_t count = 1)
+    {
+        bytes += s.size();
+        messages += count;
+        buffers.emplace_back(std::move(s));
+    }
+};
+
+class corpus_builder
+{
+    std::mt19937 rng_;
+
+public:
+    explicit
+    corpus_builder(std::uint32_t seed)
+        : rng_(seed)
+    {
+    }
+
+    // Browser navigation and subresource requests
+    corpus
+    browser(std::size_t n)
+    {
+        corpus c{"browser", true};
+        for(std::size_t i = 0; i < n; ++i)
+            c.add(browser_request());
+        return c;
+    }
+
+    // API calls with a bearer token, a large
+    // Cookie header and a JSON body.
+    corpus
+    api(std::size_t n)
+    {
+        corpus c{"api-cookie", true};
+        for(std::size_t i = 0; i < n; ++i)
+        {
+            auto const body = json(rand(100, 2000));
+            std::string s =
+                pick({"POST", "PUT", "PATCH"}) + " /api/v2/" +
+                    pick({"orders", "users", "sessions", "carts"}) +
+                    "/" + std::to_string(rand(1, 999999)) + " HTTP/1.1\r\n"
+                "Host: api.example.com\r\n"
+                "Authorization: Bearer " + token(rand(600, 1200)) + "\r\n"
+                "Content-Type: application/json\r\n"
+                "Accept: application/json\r\n"
+                "X-Request-Id: " + uuid() + "\r\n"
+                "Cookie: " + cookies(rand(30, 80)) + "\r\n"
+                "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                "\r\n" + body;
+            c.add(std::move(s));
+        }
+        return c;
+    }
+
+    // Responses with chunked bodies, sometimes
+    // with chunk extensions and trailers.
+    corpus
+    chunked(std::size_t n)
+    {
+        corpus c{"chunked", false};
+        for(std::size_t i = 0; i < n; ++i)
+        {
+            std::string s =
+                "HTTP/1.1 200 OK\r\n"
+                "Server: nginx\r\n"
+                "Date: Tue, 15 Nov 2016 08:12:31 GMT\r\n"
+                "Content-Type: " +
+                    pick({"text/html; charset=utf-8",
+                        "application/json", "text/event-stream"}) + "\r\n"
+                "Transfer-Encoding: chunked\r\n"
+                "Connection: keep-alive\r\n"
+                "\r\n";
+            auto const chunks = rand(2, 20);
+            for(std::size_t j = 0; j < chunks; ++j)
+            {
+                auto const size = rand(16, 4096);
+                s += to_hex(size);
+                if(rand(0, 9) == 0)
+                    s += ";ext=" + std::to_string(j);
+                s += "\r\n" + std::string(size, 'a' + j % 26) + "\r\n";
+            }
+            s += "0\r\n";
+            if(rand(0, 3) == 0)
+                s += "Expires: Wed, 16 Nov 2016 08:12:31 GMT\r\n";
+            s += "\r\n";
+            c.add(std::move(s));
+        }
+        return c;
+    }
+
+    // Load balancer health checks
+    corpus
+    health(std::size_t n)
+    {
+        corpus c{"health", true};
+        for(std::size_t i = 0; i < n; ++i)
+            c.add(health_request());
+        return c;
+    }
+
+    // Batches of small requests sent back to back
+    corpus
+    pipelined(std::size_t n)
+    {
+        corpus c{"pipelined", true};
+        while(c.messages < n)
+        {
+            auto const count = (std::min)(rand(8, 32), n - c.messages);
+            std::string s;
+            for(std::size_t j = 0; j < count; ++j)
+                s += rand(0, 1) ? health_request() :
+                    "GET /static/" + word(rand(4, 12)) + ".js HTTP/1.1\r\n"
+                    "Host: cdn.example.com\r\n"
+                    "Accept: */*\r\n"
+                    "\r\n";
+            c.add(std::move(s), count);
+        }
+        return c;
+    }
+
+private:
+    std::size_t
+    rand(std::size_t lo, std::size_t hi)
+    {
+        return std::uniform_int_distribution<
+            std::size_t>{lo, hi}(rng_);
+    }
+
+    std::string
+    pick(std::initializer_list<char const*> list)
+    {
+        return *(list.begin() + rand(0, list.size() - 1));
+    }
+
+    std::string
+    word(std::size_t n)
+    {
+        std::string s;
+        s.reserve(n);
+        for(std::size_t i = 0; i < n; ++i)
+            s.push_back(static_cast<char>('a' + rand(0, 25)));
+        return s;
+    }
+
+    std::string
+    token(std::size_t n)
+    {
+        static char const alphabet[] =
+            "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+        std::string s;
+        s.reserve(n);
+        for(std::size_t i = 0; i < n; ++i)
+            s.push_back(alphabet[rand(0, 63)]);
+        return s;
+    }
+
+    static
+    std::string
+    to_hex(std::size_t v)
+    {
+        std::string s;
+        do
+        {
+            s.insert(s.begin(), "0123456789abcdef"[v & 0xf]);
+            v >>= 4;
+        }
+        while(v > 0);
+        return s;
+    }
+
+    std::string
+    uuid()
+    {
+        std::string s;
+        for(int i = 0; i < 32; ++i)
+        {
+            if(i == 8 || i == 12 || i == 16 || i == 20)
+                s.push_back('-');
+            s.push_back("0123456789abcdef"[rand(0, 15)]);
+        }
+        return s;
+    }
+
+    std::string
+    cookies(std::size_t n)
+    {
+        std::string s;
+        for(std::size_t i = 0; i < n; ++i)
+        {
+            if(i > 0)
+                s += "; ";
+            s += word(rand(3, 12)) + "=" + token(rand(8, 96));
+        }
+        return s;
+    }
+
+    std::string
+    json(std::size_t n)
+    {
+        std::string s = "{";
+        while(s.size() < n)
+        {
+            if(s.size() > 1)
+                s += ",";
+            s += "\"" + word(rand(3, 10)) + "\":\"" +
+                word(rand(5, 40)) + "\"";
+        }
+        s += "}";
+        return s;
+    }
+
+    std::string
+    browser_request()
+    {
+        std::string path = "/";
+        for(auto j = rand(1, 4); j > 0; --j)
+            path += word(rand(3, 10)) + "/";
+        if(rand(0, 1))
+            path += "?q=" + word(rand(3, 20)) + "&page=" +
+                std::to_string(rand(1, 50));
+        return
+            "GET " + path + " HTTP/1.1\r\n"
+            "Host: www.example.com\r\n"
+            "Connection: keep-alive\r\n"
+            "Upgrade-Insecure-Requests: 1\r\n"
+            "User-Agent: " + pick({
+                "Mozilla/5.0 (Windows NT 10.0; Win64; x64) AppleWebKit/537.36 "
+                    "(KHTML, like Gecko) Chrome/54.0.2840.99 Safari/537.36",
+                "Mozilla/5.0 (Macintosh; Intel Mac OS X 10_12_1) "
+                    "AppleWebKit/602.2.14 (KHTML, like Gecko) "
+                    "Version/10.0.1 Safari/602.2.14",
+                "Mozilla/5.0 (X11; Ubuntu; Linux x86_64; rv:50.0) "
+                    "Gecko/20100101 Firefox/50.0"}) + "\r\n"
+            "Accept: text/html,application/xhtml+xml,application/xml;"
+                "q=0.9,image/webp,*/*;q=0.8\r\n"
+            "Referer: https://www.example.com/" + word(rand(4, 12)) + "\r\n"
+            "Accept-Encoding: gzip, deflate, sdch, br\r\n"
+            "Accept-Language: en-US,en;q=0.8\r\n"
+            "Cookie: " + cookies(rand(5, 15)) + "\r\n"
+            "\r\n";
+    }
+
+    std::string
+    health_request()
+    {
+        return
+            "GET " + pick({"/health", "/healthz", "/ping"}) +
+                " HTTP/1.1\r\n"
+            "Host: 10.0.0." + std::to_string(rand(1, 254)) + "\r\n"
+            "\r\n";
+    }
+};
+
+//------------------------------------------------------------------------------
+
+template<bool isRequest>
+struct null_parser : basic_parser_v1<isRequest, null_parser<isRequest>>
+{
+};
+
+// Parses every message in the corpus, a new parser
+// for each message as a server would use.
+template<class Parser>
+bool
+parse_corpus(corpus const& c)
+{
+    for(auto const& s : c.buffers)
+    {
+        auto p = s.data();
+        auto left = s.size();
+        while(left > 0)
+        {
+            Parser parser;
+            error_code ec;
+            auto const used = parser.write(
+                boost::asio::buffer(p, left), ec);
+            if(ec || used == 0)
+            {
+                std::cerr << c.name << ": " <<
+                    ec.message() << std::endl;
+                return false;
+            }
+            p += used;
+            left -= used;
+        }
+    }
+    return true;
+}
+
+struct result
+{
+    double mb_per_second;
+    double messages_per_second;
+    double allocations_per_message;
+};
+
+result
+measure(corpus const& c, std::function<bool(corpus const&)> const& f,
+    double seconds)
+{
+    using clock_type = std::chrono::steady_clock;
+    // Warm up the caches and check
+    // that the corpus parses.
+    if(! f(c))
+        return {0, 0, 0};
+    std::size_t passes = 0;
+    test::alloc_counter counter;
+    auto const t0 = clock_type::now();
+    double elapsed;
+    do
+    {
+        f(c);
+        ++passes;
+        elapsed = std::chrono::duration<double>(
+            clock_type::now() - t0).count();
+    }
+    while(elapsed < seconds);
+    auto const allocations = counter.allocations();
+    auto const messages =
+        static_cast<double>(passes * c.messages);
+    return {
+        passes * c.bytes / elapsed / (1024 * 1024),
+        messages / elapsed,
+        allocations / messages};
+}
+
+template<bool isRequest>
+std::vector<std::pair<std::string,
+    std::function<bool(corpus const&)>>>
+parsers()
+{
+    return {
+        {"basic_parser_v1",
+            &parse_corpus<null_parser<isRequest>>},
+        {"parser_v1",
+            &parse_corpus<parser_v1<isRequest, streambuf_body, headers>>},
+        {"nodejs_parser",
+            &parse_corpus<nodejs_parser<isRequest, streambuf_body, headers>>},
+    };
+}
+
+} // http
+} // beast
+
+int
+main(int ac, char const* av[])
+{
+    using namespace beast::http;
+    namespace po = boost::program_options;
+    std::uint32_t seed = 1;
+    std::size_t messages = 2000;
+    double seconds = 1;
+    std::string only_corpus;
+    std::string only_parser;
+    po::options_description desc("Options");
+    desc.add_options()
+        ("help,h",      "Show this message")
+        ("seed",        po::value(&seed),
+                        "Set the seed for generating corpora")
+        ("messages,n",  po::value(&messages),
+                        "Set the number of messages in each corpus")
+        ("seconds,s",   po::value(&seconds),
+                        "Set the time to run each measurement")
+        ("corpus",      po::value(&only_corpus),
+                        "Run only this corpus: browser, api-cookie, "
+                        "chunked, health or pipelined")
+        ("parser",      po::value(&only_parser),
+                        "Run only this parser: basic_parser_v1, "
+                        "parser_v1 or nodejs_parser")
+        ;
+    po::variables_map vm;
+    po::store(po::parse_command_line(ac, av, desc), vm);
+    po::notify(vm);
+    if(vm.count("help"))
+    {
+        std::cout << desc << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    corpus_builder b(seed);
+    std::vector<corpus> v;
+    v.emplace_back(b.browser(messages));
+    v.emplace_back(b.api(messages));
+    v.emplace_back(b.chunked(messages));
+    v.emplace_back(b.health(messages));
+    v.emplace_back(b.pipelined(messages));
+
+    std::cout <<
+        "seed=" << seed << " messages=" << messages << "\n" <<
+        std::left << std::setw(12) << "corpus" <<
+        std::setw(17) << "parser" <<
+        std::right << std::setw(10) << "MB/s" <<
+        std::setw(14) << "messages/s" <<
+        std::setw(12) << "allocs/msg" << std::endl;
+    for(auto const& c : v)
+    {
+        if(! only_corpus.empty() && c.name != only_corpus)
+            continue;
+        auto const list = c.request ?
+            parsers<true>() : parsers<false>();
+        for(auto const& p : list)
+        {
+            if(! only_parser.empty() && p.first != only_parser)
+                continue;
+            auto const r = measure(c, p.second, seconds);
+            std::cout << std::fixed <<
+                std::left << std::setw(12) << c.name <<
+                std::setw(17) << p.first <<
+                std::right << std::setprecision(1) <<
+                std::setw(10) << r.mb_per_second <<
+                std::setprecision(0) <<
+                std::setw(14) << r.messages_per_second <<
+                std::setprecision(2) <<
+                std::setw(12) << r.allocations_per_message << std::endl;
+        }
+    }
+}
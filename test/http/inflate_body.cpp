@@ -0,0 +1,179 @@
+//
+// Copyright (c) 2013-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Test that header file is self-contained.
+#include <beast/http/inflate_body.hpp>
+
+#include <beast/http/headers.hpp>
+#include <beast/http/parser_v1.hpp>
+#include <beast/http/string_body.hpp>
+#include <beast/unit_test/suite.hpp>
+#include <string>
+
+namespace beast {
+namespace http {
+
+class inflate_body_test : public beast::unit_test::suite
+{
+public:
+    using parser_type =
+        parser_v1<true, inflate_body<string_body>, headers>;
+
+    static
+    std::string
+    deflate(std::string const& in, int windowBits)
+    {
+        std::string out;
+        z_stream zs{};
+        if(deflateInit2(&zs, Z_DEFAULT_COMPRESSION,
+                Z_DEFLATED, windowBits, 8,
+                    Z_DEFAULT_STRATEGY) != Z_OK)
+            return out;
+        zs.next_in = reinterpret_cast<Bytef*>(
+            const_cast<char*>(in.data()));
+        zs.avail_in = static_cast<uInt>(in.size());
+        char buf[4096];
+        int result;
+        do
+        {
+            zs.next_out = reinterpret_cast<Bytef*>(buf);
+            zs.avail_out = sizeof(buf);
+            result = ::deflate(&zs, Z_FINISH);
+            out.append(buf, sizeof(buf) - zs.avail_out);
+        }
+        while(result == Z_OK);
+        deflateEnd(&zs);
+        return out;
+    }
+
+    static
+    std::string
+    make_body(std::size_t size)
+    {
+        std::string s;
+        while(s.size() < size)
+            s += "{\"sensor\":42,\"value\":3.14159},";
+        s.resize(size);
+        return s;
+    }
+
+    static
+    std::string
+    make_request(std::string const& coding,
+        std::string const& body)
+    {
+        std::string s =
+            "POST /telemetry HTTP/1.1\r\n"
+            "Content-Length: " + std::to_string(body.size()) + "\r\n";
+        if(! coding.empty())
+            s += "Content-Encoding: " + coding + "\r\n";
+        return s + "\r\n" + body;
+    }
+
+    // Feed the message a few octets at a time
+    static
+    void
+    parse(parser_type& p, std::string const& s,
+        std::size_t step, error_code& ec)
+    {
+        using boost::asio::buffer;
+        std::size_t pos = 0;
+        while(pos < s.size() && ! ec)
+        {
+            auto const n = p.write(buffer(
+                s.data() + pos, std::min(step, s.size() - pos)), ec);
+            pos += n;
+            if(n == 0)
+                break;
+        }
+    }
+
+    void
+    testInflate(std::string const& coding, int windowBits)
+    {
+        auto const body = make_body(100000);
+        auto const s = make_request(coding,
+            deflate(body, windowBits));
+        for(std::size_t step : {1, 7, 1000, 100000})
+        {
+            error_code ec;
+            parser_type p;
+            parse(p, s, step, ec);
+            if(! expect(! ec, ec.message()))
+                return;
+            expect(p.complete());
+            auto const m = p.release();
+            expect(m.body.body() == body);
+            expect(m.body.coding == (coding == "deflate" ?
+                content_coding::deflate : content_coding::gzip));
+        }
+    }
+
+    void
+    testIdentity()
+    {
+        error_code ec;
+        parser_type p;
+        parse(p, make_request("", "*"), 1, ec);
+        expect(! ec);
+        expect(p.complete());
+        expect(p.get().body.body() == "*");
+        expect(p.get().body.coding == content_coding::identity);
+    }
+
+    void
+    testErrors()
+    {
+        {
+            error_code ec;
+            parser_type p;
+            parse(p, make_request("br", "*"), 1000, ec);
+            expect(ec == parse_error::bad_content_encoding);
+        }
+        {
+            error_code ec;
+            parser_type p;
+            parse(p, make_request("gzip", "not gzip"), 1000, ec);
+            expect(ec == parse_error::bad_content_encoding);
+        }
+        {
+            // The compressed body is cut short
+            auto const z = deflate(make_body(100000), 15 + 16);
+            auto const s = make_request("gzip", z.substr(0, z.size() / 2));
+            error_code ec;
+            parser_type p;
+            parse(p, s, 1000, ec);
+            expect(ec == parse_error::bad_content_encoding);
+            expect(! p.complete());
+        }
+        {
+            // A small compressed body which expands past the limit
+            auto const s = make_request("gzip",
+                deflate(std::string(1000000, '\0'), 15 + 16));
+            expect(s.size() < 10000);
+            error_code ec;
+            parser_type p;
+            p.get().body.max_size = 65536;
+            parse(p, s, 1000, ec);
+            expect(ec == parse_error::body_too_big);
+            expect(p.get().body.body().size() <= 65536);
+        }
+    }
+
+    void run() override
+    {
+        testInflate("gzip", 15 + 16);
+        testInflate("deflate", 15);
+        testIdentity();
+        testErrors();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(inflate_body,http,beast);
+
+} // http
+} // beast
@@ -80,6 +80,33 @@ public:
         expect(! is_keep_alive(m));
     }
 
+    void testPrepareDate()
+    {
+        {
+            response_v1<empty_body> m;
+            m.status = 200;
+            m.version = 11;
+            prepare(m, date::now);
+            expect(m.headers["Date"].size() == 29);
+            expect(m.headers["Date"].ends_with(" GMT"));
+        }
+        {
+            response_v1<empty_body> m;
+            m.status = 200;
+            m.version = 11;
+            m.headers.insert("Date", "Sun, 06 Nov 1994 08:49:37 GMT");
+            prepare(m, connection::keep_alive, date::now);
+            expect(m.headers["Date"] == "Sun, 06 Nov 1994 08:49:37 GMT");
+        }
+        {
+            response_v1<empty_body> m;
+            m.status = 200;
+            m.version = 11;
+            prepare(m);
+            expect(! m.headers.exists("Date"));
+        }
+    }
+
     void testSwap()
     {
         message_v1<false, string_body, headers> m1;
@@ -109,6 +136,7 @@ public:
     {
         testFreeFunctions();
         testPrepare();
+        testPrepareDate();
         testSwap();
     }
 };
@@ -7,3 +7,89 @@
 
 // Test that header file is self-contained.
 #include <beast/http/resume_context.hpp>
+
+#include <beast/unit_test/suite.hpp>
+#include <memory>
+
+namespace beast {
+namespace http {
+
+class resume_context_test : public beast::unit_test::suite
+{
+public:
+    void
+    testEmpty()
+    {
+        resume_context rc;
+        expect(! rc);
+        rc();
+        resume_context rc2 = std::move(rc);
+        expect(! rc2);
+    }
+
+    void
+    testInvoke()
+    {
+        int n = 0;
+        resume_context rc{[&n]{ ++n; }};
+        expect(static_cast<bool>(rc));
+        resume_context rc2(std::move(rc));
+        expect(! rc);
+        expect(static_cast<bool>(rc2));
+        rc = std::move(rc2);
+        expect(! rc2);
+        rc();
+        expect(n == 1);
+        expect(! rc);
+        rc();
+        expect(n == 1);
+    }
+
+    void
+    testLifetime()
+    {
+        // Room for a shared_ptr, with no allocation
+        auto sp = std::make_shared<int>(0);
+        {
+            resume_context rc{[sp]{ ++*sp; }};
+            expect(sp.use_count() == 2);
+            rc = {};
+            expect(! rc);
+            expect(sp.use_count() == 1);
+            rc = resume_context{[sp]{ ++*sp; }};
+            resume_context rc2{std::move(rc)};
+            expect(sp.use_count() == 2);
+        }
+        expect(sp.use_count() == 1);
+        expect(*sp == 0);
+
+        // The function may assign a new
+        // function to the resume context.
+        resume_context rc;
+        rc = resume_context{
+            [&rc, &sp]
+            {
+                ++*sp;
+                rc = resume_context{[sp]{ ++*sp; }};
+            }};
+        rc();
+        expect(*sp == 1);
+        expect(static_cast<bool>(rc));
+        rc();
+        expect(*sp == 2);
+        expect(! rc);
+        expect(sp.use_count() == 1);
+    }
+
+    void run() override
+    {
+        testEmpty();
+        testInvoke();
+        testLifetime();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(resume_context,http,beast);
+
+} // http
+} // beast
@@ -0,0 +1,99 @@
+//
+// Copyright (c) 2013-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// Test that header file is self-contained.
+#include <beast/http/rfc7233.hpp>
+
+#include <beast/unit_test/suite.hpp>
+#include <string>
+#include <vector>
+
+namespace beast {
+namespace http {
+namespace test {
+
+class rfc7233_test : public beast::unit_test::suite
+{
+public:
+    static
+    std::string
+    str(std::vector<byte_range> const& v)
+    {
+        std::string s;
+        for(auto const& r : v)
+        {
+            if(! s.empty())
+                s.push_back(',');
+            s.append(std::to_string(r.first));
+            s.push_back('-');
+            s.append(std::to_string(r.last));
+        }
+        return s;
+    }
+
+    void
+    testParse()
+    {
+        auto const good =
+            [&](std::string const& s, std::uint64_t size,
+                std::string const& answer)
+            {
+                std::vector<byte_range> v;
+                expect(parse_ranges(s, size, v), s);
+                expect(str(v) == answer, s + " -> " + str(v));
+            };
+        auto const bad =
+            [&](std::string const& s)
+            {
+                std::vector<byte_range> v;
+                expect(! parse_ranges(s, 10000, v), s);
+                expect(v.empty(), s);
+            };
+        good("bytes=0-499",                 10000, "0-499");
+        good("bytes=500-999",               10000, "500-999");
+        good("bytes=-500",                  10000, "9500-9999");
+        good("bytes=9500-",                 10000, "9500-9999");
+        good("bytes=0-0,-1",                10000, "0-0,9999-9999");
+        good("bytes=500-600,601-999",       10000, "500-600,601-999");
+        good("bytes=500-700,601-999",       10000, "500-700,601-999");
+        good("BYTES=0-1",                   10000, "0-1");
+        good(" bytes=0-1 , 3-4 ",           10000, "0-1,3-4");
+        good("bytes=,0-1,,",                10000, "0-1");
+        good("bytes=0-99999",               10000, "0-9999");
+        good("bytes=-99999",                10000, "0-9999");
+        good("bytes=0-99999999999999999999", 10000, "0-9999");
+        good("bytes=1-2",                   0,     "");
+        good("bytes=-1",                    0,     "");
+        good("bytes=-0",                    10000, "");
+        good("bytes=10000-",                10000, "");
+        good("bytes=20000-30000,0-1",       10000, "0-1");
+
+        bad("");
+        bad("bytes");
+        bad("bytes=");
+        bad("bytes=,");
+        bad("bits=0-1");
+        bad("bytes 0-1");
+        bad("bytes=1");
+        bad("bytes=-");
+        bad("bytes=a-b");
+        bad("bytes=2-1");
+        bad("bytes=0-1;");
+        bad("bytes=0-1,x");
+    }
+
+    void run() override
+    {
+        testParse();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(rfc7233,http,beast);
+
+} // test
+} // http
+} // beast
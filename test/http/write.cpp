@@ -20,8 +20,11 @@
 #include <beast/test/yield_to.hpp>
 #include <beast/unit_test/suite.hpp>
 #include <boost/asio/error.hpp>
+#include <memory>
 #include <sstream>
 #include <string>
+#include <thread>
+#include <vector>
 
 namespace beast {
 namespace http {
@@ -164,6 +167,7 @@ public:
             value_type const& body_;
             bool suspend_ = false;
             enable_yield_to yt_;
+            resume_context rc_;
 
         public:
             template<bool isRequest, class Allocator>
@@ -179,24 +183,6 @@ public:
                 body_.fc_.fail(ec);
             }
 
-            class do_resume
-            {
-                resume_context rc_;
-
-            public:
-                explicit
-                do_resume(resume_context&& rc)
-                    : rc_(std::move(rc))
-                {
-                }
-
-                void
-                operator()()
-                {
-                    rc_();
-                }
-            };
-
             template<class Write>
             boost::tribool
             operator()(resume_context&& rc, error_code& ec, Write&& write)
@@ -206,7 +192,15 @@ public:
                 suspend_ = ! suspend_;
                 if(suspend_)
                 {
-                    yt_.get_io_service().post(do_resume{std::move(rc)});
+                    // resume_context is move-only,
+                    // so it is parked in the writer.
+                    rc_ = std::move(rc);
+                    yt_.get_io_service().post(
+                        [this]
+                        {
+                            auto rc = std::move(rc_);
+                            rc();
+                        });
                     return boost::indeterminate;
                 }
                 if(n_ >= body_.s_.size())
@@ -218,6 +212,61 @@ public:
         };
     };
 
+    // Resumes the write from another thread
+    struct thread_body
+    {
+        class writer;
+
+        struct value_type
+        {
+            std::string s;
+            std::thread::id io_thread;
+            mutable std::vector<std::thread> threads;
+            mutable int off_thread = 0;
+        };
+
+        class writer
+        {
+            std::size_t n_ = 0;
+            value_type const& body_;
+            bool suspend_ = false;
+
+        public:
+            template<bool isRequest, class Allocator>
+            explicit
+            writer(message<isRequest, thread_body, Allocator> const& msg)
+                : body_(msg.body)
+            {
+            }
+
+            void
+            init(error_code&)
+            {
+            }
+
+            template<class Write>
+            boost::tribool
+            operator()(resume_context&& rc, error_code&, Write&& write)
+            {
+                if(std::this_thread::get_id() != body_.io_thread)
+                    ++body_.off_thread;
+                suspend_ = ! suspend_;
+                if(suspend_)
+                {
+                    body_.threads.emplace_back(
+                        [](resume_context&& rc)
+                        {
+                            rc();
+                        }, std::move(rc));
+                    return boost::indeterminate;
+                }
+                write(boost::asio::buffer(body_.s.data() + n_, 1));
+                ++n_;
+                return n_ == body_.s.size();
+            }
+        };
+    };
+
     template<bool isRequest, class Body, class Headers>
     std::string
     str(message_v1<isRequest, Body, Headers> const& m)
@@ -596,6 +645,42 @@ public:
         }
     }
 
+    void
+    testResumeThread()
+    {
+        for(int i = 0; i < 20; ++i)
+        {
+            boost::asio::io_service ios;
+            std::unique_ptr<boost::asio::io_service::work> work(
+                new boost::asio::io_service::work(ios));
+            message_v1<true, thread_body, headers> m;
+            m.method = "GET";
+            m.url = "/";
+            m.version = 11;
+            m.headers.insert("Content-Length", "5");
+            m.body.s = "*****";
+            m.body.io_thread = std::this_thread::get_id();
+            string_write_stream ss(ios);
+            error_code result = boost::asio::error::would_block;
+            async_write(ss, m,
+                [&](error_code ec)
+                {
+                    result = ec;
+                    work.reset();
+                });
+            ios.run();
+            for(auto& t : m.body.threads)
+                t.join();
+            expect(! result, result.message());
+            expect(m.body.off_thread == 0);
+            expect(ss.str ==
+                "GET / HTTP/1.1\r\n"
+                "Content-Length: 5\r\n"
+                "\r\n"
+                "*****");
+        }
+    }
+
     void testConvert()
     {
         message_v1<true, string_body, headers> m;
@@ -639,6 +724,7 @@ public:
         yield_to(std::bind(&write_test::testFailures,
             this, std::placeholders::_1));
         testOutput();
+        testResumeThread();
         testConvert();
         testOstream();
     }
@@ -0,0 +1,171 @@
+//
+// Copyright (c) 2013-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#include <beast/websocket/stream.hpp>
+#include <beast/http/empty_body.hpp>
+#include <beast/core/recycle_handler.hpp>
+#include <beast/core/static_streambuf.hpp>
+#include <beast/core/to_string.hpp>
+#include <beast/test/alloc_counter.hpp>
+#include <beast/test/string_stream.hpp>
+#include <beast/unit_test/suite.hpp>
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/io_service.hpp>
+#include <string>
+
+namespace beast {
+namespace test {
+
+// A string_stream has no connection to tear down
+inline
+void
+teardown(string_stream&, error_code&)
+{
+}
+
+} // test
+
+namespace websocket {
+
+// Checks that steady state operations stay within
+// their budget of heap allocations.
+class alloc_budget_test : public beast::unit_test::suite
+{
+public:
+    // Returns a masked text frame as a client sends it
+    static
+    std::string
+    client_frame(std::string const& payload)
+    {
+        char const key[4] = { 0x12, 0x34, 0x56, 0x78 };
+        std::string s;
+        s.push_back(static_cast<char>(0x81));
+        s.push_back(static_cast<char>(0x80 | payload.size()));
+        s.append(key, sizeof(key));
+        for(std::size_t i = 0; i < payload.size(); ++i)
+            s.push_back(payload[i] ^ key[i % 4]);
+        return s;
+    }
+
+    void
+    testSmallFrames()
+    {
+        std::size_t constexpr n = 100;
+        std::string s;
+        for(std::size_t i = 0; i < n; ++i)
+            s += client_frame("Hello, world!");
+        http::request_v1<http::empty_body> req;
+        req.method = "GET";
+        req.url = "/";
+        req.version = 11;
+        req.headers.insert("Host", "localhost:80");
+        req.headers.insert("Upgrade", "websocket");
+        req.headers.insert("Connection", "upgrade");
+        req.headers.insert("Sec-WebSocket-Key", "dGhlIHNhbXBsZSBub25jZQ==");
+        req.headers.insert("Sec-WebSocket-Version", "13");
+        boost::asio::io_service ios;
+        stream<test::string_stream> ws(ios, std::move(s));
+        ws.accept(req);
+
+        static_streambuf_n<1024> sb;
+        opcode op;
+        // The first read and write allocate the
+        // buffers which the stream keeps.
+        ws.read(op, sb);
+        ws.write(sb.data());
+        expect(to_string(sb.data()) == "Hello, world!");
+        sb.reset();
+        {
+            test::alloc_counter c;
+            for(std::size_t i = 1; i < n; ++i)
+            {
+                ws.read(op, sb);
+                sb.reset();
+            }
+            auto const count = c.allocations();
+            log << "read: " << count <<
+                " allocations in " << n - 1 << " frames" << std::endl;
+            expect(count == 0, "read budget");
+        }
+        {
+            test::alloc_counter c;
+            for(std::size_t i = 1; i < n; ++i)
+                ws.write(boost::asio::buffer("Hello, world!", 13));
+            auto const count = c.allocations();
+            log << "write: " << count <<
+                " allocations in " << n - 1 << " frames" << std::endl;
+            expect(count == 0, "write budget");
+        }
+    }
+
+    void
+    testClientFrames()
+    {
+        using boost::asio::buffer;
+        std::size_t constexpr n = 100;
+        boost::asio::io_service ios;
+        stream<test::string_stream> ws(ios, "");
+        // As after a successful handshake
+        ws.reset();
+        ws.open(detail::role_type::client);
+
+        ws.write(buffer("Hello, world!", 13));
+        {
+            test::alloc_counter c;
+            for(std::size_t i = 1; i < n; ++i)
+                ws.write(buffer("Hello, world!", 13));
+            auto const count = c.allocations();
+            log << "client write: " << count <<
+                " allocations in " << n - 1 << " frames" << std::endl;
+            // The buffer holding the masked payload
+            expect(count <= n - 1, "client write budget");
+        }
+        {
+            error_code result;
+            auto const write =
+                [&]
+                {
+                    ws.async_write(buffer("Hello, world!", 13),
+                        recycle_handler(
+                            [&](error_code ec)
+                            {
+                                result = ec;
+                            }));
+                    ios.run();
+                    ios.reset();
+                };
+            // Fills the recycled blocks, including the one
+            // the handler provides for the masked payload.
+            write();
+            test::alloc_counter c;
+            for(std::size_t i = 1; i < n; ++i)
+                write();
+            auto const count = c.allocations();
+            log << "client async_write: " << count <<
+                " allocations in " << n - 1 << " frames" << std::endl;
+            expect(! result, result.message());
+            expect(count == 0, "client async_write budget");
+        }
+    }
+
+    void
+    run() override
+    {
+        if(! test::alloc_counter::installed())
+        {
+            fail("alloc_counter.cpp is not linked");
+            return;
+        }
+        testSmallFrames();
+        testClientFrames();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(alloc_budget,websocket,beast);
+
+} // websocket
+} // beast
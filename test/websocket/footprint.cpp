@@ -0,0 +1,135 @@
+//
+// Copyright (c) 2013-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#include <beast/websocket/stream.hpp>
+#include <beast/core/streambuf.hpp>
+#include <beast/core/streambuf_pool.hpp>
+#include <beast/core/to_string.hpp>
+#include <beast/test/alloc_counter.hpp>
+#include <beast/test/pipe.hpp>
+#include <beast/unit_test/suite.hpp>
+#include <boost/asio.hpp>
+#include <thread>
+#include <vector>
+
+namespace beast {
+namespace websocket {
+
+class footprint_test : public beast::unit_test::suite
+{
+public:
+    using socket_type = boost::asio::ip::tcp::socket;
+
+    // Returns the bytes allocated by f
+    template<class F>
+    static
+    std::size_t
+    heap_bytes(F const& f)
+    {
+        test::alloc_counter c;
+        f();
+        return c.bytes();
+    }
+
+    void
+    testFootprint()
+    {
+        std::size_t constexpr n = 100;
+        boost::asio::io_service ios;
+        {
+            // create the socket services up front
+            socket_type sock(ios);
+            sock.open(boost::asio::ip::tcp::v4());
+        }
+        std::vector<stream<socket_type>> v;
+        v.reserve(n);
+
+        auto const created = heap_bytes(
+            [&]
+            {
+                for(std::size_t i = 0; i < n; ++i)
+                    v.emplace_back(ios);
+            });
+        auto const opened = heap_bytes(
+            [&]
+            {
+                for(auto& ws : v)
+                    ws.next_layer().open(
+                        boost::asio::ip::tcp::v4());
+            });
+
+        log <<
+            "sizeof(stream<tcp::socket>) == " <<
+                sizeof(stream<socket_type>) << "\n" <<
+            "heap bytes per idle stream  == " <<
+                created / n << "\n" <<
+            "heap bytes per open socket  == " <<
+                opened / n << std::endl;
+
+        // An idle stream allocates nothing
+        expect(created == 0);
+        // The PRNG is not stored per stream
+        expect(sizeof(stream<socket_type>) < 1024);
+    }
+
+    // Returns the capacity of the read buffer held by a
+    // server after a handshake and an echoed message, and
+    // the bytes held by the pool of the server thread.
+    std::size_t
+    held_after_echo(bool release, std::size_t& pooled)
+    {
+        using boost::asio::buffer;
+        boost::asio::io_service ios;
+        test::pipe p(ios);
+        stream<test::pipe::stream&> server(p.server);
+        stream<test::pipe::stream&> client(p.client);
+        server.set_option(read_buffer_size{8192});
+        if(release)
+            server.set_option(release_when_idle{true});
+        std::thread t(
+            [&]
+            {
+                server.accept();
+                opcode op;
+                streambuf sb;
+                server.read(op, sb);
+                server.write(sb.data());
+                pooled = streambuf_pool::get_stats().bytes_held;
+            });
+        client.handshake("localhost", "/");
+        client.write(buffer("Hello", 5));
+        opcode op;
+        streambuf sb;
+        client.read(op, sb);
+        t.join();
+        expect(to_string(sb.data()) == "Hello");
+        return server.stream_.buffer().capacity();
+    }
+
+    void
+    testReleaseWhenIdle()
+    {
+        std::size_t pooled;
+        // The handshake and reads leave memory in the buffer
+        expect(held_after_echo(false, pooled) > 0);
+        // An idle stream holds no read buffer,
+        // its memory is kept by the pool
+        expect(held_after_echo(true, pooled) == 0);
+        expect(pooled > 0);
+    }
+
+    void run() override
+    {
+        testFootprint();
+        testReleaseWhenIdle();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(footprint,websocket,beast);
+
+} // websocket
+} // beast
@@ -0,0 +1,436 @@
+//
+// Copyright (c) 2013-2016 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+// A WebSocket load generator. Client streams send messages to an echo
+// server and wait for each one to come back, measuring messages/s,
+// bytes/s and round trip latency. Without --port, an async_echo_peer
+// is started in-process on loopback.
+//
+// Clients must mask every frame they send, so masking can't be turned
+// off for a run. Instead the cost of masking is measured separately,
+// and reported as the CPU it takes at the throughput achieved: the
+// client masks each message and an in-process server unmasks it.
+//
+// usage: websocket-bench --connections 16 --size 64 --size-max 65536 --dist log
+
+#include "websocket_async_echo_peer.hpp"
+
+#include <beast/core/streambuf.hpp>
+#include <beast/test/latency_histogram.hpp>
+#include <beast/websocket.hpp>
+#include <beast/websocket/detail/mask.hpp>
+#include <boost/asio.hpp>
+#include <boost/core/ignore_unused.hpp>
+#include <boost/program_options.hpp>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace beast {
+namespace websocket {
+
+using clock_type = std::chrono::steady_clock;
+
+struct options
+{
+    std::string host = "127.0.0.1";
+    std::uint16_t port = 0;         // 0 for an in-process server
+    std::size_t server_threads = 1;
+    std::size_t connections = 16;
+    std::size_t threads = 1;
+    std::size_t seconds = 5;
+    std::size_t size = 1024;
+    std::size_t size_max = 0;       // 0 for `size`
+    std::string dist = "fixed";     // fixed, uniform or log
+    std::size_t fragment = 0;       // 0 for no fragmentation
+    bool text = false;
+    std::uint32_t seed = 1;
+    bool json = false;
+};
+
+// Chooses message sizes between the minimum and maximum
+class size_dist
+{
+    std::mt19937 g_;
+    std::size_t min_;
+    std::size_t max_;
+    bool log_;
+
+public:
+    size_dist(options const& opt, std::uint32_t seed)
+        : g_(seed)
+        , min_(opt.size)
+        , max_(opt.dist == "fixed" ? opt.size : opt.size_max)
+        , log_(opt.dist == "log")
+    {
+    }
+
+    std::size_t
+    operator()()
+    {
+        if(min_ == max_)
+            return min_;
+        if(! log_)
+            return std::uniform_int_distribution<
+                std::size_t>{min_, max_}(g_);
+        // Log-uniform, so small messages are common
+        // and large ones still appear.
+        std::uniform_real_distribution<double> d{
+            std::log(static_cast<double>(min_ > 0 ? min_ : 1)),
+            std::log(static_cast<double>(max_))};
+        return static_cast<std::size_t>(std::exp(d(g_)));
+    }
+};
+
+// State shared by all threads
+struct run_state
+{
+    std::atomic<bool> stop{false};
+    std::atomic<std::size_t> errors{0};
+};
+
+// State owned by one thread
+struct thread_state
+{
+    boost::asio::io_service ios;
+    test::latency_histogram latency;
+    std::uint64_t messages = 0;
+    std::uint64_t bytes = 0;
+};
+
+class bench_client
+    : public std::enable_shared_from_this<bench_client>
+{
+    using socket_type = boost::asio::ip::tcp::socket;
+
+    stream<socket_type> ws_;
+    std::string const& payload_;
+    run_state& run_;
+    thread_state& ts_;
+    size_dist dist_;
+    streambuf sb_;
+    opcode op_;
+    std::size_t size_ = 0;
+    clock_type::time_point sent_;
+
+public:
+    bench_client(socket_type&& sock, std::string const& payload,
+            options const& opt, std::uint32_t seed,
+                run_state& run, thread_state& ts)
+        : ws_(std::move(sock))
+        , payload_(payload)
+        , run_(run)
+        , ts_(ts)
+        , dist_(opt, seed)
+    {
+        ws_.set_option(message_type{
+            opt.text ? opcode::text : opcode::binary});
+        ws_.set_option(auto_fragment_size{opt.fragment});
+        ws_.set_option(read_message_max{payload.size() + 1});
+        ws_.handshake(opt.host + ":" + std::to_string(
+            ws_.next_layer().remote_endpoint().port()), "/");
+    }
+
+    void
+    run()
+    {
+        do_write();
+    }
+
+private:
+    void
+    do_write()
+    {
+        if(run_.stop)
+            return close();
+        size_ = dist_();
+        sent_ = clock_type::now();
+        auto self = shared_from_this();
+        ws_.async_write(
+            boost::asio::buffer(payload_.data(), size_),
+            [self](error_code ec)
+            {
+                self->on_write(ec);
+            });
+    }
+
+    void
+    on_write(error_code ec)
+    {
+        if(ec)
+            return fail();
+        auto self = shared_from_this();
+        ws_.async_read(op_, sb_,
+            [self](error_code ec)
+            {
+                self->on_read(ec);
+            });
+    }
+
+    void
+    on_read(error_code ec)
+    {
+        if(ec)
+            return fail();
+        auto const elapsed = clock_type::now() - sent_;
+        if(! run_.stop)
+        {
+            ts_.latency.record(static_cast<std::uint64_t>(
+                std::chrono::duration_cast<
+                    std::chrono::nanoseconds>(elapsed).count()));
+            ++ts_.messages;
+            ts_.bytes += sb_.size();
+        }
+        sb_.consume(sb_.size());
+        do_write();
+    }
+
+    void
+    fail()
+    {
+        if(! run_.stop)
+            ++run_.errors;
+        close();
+    }
+
+    void
+    close()
+    {
+        error_code ec;
+        ws_.next_layer().shutdown(
+            socket_type::shutdown_both, ec);
+        ws_.next_layer().close(ec);
+    }
+};
+
+// Returns the bytes per second masked in place,
+// using messages of the given size.
+double
+mask_rate(std::size_t size)
+{
+    if(size == 0)
+        size = 1;
+    std::vector<char> buf(size);
+    detail::prepared_key_type key;
+    detail::prepare_key(key, 0x12345678);
+    std::uint64_t bytes = 0;
+    auto const t0 = clock_type::now();
+    auto t1 = t0;
+    do
+    {
+        for(int i = 0; i < 64; ++i)
+        {
+            auto k = key;
+            detail::mask_inplace(
+                boost::asio::buffer(buf.data(), size), k);
+            bytes += size;
+        }
+        t1 = clock_type::now();
+    }
+    while(t1 - t0 < std::chrono::milliseconds(200));
+    // Keep the work from being optimized away
+    volatile char sink = buf[0];
+    boost::ignore_unused(sink);
+    return bytes / std::chrono::duration<double>(t1 - t0).count();
+}
+
+int
+bench(options const& opt)
+{
+    using namespace boost::asio;
+    run_state run;
+    std::unique_ptr<async_echo_peer> server;
+    ip::tcp::endpoint ep{ip::address::from_string(opt.host), opt.port};
+    if(opt.port == 0)
+    {
+        server.reset(new async_echo_peer(true,
+            ep, opt.server_threads));
+        ep = server->local_endpoint();
+    }
+    auto const max = opt.dist == "fixed" ?
+        opt.size : (std::max)(opt.size, opt.size_max);
+    std::string const payload(max, 'x');
+
+    std::vector<std::unique_ptr<thread_state>> ts;
+    for(std::size_t i = 0; i < opt.threads; ++i)
+        ts.emplace_back(new thread_state);
+    for(std::size_t i = 0; i < opt.connections; ++i)
+    {
+        auto& t = *ts[i % ts.size()];
+        ip::tcp::socket sock(t.ios);
+        error_code ec;
+        sock.connect(ep, ec);
+        if(ec)
+        {
+            std::cerr << "connect: " << ec.message() << std::endl;
+            return EXIT_FAILURE;
+        }
+        sock.set_option(ip::tcp::no_delay{true});
+        std::make_shared<bench_client>(std::move(sock), payload,
+            opt, static_cast<std::uint32_t>(opt.seed + i),
+                run, t)->run();
+    }
+    auto const t0 = clock_type::now();
+    std::vector<std::thread> v;
+    v.reserve(ts.size());
+    for(auto& t : ts)
+    {
+        auto& ios = t->ios;
+        v.emplace_back([&ios]{ ios.run(); });
+    }
+    std::this_thread::sleep_for(std::chrono::seconds(opt.seconds));
+    run.stop = true;
+    auto const t1 = clock_type::now();
+    for(auto& t : v)
+        t.join();
+    server.reset();
+
+    test::latency_histogram h;
+    std::uint64_t messages = 0;
+    std::uint64_t bytes = 0;
+    for(auto const& t : ts)
+    {
+        h.merge(t->latency);
+        messages += t->messages;
+        bytes += t->bytes;
+    }
+    auto const seconds =
+        std::chrono::duration<double>(t1 - t0).count();
+    auto const mps = messages / seconds;
+    auto const bps = bytes / seconds;
+    auto const rate = mask_rate(messages > 0 ?
+        static_cast<std::size_t>(bytes / messages) : opt.size);
+    // Masked by the client, and unmasked by
+    // the server when it runs in this process.
+    auto const passes = opt.port == 0 ? 2 : 1;
+    auto const mask_cores = bps * passes / rate;
+    auto const us =
+        [&](double p)
+        {
+            return static_cast<double>(h.percentile(p)) / 1000;
+        };
+    std::ostringstream ss;
+    ss << std::fixed << std::setprecision(1);
+    if(opt.json)
+    {
+        ss <<
+            "{\"connections\":" << opt.connections <<
+            ",\"threads\":" << opt.threads <<
+            ",\"dist\":\"" << opt.dist << "\"" <<
+            ",\"size\":" << opt.size <<
+            ",\"size_max\":" << max <<
+            ",\"fragment\":" << opt.fragment <<
+            ",\"opcode\":\"" << (opt.text ? "text" : "binary") << "\"" <<
+            ",\"seconds\":" << seconds <<
+            ",\"messages\":" << messages <<
+            ",\"errors\":" << run.errors <<
+            ",\"messages_per_second\":" << mps <<
+            ",\"bytes_per_second\":" << bps <<
+            ",\"latency_us\":{" <<
+                "\"p50\":" << us(50) <<
+                ",\"p90\":" << us(90) <<
+                ",\"p99\":" << us(99) <<
+                ",\"p99.9\":" << us(99.9) <<
+                ",\"max\":" << static_cast<double>(h.max()) / 1000 <<
+            "}" << std::setprecision(4) <<
+            ",\"mask_bytes_per_second\":" << rate <<
+            ",\"mask_cores\":" << mask_cores <<
+            "}";
+    }
+    else
+    {
+        ss <<
+            "connections=" << opt.connections <<
+            " threads=" << opt.threads <<
+            " dist=" << opt.dist <<
+            " size=" << opt.size << ".." << max <<
+            " fragment=" << opt.fragment <<
+            " opcode=" << (opt.text ? "text" : "binary") << "\n" <<
+            "messages:    " << messages << " in " << seconds << "s, " <<
+                run.errors << " errors\n" <<
+            "throughput:  " << mps << " messages/s, " <<
+                bps / (1024 * 1024) << " MB/s\n" <<
+            "latency us:  p50=" << us(50) <<
+                " p90=" << us(90) <<
+                " p99=" << us(99) <<
+                " p99.9=" << us(99.9) <<
+                " max=" << static_cast<double>(h.max()) / 1000 << "\n" <<
+            "masking:     " << rate / (1024 * 1024) << " MB/s, " <<
+                std::setprecision(4) << mask_cores <<
+                " cores at this throughput";
+    }
+    std::cout << ss.str() << std::endl;
+    return EXIT_SUCCESS;
+}
+
+} // websocket
+} // beast
+
+int
+main(int ac, char const* av[])
+{
+    namespace po = boost::program_options;
+    beast::websocket::options opt;
+    po::options_description desc("Options");
+    desc.add_options()
+        ("help,h",          "Show this message")
+        ("host",            po::value(&opt.host),
+                            "Set the IP address of the server")
+        ("port,p",          po::value(&opt.port),
+                            "Set the port of an echo server, "
+                            "otherwise one is started in-process")
+        ("server-threads",  po::value(&opt.server_threads),
+                            "Set the threads of the in-process server")
+        ("connections,c",   po::value(&opt.connections),
+                            "Set the number of connections")
+        ("threads,t",       po::value(&opt.threads),
+                            "Set the number of client threads")
+        ("duration",        po::value(&opt.seconds),
+                            "Run for this many seconds")
+        ("size",            po::value(&opt.size),
+                            "Set the message size, or the minimum size")
+        ("size-max",        po::value(&opt.size_max),
+                            "Set the maximum message size")
+        ("dist",            po::value(&opt.dist),
+                            "Set the size distribution: fixed, uniform or log")
+        ("fragment",        po::value(&opt.fragment),
+                            "Set the automatic fragment size, 0 for none")
+        ("text",            "Send text messages instead of binary")
+        ("seed",            po::value(&opt.seed),
+                            "Set the seed for message sizes")
+        ("json",            "Print the results as JSON")
+        ;
+    po::variables_map vm;
+    po::store(po::parse_command_line(ac, av, desc), vm);
+    po::notify(vm);
+    if(vm.count("help"))
+    {
+        std::cout << desc << std::endl;
+        return EXIT_SUCCESS;
+    }
+    opt.text = vm.count("text") > 0;
+    opt.json = vm.count("json") > 0;
+    if(opt.dist != "fixed" && opt.dist != "uniform" && opt.dist != "log")
+    {
+        std::cerr << "unknown distribution: " << opt.dist << std::endl;
+        return EXIT_FAILURE;
+    }
+    if(opt.dist != "fixed" && opt.size_max < opt.size)
+        opt.dist = "fixed";
+    if(opt.threads < 1)
+        opt.threads = 1;
+    return beast::websocket::bench(opt);
+}